@@ -3,27 +3,354 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
 #include <functional>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#ifdef ANIMATEANYTHING_PROFILE
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#endif
+
 namespace AnimateAnything
 {
+#ifdef ANIMATEANYTHING_PROFILE
+	// Counters every node keeps when ANIMATEANYTHING_PROFILE is defined, AnimationProfile.h turns them into a report.
+	// They are relaxed atomics because nodes under AnimationParallelConcurrent are played from several threads.
+	struct NodeProfile
+	{
+		std::string Label;
+		std::atomic<std::uint64_t> Plays; // calls to Play, a batch counts each of its samples
+		std::atomic<std::uint64_t> Hits; // plays where a range or event node played its child
+		std::atomic<std::uint64_t> Nanoseconds; // time spent in user actions
+
+		NodeProfile() : Plays(0), Hits(0), Nanoseconds(0) { }
+		NodeProfile(const NodeProfile& other) : Label(other.Label), Plays(other.Plays.load()), Hits(other.Hits.load()), Nanoseconds(other.Nanoseconds.load()) { }
+		NodeProfile& operator=(const NodeProfile& other)
+		{
+			Label = other.Label;
+			Plays = other.Plays.load();
+			Hits = other.Hits.load();
+			Nanoseconds = other.Nanoseconds.load();
+			return *this;
+		}
+
+		void Play(std::uint64_t count) { Plays.fetch_add(count, std::memory_order_relaxed); }
+		void Hit(std::uint64_t count) { Hits.fetch_add(count, std::memory_order_relaxed); }
+		void Reset() { Plays = 0; Hits = 0; Nanoseconds = 0; }
+	};
+
+	// Adds the time between construction and destruction to a profile
+	class ProfileTimer
+	{
+	private:
+		NodeProfile& profile;
+		std::chrono::steady_clock::time_point start;
+
+	public:
+		ProfileTimer(NodeProfile& profile) : profile(profile), start(std::chrono::steady_clock::now()) { }
+		~ProfileTimer()
+		{
+			auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+			profile.Nanoseconds.fetch_add(std::uint64_t(elapsed), std::memory_order_relaxed);
+		}
+	};
+
+#define ANIMATEANYTHING_PROFILE_PLAY(count) (this->Profile.Play(count), ::AnimateAnything::TracePlay(this))
+#define ANIMATEANYTHING_PROFILE_HIT(count) this->Profile.Hit(count)
+#define ANIMATEANYTHING_PROFILE_TIME() ::AnimateAnything::ProfileTimer animateAnythingProfileTimer(this->Profile)
+#else
+	// without ANIMATEANYTHING_PROFILE the instrumentation compiles to nothing
+#define ANIMATEANYTHING_PROFILE_PLAY(count) ((void)0)
+#define ANIMATEANYTHING_PROFILE_HIT(count) ((void)0)
+#define ANIMATEANYTHING_PROFILE_TIME() ((void)0)
+#endif
+
+	template<typename NumericType> class BatchScratch;
+
+	// A batch of moments as structure of arrays, Index maps every sample back to its position in the original batch
+	template<typename NumericType> struct TimeSamples
+	{
+		const NumericType* T;
+		const NumericType* T0;
+		const std::size_t* Index;
+		std::size_t Count;
+		BatchScratch<NumericType>* Scratch; // working memory for nodes that transform or filter the batch
+	};
+
+	// Working memory for batch playback, one frame of buffers per graph depth, reused between batches
+	template<typename NumericType> class BatchScratch
+	{
+	private:
+
+		struct Frame
+		{
+			std::vector<NumericType> T;
+			std::vector<NumericType> T0;
+			std::vector<std::size_t> Index;
+		};
+
+		std::vector<Frame> frames;
+		std::size_t depth = 0;
+
+		Frame& Push(std::size_t count)
+		{
+			if (frames.size() <= depth) frames.resize(depth + 1);
+			Frame& frame = frames[depth++];
+			if (frame.T.size() < count)
+			{
+				frame.T.resize(count);
+				frame.T0.resize(count);
+				frame.Index.resize(count);
+			}
+			return frame;
+		}
+
+	public:
+
+		// New frame with the samples where keep(t, t0) holds, shifted by -offset, release it with Pop
+		template<typename Keep> TimeSamples<NumericType> Select(const TimeSamples<NumericType>& samples, NumericType offset, Keep keep)
+		{
+			Frame& frame = Push(samples.Count);
+			NumericType* t = frame.T.data();
+			NumericType* t0 = frame.T0.data();
+			const NumericType* sourceT = samples.T;
+			const NumericType* sourceT0 = samples.T0;
+			std::size_t kept = 0;
+			for (std::size_t i = 0; i < samples.Count; i++)
+			{
+				kept += keep(sourceT[i], sourceT0[i]) ? 1 : 0;
+			}
+			if (kept == samples.Count)
+			{
+				// common case, the whole batch is in range, no need to compact or copy the index
+				for (std::size_t i = 0; i < samples.Count; i++)
+				{
+					t[i] = sourceT[i] - offset;
+					t0[i] = sourceT0[i] - offset;
+				}
+				return TimeSamples<NumericType>{ t, t0, samples.Index, kept, this };
+			}
+			std::size_t* index = frame.Index.data();
+			std::size_t count = 0;
+			for (std::size_t i = 0; i < samples.Count && kept != 0; i++)
+			{
+				// always write, only advance for kept samples, so the loop has no branches
+				t[count] = sourceT[i] - offset;
+				t0[count] = sourceT0[i] - offset;
+				index[count] = samples.Index[i];
+				count += keep(sourceT[i], sourceT0[i]) ? 1 : 0;
+			}
+			return TimeSamples<NumericType>{ t, t0, index, count, this };
+		}
+
+		// New frame with every sample mapped through transform, release it with Pop
+		template<typename Transform> TimeSamples<NumericType> Map(const TimeSamples<NumericType>& samples, Transform transform)
+		{
+			Frame& frame = Push(samples.Count);
+			NumericType* t = frame.T.data();
+			NumericType* t0 = frame.T0.data();
+			const NumericType* sourceT = samples.T;
+			const NumericType* sourceT0 = samples.T0;
+			for (std::size_t i = 0; i < samples.Count; i++)
+			{
+				t[i] = transform(sourceT[i]);
+				t0[i] = transform(sourceT0[i]);
+			}
+			return TimeSamples<NumericType>{ t, t0, samples.Index, samples.Count, this };
+		}
+
+		void Pop() { depth--; }
+	};
+
 	// Base interface for animations, you may create your own derived types if you wish
 	template<typename NumericType> class IAnimation
 	{
 	public:
 		virtual void Play(NumericType t, NumericType t0) = 0; // Play the animation at moment t, previous moment given in t0, (deltatime or event detect)
 		virtual void PlaySimple(NumericType t) { Play(t, t); } // you should call 2 argument version instaead, this is added as helper
+		virtual void PlayBatch(const TimeSamples<NumericType>& samples) { for (std::size_t i = 0; i < samples.Count; i++) Play(samples.T[i], samples.T0[i]); } // Play many moments, nodes handle the whole batch before passing it on to their children
+		virtual NumericType NextActivity(NumericType t) { return t; } // earliest moment from t on where playing forward may do something, t if active now, Never() if it is finished
+		virtual void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) { } // call visit for each direct child, for tools that walk the graph
+		virtual void SaveState(std::vector<char>& state) const { } // append the state that earlier plays left in this node, for checkpoints
+		virtual const char* RestoreState(const char* state) { return state; } // read back what SaveState appended, returns the end of it
 		virtual ~IAnimation() { }; // polymorphic class
+
+		// NextActivity result of an animation that will not do anything anymore
+		static NumericType Never() { return std::numeric_limits<NumericType>::has_infinity ? std::numeric_limits<NumericType>::infinity() : std::numeric_limits<NumericType>::max(); }
+
+		// Earliest moment there is, NextActivity from here tells whether an animation does anything at all
+		static NumericType Earliest() { return std::numeric_limits<NumericType>::has_infinity ? -std::numeric_limits<NumericType>::infinity() : std::numeric_limits<NumericType>::lowest(); }
+
+#ifdef ANIMATEANYTHING_PROFILE
+		NodeProfile Profile;
+#endif
+	};
+
+#ifdef ANIMATEANYTHING_PROFILE
+	// Told about every node that plays on this thread while it is current, AnimationTrace.h records invocations with it
+	template<typename NumericType> class TraceSink
+	{
+	public:
+		virtual void Played(IAnimation<NumericType>& node) = 0;
+		virtual ~TraceSink() { }
+
+		static TraceSink*& Current()
+		{
+			static thread_local TraceSink* current = nullptr;
+			return current;
+		}
+	};
+
+	template<typename NumericType> void TracePlay(IAnimation<NumericType>* node)
+	{
+		if (auto sink = TraceSink<NumericType>::Current()) sink->Played(*node);
+	}
+#endif
+
+	// Append a trivially copyable value to saved state
+	template<typename Type> void SaveValue(std::vector<char>& state, const Type& value)
+	{
+		static_assert(std::is_trivially_copyable<Type>::value, "only plain values can be saved");
+		const char* bytes = reinterpret_cast<const char*>(&value);
+		state.insert(state.end(), bytes, bytes + sizeof(Type));
+	}
+
+	// Read a value appended by SaveValue, returns the end of it
+	template<typename Type> const char* RestoreValue(const char* state, Type& value)
+	{
+		static_assert(std::is_trivially_copyable<Type>::value, "only plain values can be restored");
+		std::memcpy(&value, state, sizeof(Type));
+		return state + sizeof(Type);
+	}
+
+	// Name a node in profile reports, does nothing unless ANIMATEANYTHING_PROFILE is defined
+	template<typename Node> Node* Label(Node* node, const char* label)
+	{
+#ifdef ANIMATEANYTHING_PROFILE
+		node->Profile.Label = label;
+#endif
+		return node;
+	}
+
+#ifndef ANIMATEANYTHING_INLINE_CAPACITY
+#define ANIMATEANYTHING_INLINE_CAPACITY 48 // bytes of captures a node keeps inline, a std::function or 6 pointers
+#endif
+
+	template<typename Signature, std::size_t Capacity = ANIMATEANYTHING_INLINE_CAPACITY> class InlineFunction;
+
+	// Callable stored inside the object like std::function, but it never allocates. A callable that does not fit in
+	// Capacity bytes is a compile error: capture by reference, or raise ANIMATEANYTHING_INLINE_CAPACITY.
+	template<typename Result, typename... Args, std::size_t Capacity> class InlineFunction<Result(Args...), Capacity>
+	{
+	private:
+		enum class Operation { Copy, Move, Destroy };
+
+		alignas(std::max_align_t) unsigned char storage[Capacity];
+		Result(*invoker)(void*, Args&&...);
+		void(*manager)(Operation, void*, void*);
+
+		template<typename Function> static Result Invoke(void* function, Args&&... args) { return static_cast<Result>((*static_cast<Function*>(function))(std::forward<Args>(args)...)); }
+		static Result Empty(void*, Args&&...) { throw std::bad_function_call(); }
+
+		template<typename Function> static void Manage(Operation operation, void* to, void* from)
+		{
+			switch (operation)
+			{
+			case Operation::Copy: new (to) Function(*static_cast<const Function*>(from)); break;
+			case Operation::Move: new (to) Function(std::move(*static_cast<Function*>(from))); break;
+			case Operation::Destroy: static_cast<Function*>(to)->~Function(); break;
+			}
+		}
+
+		// true_type if Function can be called with Args and its result converts to Result
+		template<typename Function> static auto Accepts(int) -> typename std::conditional<
+			std::is_void<Result>::value || std::is_convertible<decltype(std::declval<Function&>()(std::declval<Args>()...)), Result>::value,
+			std::true_type, std::false_type>::type;
+		template<typename Function> static std::false_type Accepts(...);
+
+		void Assign(const InlineFunction& other)
+		{
+			invoker = other.invoker;
+			manager = other.manager;
+			if (manager) manager(Operation::Copy, storage, const_cast<unsigned char*>(other.storage));
+		}
+
+		void Assign(InlineFunction&& other)
+		{
+			invoker = other.invoker;
+			manager = other.manager;
+			if (manager) manager(Operation::Move, storage, other.storage);
+		}
+
+		void Destroy()
+		{
+			if (manager) manager(Operation::Destroy, storage, nullptr);
+			invoker = &Empty;
+			manager = nullptr;
+		}
+
+	public:
+		InlineFunction() : invoker(&Empty), manager(nullptr) { }
+
+		template<typename Function, typename Stored = typename std::decay<Function>::type,
+			typename = typename std::enable_if<!std::is_same<Stored, InlineFunction>::value && decltype(Accepts<Stored>(0))::value>::type>
+		InlineFunction(Function&& function) : invoker(&Invoke<Stored>), manager(&Manage<Stored>)
+		{
+			static_assert(sizeof(Stored) <= Capacity, "the callable does not fit, capture by reference or raise ANIMATEANYTHING_INLINE_CAPACITY");
+			static_assert(alignof(Stored) <= alignof(std::max_align_t), "the callable is over-aligned");
+			new (storage) Stored(std::forward<Function>(function));
+		}
+
+		InlineFunction(const InlineFunction& other) { Assign(other); }
+		InlineFunction(InlineFunction&& other) { Assign(std::move(other)); }
+
+		InlineFunction& operator=(const InlineFunction& other)
+		{
+			if (this != &other)
+			{
+				Destroy();
+				Assign(other);
+			}
+			return *this;
+		}
+
+		InlineFunction& operator=(InlineFunction&& other)
+		{
+			if (this != &other)
+			{
+				Destroy();
+				Assign(std::move(other));
+			}
+			return *this;
+		}
+
+		explicit operator bool() const { return manager != nullptr; }
+
+		// like std::function, calling an empty one throws std::bad_function_call
+		Result operator()(Args... args) const { return invoker(const_cast<unsigned char*>(storage), std::forward<Args>(args)...); }
+
+		~InlineFunction() { Destroy(); }
 	};
 
 	// Animation that contains a lambda with no parameters
 	template<typename NumericType> class AnimationActionVoid : public IAnimation<NumericType>
 	{
 	public:
-		std::function<void(void)> Action;
-		void Play(NumericType t, NumericType t0) override { Action(); }
-		AnimationActionVoid(std::function<void(void)> action) : Action(action) { };
+		InlineFunction<void(void)> Action;
+		void Play(NumericType t, NumericType t0) override { ANIMATEANYTHING_PROFILE_PLAY(1); ANIMATEANYTHING_PROFILE_TIME(); Action(); }
+		void PlayBatch(const TimeSamples<NumericType>& samples) override { ANIMATEANYTHING_PROFILE_PLAY(samples.Count); ANIMATEANYTHING_PROFILE_TIME(); for (std::size_t i = 0; i < samples.Count; i++) Action(); }
+		AnimationActionVoid(InlineFunction<void(void)> action) : Action(std::move(action)) { };
 		~AnimationActionVoid() { };
 	};
 
@@ -31,119 +358,897 @@ namespace AnimateAnything
 	template<typename NumericType> class AnimationActionTime : public IAnimation<NumericType>
 	{
 	public:
-		std::function<void(NumericType)> Action;
-		void Play(NumericType t, NumericType t0) override { Action(t); }
-		AnimationActionTime(std::function<void(NumericType)> action) : Action(action) { };
+		InlineFunction<void(NumericType)> Action;
+		void Play(NumericType t, NumericType t0) override { ANIMATEANYTHING_PROFILE_PLAY(1); ANIMATEANYTHING_PROFILE_TIME(); Action(t); }
+		void PlayBatch(const TimeSamples<NumericType>& samples) override { ANIMATEANYTHING_PROFILE_PLAY(samples.Count); ANIMATEANYTHING_PROFILE_TIME(); for (std::size_t i = 0; i < samples.Count; i++) Action(samples.T[i]); }
+		AnimationActionTime(InlineFunction<void(NumericType)> action) : Action(std::move(action)) { };
 		~AnimationActionTime() { };
 	};
 
+	// Animation that contains a lambda receiving a whole batch of times, index tells which sample of the batch each time belongs to
+	template<typename NumericType> class AnimationActionBatch : public IAnimation<NumericType>
+	{
+	public:
+		InlineFunction<void(const NumericType* t, const std::size_t* index, std::size_t count)> Action;
+		void Play(NumericType t, NumericType t0) override { ANIMATEANYTHING_PROFILE_PLAY(1); ANIMATEANYTHING_PROFILE_TIME(); std::size_t index = 0; Action(&t, &index, 1); }
+		void PlayBatch(const TimeSamples<NumericType>& samples) override { ANIMATEANYTHING_PROFILE_PLAY(samples.Count); ANIMATEANYTHING_PROFILE_TIME(); if (samples.Count) Action(samples.T, samples.Index, samples.Count); }
+		AnimationActionBatch(InlineFunction<void(const NumericType*, const std::size_t*, std::size_t)> action) : Action(std::move(action)) { };
+		~AnimationActionBatch() { };
+	};
+
+	// Animation that contains a lambda with the instance index and time, used when one graph is played for many instances
+	template<typename NumericType> class AnimationActionInstance : public IAnimation<NumericType>
+	{
+	public:
+		InlineFunction<void(std::size_t, NumericType)> Action;
+		void Play(NumericType t, NumericType t0) override { ANIMATEANYTHING_PROFILE_PLAY(1); ANIMATEANYTHING_PROFILE_TIME(); Action(0, t); }
+		void PlayBatch(const TimeSamples<NumericType>& samples) override { ANIMATEANYTHING_PROFILE_PLAY(samples.Count); ANIMATEANYTHING_PROFILE_TIME(); for (std::size_t i = 0; i < samples.Count; i++) Action(samples.Index[i], samples.T[i]); }
+		AnimationActionInstance(InlineFunction<void(std::size_t, NumericType)> action) : Action(std::move(action)) { };
+		~AnimationActionInstance() { };
+	};
+
+	// Base of the range nodes. Enter and Exit play when (t0, t) crosses into or out of the range, like an event,
+	// with ChangedOnly the child is skipped while its local time is the same as in the previous Play
+	template<typename NumericType> class AnimationRange : public IAnimation<NumericType>
+	{
+	private:
+		NumericType last = 0;
+		bool played = false;
+
+	protected:
+		void PlayRange(IAnimation<NumericType>& child, bool inside, bool inside0, NumericType local, NumericType local0)
+		{
+			if (Exit && inside0 && !inside) Exit->Play(local, local0);
+			if (Enter && inside && !inside0) Enter->Play(local, local0);
+			if (!inside)
+			{
+				played = false;
+				return;
+			}
+			if (ChangedOnly)
+			{
+				if (played && last == local) return;
+				played = true;
+				last = local;
+			}
+			ANIMATEANYTHING_PROFILE_HIT(1);
+			child.Play(local, local0);
+		}
+
+	public:
+		IAnimation<NumericType>* Enter = nullptr;
+		IAnimation<NumericType>* Exit = nullptr;
+		bool ChangedOnly = false;
+
+		bool HasOptions() const { return Enter || Exit || ChangedOnly; }
+
+		// change suppression remembers the previous play
+		void SaveState(std::vector<char>& state) const override
+		{
+			if (!ChangedOnly) return;
+			SaveValue(state, last);
+			SaveValue(state, played);
+		}
+
+		const char* RestoreState(const char* state) override
+		{
+			if (!ChangedOnly) return state;
+			state = RestoreValue(state, last);
+			return RestoreValue(state, played);
+		}
+
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override
+		{
+			if (Enter) visit(*Enter);
+			if (Exit) visit(*Exit);
+		}
+	};
+
 	// Animation that happens after a specified moment
-	template<typename NumericType> class AnimationAfter : public IAnimation<NumericType>
+	template<typename NumericType> class AnimationAfter : public AnimationRange<NumericType>
 	{
 	public:
 		NumericType Start;
 		IAnimation<NumericType>& Animation;
-		void Play(NumericType t, NumericType t0) override { if (Start <= t) Animation.Play(t - Start, t0 - Start); }
+		void Play(NumericType t, NumericType t0) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(1);
+			if (!this->HasOptions())
+			{
+				if (Start <= t)
+				{
+					ANIMATEANYTHING_PROFILE_HIT(1);
+					Animation.Play(t - Start, t0 - Start);
+				}
+				return;
+			}
+			this->PlayRange(Animation, Start <= t, Start <= t0, t - Start, t0 - Start);
+		}
+		void PlayBatch(const TimeSamples<NumericType>& samples) override
+		{
+			if (this->HasOptions())
+			{
+				IAnimation<NumericType>::PlayBatch(samples);
+				return;
+			}
+			ANIMATEANYTHING_PROFILE_PLAY(samples.Count);
+			auto selected = samples.Scratch->Select(samples, Start, [start = Start](NumericType t, NumericType t0) { return start <= t; });
+			ANIMATEANYTHING_PROFILE_HIT(selected.Count);
+			if (selected.Count) Animation.PlayBatch(selected);
+			samples.Scratch->Pop();
+		}
+		NumericType NextActivity(NumericType t) override
+		{
+			NumericType next = Animation.NextActivity(t < Start ? 0 : t - Start);
+			next = next == this->Never() ? next : next + Start;
+			if (this->Enter && t < Start && Start < next) next = Start;
+			return next;
+		}
 		AnimationAfter(NumericType start, IAnimation<NumericType>& action) : Start(start), Animation(action) { }
+		AnimationAfter(NumericType start, IAnimation<NumericType>* action) : Start(start), Animation(*action) { }
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override
+		{
+			visit(Animation);
+			AnimationRange<NumericType>::ForEachChild(visit);
+		}
 		~AnimationAfter(){ }
 	};
 
 	// Animation that happens before a specified moment
-	template<typename NumericType> class AnimationBefore : public IAnimation<NumericType>
+	template<typename NumericType> class AnimationBefore : public AnimationRange<NumericType>
 	{
 	public:
 		NumericType Finish;
 		IAnimation<NumericType>& Animation;
-		void Play(NumericType t, NumericType t0) override { if (t < Finish) Animation.Play(t - Finish, t0 - Finish); }
+		void Play(NumericType t, NumericType t0) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(1);
+			if (!this->HasOptions())
+			{
+				if (t < Finish)
+				{
+					ANIMATEANYTHING_PROFILE_HIT(1);
+					Animation.Play(t - Finish, t0 - Finish);
+				}
+				return;
+			}
+			this->PlayRange(Animation, t < Finish, t0 < Finish, t - Finish, t0 - Finish);
+		}
+		void PlayBatch(const TimeSamples<NumericType>& samples) override
+		{
+			if (this->HasOptions())
+			{
+				IAnimation<NumericType>::PlayBatch(samples);
+				return;
+			}
+			ANIMATEANYTHING_PROFILE_PLAY(samples.Count);
+			auto selected = samples.Scratch->Select(samples, Finish, [finish = Finish](NumericType t, NumericType t0) { return t < finish; });
+			ANIMATEANYTHING_PROFILE_HIT(selected.Count);
+			if (selected.Count) Animation.PlayBatch(selected);
+			samples.Scratch->Pop();
+		}
+		NumericType NextActivity(NumericType t) override
+		{
+			if (!(t < Finish)) return this->Never();
+			NumericType next = Animation.NextActivity(t - Finish);
+			next = next < 0 ? next + Finish : this->Never();
+			if (this->Exit && Finish < next) next = Finish;
+			return next;
+		}
 		AnimationBefore(NumericType finish, IAnimation<NumericType>& action) : Finish(finish), Animation(action) { }
+		AnimationBefore(NumericType finish, IAnimation<NumericType>* action) : Finish(finish), Animation(*action) { }
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override
+		{
+			visit(Animation);
+			AnimationRange<NumericType>::ForEachChild(visit);
+		}
 		~AnimationBefore() { }
 	};
 
-	// Animation that happens between two moments
-	template<typename NumericType> class AnimationBetween : public IAnimation<NumericType>
+	// Animation that happens between two moments
+	template<typename NumericType> class AnimationBetween : public AnimationRange<NumericType>
+	{
+	public:
+		NumericType Start;
+		NumericType Finish;
+		IAnimation<NumericType>& Animation;
+		void Play(NumericType t, NumericType t0) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(1);
+			if (!this->HasOptions())
+			{
+				if (Start <= t && t < Finish)
+				{
+					ANIMATEANYTHING_PROFILE_HIT(1);
+					Animation.Play(t - Start, t0 - Start);
+				}
+				return;
+			}
+			this->PlayRange(Animation, Start <= t && t < Finish, Start <= t0 && t0 < Finish, t - Start, t0 - Start);
+		}
+		void PlayBatch(const TimeSamples<NumericType>& samples) override
+		{
+			if (this->HasOptions())
+			{
+				IAnimation<NumericType>::PlayBatch(samples);
+				return;
+			}
+			ANIMATEANYTHING_PROFILE_PLAY(samples.Count);
+			auto selected = samples.Scratch->Select(samples, Start, [start = Start, finish = Finish](NumericType t, NumericType t0) { return (start <= t) & (t < finish); });
+			ANIMATEANYTHING_PROFILE_HIT(selected.Count);
+			if (selected.Count) Animation.PlayBatch(selected);
+			samples.Scratch->Pop();
+		}
+		NumericType NextActivity(NumericType t) override
+		{
+			if (!(t < Finish)) return this->Never();
+			NumericType next = Animation.NextActivity(t < Start ? 0 : t - Start);
+			next = next < Finish - Start ? next + Start : this->Never();
+			if (this->Enter && t < Start && Start < next) next = Start;
+			if (this->Exit && Finish < next) next = Finish;
+			return next;
+		}
+		AnimationBetween(NumericType start, NumericType finish, IAnimation<NumericType>& action) : Start(start), Finish(finish), Animation(action) { }
+		AnimationBetween(NumericType start, NumericType finish, IAnimation<NumericType>* action) : Start(start), Finish(finish), Animation(*action) { }
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override
+		{
+			visit(Animation);
+			AnimationRange<NumericType>::ForEachChild(visit);
+		}
+		~AnimationBetween() { }
+	};
+
+	// Skip part of the animation
+	template<typename NumericType> class AnimationSeek : public IAnimation<NumericType>
+	{
+	public:
+		NumericType Skip;
+		IAnimation<NumericType>& Animation;
+		void Play(NumericType t, NumericType t0) override { ANIMATEANYTHING_PROFILE_PLAY(1); Animation.Play(t + Skip, t0 + Skip); }
+		void PlayBatch(const TimeSamples<NumericType>& samples) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(samples.Count);
+			Animation.PlayBatch(samples.Scratch->Map(samples, [skip = Skip](NumericType t) { return t + skip; }));
+			samples.Scratch->Pop();
+		}
+		NumericType NextActivity(NumericType t) override
+		{
+			NumericType next = Animation.NextActivity(t + Skip);
+			return next == this->Never() ? next : next - Skip;
+		}
+		AnimationSeek(NumericType skip, IAnimation<NumericType>& action) : Skip(skip), Animation(action) { }
+		AnimationSeek(NumericType skip, IAnimation<NumericType>* action) : Skip(skip), Animation(*action) { }
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override { visit(Animation); }
+		~AnimationSeek() { }
+	};
+
+	// An event is only triggered once, detection is performed based on t and t0
+	template<typename NumericType> class AnimationEvent : public IAnimation<NumericType>
+	{
+	public:
+		NumericType Moment;
+		IAnimation<NumericType>& Animation;
+		void Play(NumericType t, NumericType t0) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(1);
+			if ((Moment <= t && t0 < Moment) || (t <= Moment && Moment < t0))
+			{
+				ANIMATEANYTHING_PROFILE_HIT(1);
+				Animation.Play(t, t0);
+			}
+		}
+		void PlayBatch(const TimeSamples<NumericType>& samples) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(samples.Count);
+			auto selected = samples.Scratch->Select(samples, 0, [moment = Moment](NumericType t, NumericType t0) { return (moment <= t && t0 < moment) || (t <= moment && moment < t0); });
+			ANIMATEANYTHING_PROFILE_HIT(selected.Count);
+			if (selected.Count) Animation.PlayBatch(selected);
+			samples.Scratch->Pop();
+		}
+		NumericType NextActivity(NumericType t) override { return t < Moment ? Moment : this->Never(); }
+		AnimationEvent(NumericType start, IAnimation<NumericType>& action) : Moment(start), Animation(action) { }
+		AnimationEvent(NumericType start, IAnimation<NumericType>* action) : Moment(start), Animation(*action) { }
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override { visit(Animation); }
+		~AnimationEvent() { }
+	};
+
+	// Scale the timeunit by a constant
+	template<typename NumericType> class AnimationStretch : public IAnimation<NumericType>
+	{
+	public:
+		NumericType Scale;
+		IAnimation<NumericType>& Animation;
+		void Play(NumericType t, NumericType t0) override { ANIMATEANYTHING_PROFILE_PLAY(1); Animation.Play(t*Scale, t0*Scale); }
+		void PlayBatch(const TimeSamples<NumericType>& samples) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(samples.Count);
+			Animation.PlayBatch(samples.Scratch->Map(samples, [scale = Scale](NumericType t) { return t*scale; }));
+			samples.Scratch->Pop();
+		}
+		NumericType NextActivity(NumericType t) override
+		{
+			if (0 < Scale)
+			{
+				NumericType next = Animation.NextActivity(t*Scale);
+				if (next == this->Never()) return next;
+				next = next / Scale;
+				return next < t ? t : next;
+			}
+			// the child sees constant time or time going backward
+			if (Scale == 0) return Animation.NextActivity(0) <= 0 ? t : this->Never();
+			return Animation.NextActivity(this->Earliest()) == this->Never() ? this->Never() : t;
+		}
+		AnimationStretch(NumericType scale, IAnimation<NumericType>& action) : Scale(scale), Animation(action) { }
+		AnimationStretch(NumericType scale, IAnimation<NumericType>* action) : Scale(scale), Animation(*action) { }
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override { visit(Animation); }
+		~AnimationStretch() { }
+	};
+
+	// floor(a * b / denominator) for 0 <= a, b < denominator, the quotient is below b so it always fits
+	template<typename NumericType> NumericType MultiplyBelow(NumericType a, NumericType b, NumericType denominator)
+	{
+		if (a == 0 || b <= std::numeric_limits<NumericType>::max() / a) return a * b / denominator;
+#ifdef __SIZEOF_INT128__
+		if (sizeof(NumericType) <= 8) return NumericType((unsigned __int128)(a) * (unsigned __int128)(b) / (unsigned __int128)(denominator));
+#endif
+		// shift and add, quotient and remainder are kept separately and the remainder stays below 2 * denominator
+		using Unsigned = typename std::make_unsigned<NumericType>::type;
+		Unsigned ua = Unsigned(a), ub = Unsigned(b), d = Unsigned(denominator), quotient = 0, remainder = 0;
+		for (int bit = std::numeric_limits<Unsigned>::digits - 1; bit >= 0; bit--)
+		{
+			quotient <<= 1;
+			remainder <<= 1;
+			if (remainder >= d) { remainder -= d; quotient++; }
+			if ((ub >> bit) & 1)
+			{
+				remainder += ua;
+				if (remainder >= d) { remainder -= d; quotient++; }
+			}
+		}
+		return NumericType(quotient);
+	}
+
+	// floor(t * numerator / denominator) for a positive denominator. Integral times are not widened: t and numerator are
+	// split by the denominator and the product of the two remainders is taken in 128 bits or by shifts, so only a result
+	// that does not fit overflows. The result is exact and rounds toward the past.
+	template<typename NumericType> NumericType MultiplyRatio(NumericType t, NumericType numerator, NumericType denominator, std::true_type)
+	{
+		NumericType whole = t / denominator, part = t % denominator;
+		if (part < 0)
+		{
+			whole = whole - 1;
+			part = part + denominator;
+		}
+		NumericType times = numerator / denominator, rest = numerator % denominator;
+		if (rest < 0)
+		{
+			times = times - 1;
+			rest = rest + denominator;
+		}
+		// t * n / d = (whole * d + part) * (times * d + rest) / d
+		return whole * numerator + part * times + MultiplyBelow(part, rest, denominator);
+	}
+
+	template<typename NumericType> NumericType MultiplyRatio(NumericType t, NumericType numerator, NumericType denominator, std::false_type)
+	{
+		return t * numerator / denominator;
+	}
+
+	template<typename NumericType> NumericType MultiplyRatio(NumericType t, NumericType numerator, NumericType denominator)
+	{
+		return MultiplyRatio(t, numerator, denominator, std::is_integral<NumericType>());
+	}
+
+	// Scale the timeunit by Numerator / Denominator, exact for integral time like ticks where Stretch can only scale
+	// by whole numbers. Local time is rounded toward the past, so it never goes backward and events crossed by it fire once.
+	template<typename NumericType> class AnimationStretchRatio : public IAnimation<NumericType>
+	{
+	private:
+		NumericType rangeNumerator;
+		NumericType range; // times up to this far from 0 multiply by rangeNumerator without overflow
+
+		static NumericType Range(NumericType numerator)
+		{
+			if (!std::is_integral<NumericType>::value || numerator == 0) return std::numeric_limits<NumericType>::max();
+			return std::numeric_limits<NumericType>::max() / (numerator < 0 ? NumericType(0) - numerator : numerator);
+		}
+
+		// local time, one multiply and one division while t * Numerator fits, a Numerator changed later takes the long way
+		NumericType Local(NumericType t, std::true_type) const
+		{
+			if (Numerator == rangeNumerator && t <= range && NumericType(0) - range <= t)
+			{
+				NumericType scaled = t * Numerator;
+				NumericType local = scaled / Denominator;
+				return scaled % Denominator < 0 ? local - 1 : local;
+			}
+			return MultiplyRatio(t, Numerator, Denominator, std::true_type());
+		}
+
+		NumericType Local(NumericType t, std::false_type) const { return t * Numerator / Denominator; }
+
+	public:
+		NumericType Numerator;
+		NumericType Denominator; // above 0, the constructors move the sign to the numerator
+		IAnimation<NumericType>& Animation;
+		void Play(NumericType t, NumericType t0) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(1);
+			Animation.Play(Local(t, std::is_integral<NumericType>()), Local(t0, std::is_integral<NumericType>()));
+		}
+		void PlayBatch(const TimeSamples<NumericType>& samples) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(samples.Count);
+			Animation.PlayBatch(samples.Scratch->Map(samples, [this](NumericType t) { return Local(t, std::is_integral<NumericType>()); }));
+			samples.Scratch->Pop();
+		}
+		NumericType NextActivity(NumericType t) override
+		{
+			if (0 < Numerator)
+			{
+				NumericType local = Local(t, std::is_integral<NumericType>());
+				NumericType next = Animation.NextActivity(local);
+				if (next == this->Never()) return next;
+				if (next <= local) return t;
+				// first moment whose local time reaches next, ceil(next * Denominator / Numerator)
+				if (std::is_integral<NumericType>::value && std::numeric_limits<NumericType>::max() / Denominator < (next < 0 ? NumericType(0) - next : next) / Numerator + 1) return next < 0 ? t : this->Never();
+				next = NumericType(0) - MultiplyRatio(NumericType(0) - next, Denominator, Numerator);
+				return next < t ? t : next;
+			}
+			// the child sees constant time or time going backward
+			if (Numerator == 0) return Animation.NextActivity(0) <= 0 ? t : this->Never();
+			return Animation.NextActivity(this->Earliest()) == this->Never() ? this->Never() : t;
+		}
+		AnimationStretchRatio(NumericType numerator, NumericType denominator, IAnimation<NumericType>& action) :
+			rangeNumerator(denominator < 0 ? NumericType(0) - numerator : numerator), range(Range(rangeNumerator)),
+			Numerator(rangeNumerator), Denominator(denominator < 0 ? NumericType(0) - denominator : denominator), Animation(action) { }
+		AnimationStretchRatio(NumericType numerator, NumericType denominator, IAnimation<NumericType>* action) : AnimationStretchRatio(numerator, denominator, *action) { }
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override { visit(Animation); }
+		~AnimationStretchRatio() { }
+	};
+
+	// Alter timeline using custom lambda function
+	template<typename NumericType> class AnimationTimeTransform : public IAnimation<NumericType>
+	{
+	public:
+		InlineFunction<NumericType(NumericType)> Transform;
+		IAnimation<NumericType>& Animation;
+		void Play(NumericType t, NumericType t0) override { ANIMATEANYTHING_PROFILE_PLAY(1); Animation.Play(Transform(t), Transform(t0)); }
+		void PlayBatch(const TimeSamples<NumericType>& samples) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(samples.Count);
+			Animation.PlayBatch(samples.Scratch->Map(samples, Transform));
+			samples.Scratch->Pop();
+		}
+		NumericType NextActivity(NumericType t) override { return Animation.NextActivity(this->Earliest()) == this->Never() ? this->Never() : t; } // the transform is unknown
+		AnimationTimeTransform(InlineFunction<NumericType(NumericType)> transform, IAnimation<NumericType>& action) : Transform(std::move(transform)), Animation(action) { }
+		AnimationTimeTransform(InlineFunction<NumericType(NumericType)> transform, IAnimation<NumericType>* action) : Transform(std::move(transform)), Animation(*action) { }
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override { visit(Animation); }
+		~AnimationTimeTransform() { }
+	};
+
+	// Easing curves map progress in [0, 1] to eased progress, the plain curves ease in
+	struct EaseLinear
+	{
+		template<typename Real> Real operator()(Real x) const { return x; }
+	};
+
+	struct EaseQuad
+	{
+		template<typename Real> Real operator()(Real x) const { return x * x; }
+	};
+
+	struct EaseCubic
+	{
+		template<typename Real> Real operator()(Real x) const { return x * x * x; }
+	};
+
+	struct EaseExpo
+	{
+		template<typename Real> Real operator()(Real x) const { return x <= 0 ? Real(0) : std::pow(Real(2), 10 * x - 10); }
+	};
+
+	struct EaseElastic
+	{
+		template<typename Real> Real operator()(Real x) const
+		{
+			if (x <= 0) return 0;
+			if (x >= 1) return 1;
+			return -std::pow(Real(2), 10 * x - 10) * std::sin((x * 10 - Real(10.75)) * Real(2.0943951023931957));
+		}
+	};
+
+	struct EaseBounce
+	{
+		template<typename Real> Real operator()(Real x) const { return 1 - Out(1 - x); }
+
+		template<typename Real> static Real Out(Real x)
+		{
+			const Real n = Real(7.5625), d = Real(2.75);
+			if (x < 1 / d) return n * x * x;
+			if (x < 2 / d) { x -= Real(1.5) / d; return n * x * x + Real(0.75); }
+			if (x < Real(2.5) / d) { x -= Real(2.25) / d; return n * x * x + Real(0.9375); }
+			x -= Real(2.625) / d;
+			return n * x * x + Real(0.984375);
+		}
+	};
+
+	// Cubic bezier from (0, 0) to (1, 1) with control points (X1, Y1) and (X2, Y2), like CSS cubic-bezier
+	struct EaseCubicBezier
+	{
+		double X1, Y1, X2, Y2;
+
+		template<typename Real> Real operator()(Real x) const
+		{
+			if (x <= 0) return 0;
+			if (x >= 1) return 1;
+			double target = double(x), s = target;
+			// newton steps, bisection when the slope is too flat
+			for (int i = 0; i < 8; i++)
+			{
+				double error = Bezier(s, X1, X2) - target;
+				if (std::fabs(error) < 1e-7) return Real(Bezier(s, Y1, Y2));
+				double slope = Slope(s, X1, X2);
+				if (std::fabs(slope) < 1e-6) break;
+				s -= error / slope;
+			}
+			double lo = 0, hi = 1;
+			s = target;
+			for (int i = 0; i < 40 && hi - lo > 1e-7; i++)
+			{
+				if (Bezier(s, X1, X2) < target) lo = s; else hi = s;
+				s = (lo + hi) / 2;
+			}
+			return Real(Bezier(s, Y1, Y2));
+		}
+
+		static double Bezier(double s, double p1, double p2) { return ((1 - 3 * p2 + 3 * p1) * s + (3 * p2 - 6 * p1)) * s * s + 3 * p1 * s; }
+		static double Slope(double s, double p1, double p2) { return 3 * (1 - 3 * p2 + 3 * p1) * s * s + 2 * (3 * p2 - 6 * p1) * s + 3 * p1; }
+
+		EaseCubicBezier(double x1, double y1, double x2, double y2) : X1(x1), Y1(y1), X2(x2), Y2(y2) { }
+	};
+
+	// Play a curve backward to ease out
+	template<typename Curve> struct EaseOut
 	{
-	public:
-		NumericType Start;
-		NumericType Finish;
-		IAnimation<NumericType>& Animation;
-		void Play(NumericType t, NumericType t0) override { if (Start <= t && t < Finish) Animation.Play(t - Start, t0 - Start); }
-		AnimationBetween(NumericType start, NumericType finish, IAnimation<NumericType>& action) : Start(start), Finish(finish), Animation(action) { }
-		AnimationBetween(NumericType start, NumericType finish, IAnimation<NumericType>* action) : Start(start), Finish(finish), Animation(*action) { }
-		~AnimationBetween() { }
+		Curve Function;
+		template<typename Real> Real operator()(Real x) const { return 1 - Function(1 - x); }
+		EaseOut(Curve function = Curve()) : Function(function) { }
 	};
 
-	// Skip part of the animation
-	template<typename NumericType> class AnimationSeek : public IAnimation<NumericType>
+	// Ease in for the first half, out for the second
+	template<typename Curve> struct EaseInOut
+	{
+		Curve Function;
+		template<typename Real> Real operator()(Real x) const { return x < Real(0.5) ? Function(2 * x) / 2 : 1 - Function(2 - 2 * x) / 2; }
+		EaseInOut(Curve function = Curve()) : Function(function) { }
+	};
+
+	// Ease the local time over Duration, the curve is part of the type so it is called directly.
+	// Times outside [0, Duration] are clamped, integral times are eased in double precision.
+	template<typename NumericType, typename Curve> class AnimationEase : public IAnimation<NumericType>
 	{
+	private:
+		using Real = typename std::conditional<std::is_floating_point<NumericType>::value, NumericType, double>::type;
+
+		NumericType Map(NumericType t) const
+		{
+			Real x = Real(t) / Real(Duration);
+			x = x < 0 ? Real(0) : (x > 1 ? Real(1) : x);
+			return NumericType(Function(x) * Real(Duration));
+		}
+
 	public:
-		NumericType Skip;
+		NumericType Duration;
+		Curve Function;
 		IAnimation<NumericType>& Animation;
-		void Play(NumericType t, NumericType t0) override { Animation.Play(t + Skip, t0 + Skip); }
-		AnimationSeek(NumericType skip, IAnimation<NumericType>& action) : Skip(skip), Animation(action) { }
-		~AnimationSeek() { }
+		void Play(NumericType t, NumericType t0) override { ANIMATEANYTHING_PROFILE_PLAY(1); Animation.Play(Map(t), Map(t0)); }
+		void PlayBatch(const TimeSamples<NumericType>& samples) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(samples.Count);
+			Animation.PlayBatch(samples.Scratch->Map(samples, [this](NumericType t) { return Map(t); }));
+			samples.Scratch->Pop();
+		}
+		NumericType NextActivity(NumericType t) override
+		{
+			if (Animation.NextActivity(this->Earliest()) == this->Never()) return this->Never();
+			// clamped, the child sees a constant time
+			if (!(t < Duration)) return Animation.NextActivity(Map(Duration)) <= Map(Duration) ? t : this->Never();
+			if (t < 0) return Animation.NextActivity(Map(0)) <= Map(0) ? t : 0;
+			return t;
+		}
+		AnimationEase(NumericType duration, Curve function, IAnimation<NumericType>& action) : Duration(duration), Function(function), Animation(action) { }
+		AnimationEase(NumericType duration, Curve function, IAnimation<NumericType>* action) : Duration(duration), Function(function), Animation(*action) { }
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override { visit(Animation); }
+		~AnimationEase() { }
 	};
 
-	// An event is only triggered once, detection is performed based on t and t0
-	template<typename NumericType> class AnimationEvent : public IAnimation<NumericType>
+	// Time transform baked into a table over [From, To], sampled with linear interpolation.
+	// The table starts at Resolution intervals and doubles until the error measured between samples is below
+	// MaxError or MaxResolution is reached, times outside the range call the transform.
+	template<typename NumericType> class AnimationTimeTable : public IAnimation<NumericType>
 	{
+	private:
+		using Real = typename std::conditional<std::is_floating_point<NumericType>::value, NumericType, double>::type;
+
+		std::vector<Real> table;
+		Real scale = 0;
+		Real error = 0;
+
+		Real Sample(Real at) const { return Real(Transform(NumericType(at))); }
+
+		void Bake(std::size_t resolution)
+		{
+			table.resize(resolution + 1);
+			Real step = (Real(To) - Real(From)) / Real(resolution);
+			for (std::size_t i = 0; i <= resolution; i++) table[i] = Sample(Real(From) + step * Real(i));
+			scale = Real(resolution) / (Real(To) - Real(From));
+			error = 0;
+			for (std::size_t i = 0; i < resolution; i++)
+			{
+				Real middle = Real(From) + step * (Real(i) + Real(0.5));
+				error = std::max(error, Real(std::fabs(Sample(middle) - (table[i] + table[i + 1]) / 2)));
+			}
+		}
+
+		NumericType Map(NumericType t) const
+		{
+			if (t < From || To < t) return Transform(t);
+			Real position = (Real(t) - Real(From)) * scale;
+			std::size_t index = std::size_t(position);
+			if (index >= table.size() - 1) return NumericType(table.back());
+			Real u = position - Real(index);
+			return NumericType(table[index] + (table[index + 1] - table[index]) * u);
+		}
+
 	public:
-		NumericType Moment;
+		std::function<NumericType(NumericType)> Transform;
+		NumericType From;
+		NumericType To;
 		IAnimation<NumericType>& Animation;
-		void Play(NumericType t, NumericType t0) override { if (Moment <= t && t0 < Moment || t <= Moment && Moment < t0) Animation.Play(t, t0); }
-		AnimationEvent(NumericType start, IAnimation<NumericType>& action) : Moment(start), Animation(action) { }
-		~AnimationEvent() { }
+
+		std::size_t Resolution() const { return table.size() - 1; }
+		Real Error() const { return error; } // largest error measured between samples
+
+		void Play(NumericType t, NumericType t0) override { ANIMATEANYTHING_PROFILE_PLAY(1); Animation.Play(Map(t), Map(t0)); }
+		void PlayBatch(const TimeSamples<NumericType>& samples) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(samples.Count);
+			Animation.PlayBatch(samples.Scratch->Map(samples, [this](NumericType t) { return Map(t); }));
+			samples.Scratch->Pop();
+		}
+
+		NumericType NextActivity(NumericType t) override { return Animation.NextActivity(this->Earliest()) == this->Never() ? this->Never() : t; }
+
+		AnimationTimeTable(std::function<NumericType(NumericType)> transform, NumericType from, NumericType to, std::size_t resolution, Real maxError, IAnimation<NumericType>* action, std::size_t maxResolution = 1 << 16) :
+			Transform(transform), From(from), To(to), Animation(*action)
+		{
+			if (!(From < To)) To = From + 1;
+			resolution = resolution ? resolution : 1;
+			Bake(resolution);
+			while (error > maxError && resolution * 2 <= maxResolution)
+			{
+				resolution *= 2;
+				Bake(resolution);
+			}
+		}
+		AnimationTimeTable(std::function<NumericType(NumericType)> transform, NumericType from, NumericType to, std::size_t resolution, Real maxError, IAnimation<NumericType>& action, std::size_t maxResolution = 1 << 16) :
+			AnimationTimeTable(transform, from, to, resolution, maxError, &action, maxResolution) { }
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override { visit(Animation); }
+		~AnimationTimeTable() { }
 	};
 
-	// Scale the timeunit by a constant
-	template<typename NumericType> class AnimationStretch : public IAnimation<NumericType>
+	// Monotonic memory for animation nodes, objects are placed back to back in creation order and released all at once
+	class AnimationArena
 	{
+	private:
+
+		// a block of memory, the data follows the header
+		struct Block
+		{
+			Block* Next;
+			std::size_t Size;
+		};
+
+		// placed in front of every object so that it can be destroyed on reset, links to the previous object
+		struct Record
+		{
+			Record* Previous;
+			void* Object;
+			void(*Destroy)(void*);
+		};
+
+		Block* first = nullptr; // all blocks, kept between resets
+		Block* current = nullptr; // block being filled
+		std::size_t used = 0; // bytes used in the current block
+		std::size_t blockSize;
+		Record* last = nullptr; // most recently created object
+		std::size_t objects = 0;
+		std::size_t bytesUsed = 0;
+
+		static char* Data(Block* block) { return reinterpret_cast<char*>(block + 1); }
+
+		template<typename Type> static void DestroyObject(void* object) { static_cast<Type*>(object)->~Type(); }
+
+		// try to carve size bytes out of the current block
+		void* TryAllocate(std::size_t size, std::size_t alignment)
+		{
+			if (current == nullptr) return nullptr;
+			std::size_t address = reinterpret_cast<std::size_t>(Data(current)) + used;
+			std::size_t padding = (alignment - address % alignment) % alignment;
+			if (used + padding + size > current->Size) return nullptr;
+			used += padding + size;
+			bytesUsed += padding + size;
+			return reinterpret_cast<void*>(address + padding);
+		}
+
+		// move on to the next kept block or get a new one from the system
+		void NextBlock(std::size_t minimum)
+		{
+			Block* next = current ? current->Next : first;
+			while (next != nullptr && next->Size < minimum) next = next->Next;
+			if (next == nullptr)
+			{
+				std::size_t size = minimum > blockSize ? minimum : blockSize;
+				next = static_cast<Block*>(std::malloc(sizeof(Block) + size));
+				if (next == nullptr) throw std::bad_alloc();
+				next->Size = size;
+				next->Next = nullptr;
+				Block** tail = &first;
+				while (*tail != nullptr) tail = &(*tail)->Next;
+				*tail = next;
+			}
+			current = next;
+			used = 0;
+		}
+
 	public:
-		NumericType Scale;
-		IAnimation<NumericType>& Animation;
-		void Play(NumericType t, NumericType t0) override { Animation.Play(t*Scale, t0*Scale); }
-		AnimationStretch(NumericType scale, IAnimation<NumericType>& action) : Scale(scale), Animation(action) { }
-		~AnimationStretch() { }
+
+		AnimationArena(std::size_t blockSize = 64 * 1024) : blockSize(blockSize) { }
+		AnimationArena(const AnimationArena&) = delete;
+		AnimationArena& operator=(const AnimationArena&) = delete;
+
+		// Raw memory that lives until Reset, nothing is destroyed
+		void* Allocate(std::size_t size, std::size_t alignment)
+		{
+			void* memory = TryAllocate(size, alignment);
+			if (memory == nullptr)
+			{
+				NextBlock(size + alignment);
+				memory = TryAllocate(size, alignment);
+			}
+			return memory;
+		}
+
+		// Construct an object in the arena, it is destroyed by Reset or when the arena goes away
+		template<typename Type, typename ...Args> Type* Create(Args&&... args)
+		{
+			Record* record = static_cast<Record*>(Allocate(sizeof(Record), alignof(Record)));
+			void* memory = Allocate(sizeof(Type), alignof(Type));
+			Type* object = new (memory) Type(std::forward<Args>(args)...);
+			record->Previous = last;
+			record->Object = object;
+			record->Destroy = &DestroyObject<Type>;
+			last = record;
+			objects++;
+			return object;
+		}
+
+		// Destroy all objects in reverse creation order, the blocks are kept for reuse
+		void Reset()
+		{
+			for (Record* record = last; record != nullptr; record = record->Previous)
+			{
+				record->Destroy(record->Object);
+			}
+			last = nullptr;
+			objects = 0;
+			bytesUsed = 0;
+			current = nullptr;
+			used = 0;
+		}
+
+		std::size_t ObjectCount() const { return objects; }
+		std::size_t BytesUsed() const { return bytesUsed; }
+
+		std::size_t BytesReserved() const
+		{
+			std::size_t total = 0;
+			for (Block* block = first; block != nullptr; block = block->Next) total += sizeof(Block) + block->Size;
+			return total;
+		}
+
+		std::size_t BlockCount() const
+		{
+			std::size_t count = 0;
+			for (Block* block = first; block != nullptr; block = block->Next) count++;
+			return count;
+		}
+
+		~AnimationArena()
+		{
+			Reset();
+			while (first != nullptr)
+			{
+				Block* next = first->Next;
+				std::free(first);
+				first = next;
+			}
+		}
 	};
 
-	// Alter timeline using custom lambda function
-	template<typename NumericType> class AnimationTimeTransform : public IAnimation<NumericType>
+	// Allocator for containers inside nodes, takes memory from an arena when there is one and from the heap otherwise.
+	// Arena memory is only released on reset, so a container that keeps growing leaves its old buffers behind.
+	template<typename Type> class ArenaAllocator
 	{
 	public:
-		std::function<NumericType(NumericType)> Transform;
-		IAnimation<NumericType>& Animation;
-		void Play(NumericType t, NumericType t0) override { Animation.Play(Transform(t), Transform(t0)); }
-		AnimationTimeTransform(std::function<NumericType(NumericType)> transform, IAnimation<NumericType>& action) : Transform(transform), Animation(action) { }
-		~AnimationTimeTransform() { }
+		using value_type = Type;
+		AnimationArena* Arena = nullptr;
+
+		ArenaAllocator() { }
+		explicit ArenaAllocator(AnimationArena* arena) : Arena(arena) { }
+		template<typename Other> ArenaAllocator(const ArenaAllocator<Other>& other) : Arena(other.Arena) { }
+
+		Type* allocate(std::size_t count)
+		{
+			if (Arena) return static_cast<Type*>(Arena->Allocate(count * sizeof(Type), alignof(Type)));
+			return static_cast<Type*>(::operator new(count * sizeof(Type)));
+		}
+
+		void deallocate(Type* memory, std::size_t /*count*/)
+		{
+			if (!Arena) ::operator delete(memory);
+		}
+
+		template<typename Other> bool operator==(const ArenaAllocator<Other>& other) const { return Arena == other.Arena; }
+		template<typename Other> bool operator!=(const ArenaAllocator<Other>& other) const { return Arena != other.Arena; }
 	};
 
 	// Run multiple animations
 	template<typename NumericType> class AnimationParallel : public IAnimation<NumericType>
 	{
 	public:
-		std::vector<IAnimation<NumericType>*> Animations;
-		void Play(NumericType t, NumericType t0) override { for (auto& animation : Animations) animation->Play(t, t0); }
-		AnimationParallel() { }
+		// The children take their memory from the arena of the container. This is not a plain
+		// std::vector<IAnimation<NumericType>*>, code that names the type of Animations should use Children or auto.
+		using Children = std::vector<IAnimation<NumericType>*, ArenaAllocator<IAnimation<NumericType>*>>;
+		Children Animations;
+		void Play(NumericType t, NumericType t0) override { ANIMATEANYTHING_PROFILE_PLAY(1); for (auto& animation : Animations) animation->Play(t, t0); }
+		void PlayBatch(const TimeSamples<NumericType>& samples) override { ANIMATEANYTHING_PROFILE_PLAY(samples.Count); for (auto& animation : Animations) animation->PlayBatch(samples); }
+	private:
+		// children are added last to first
+		void Push() { }
 
-		template<typename H> AnimationParallel(H& item)
+		template<typename H, typename... T> void Push(H& item, T&... rest)
 		{
+			Push(rest...);
 			Animations.push_back(&item);
 		}
 
-		template<typename H, typename... T> AnimationParallel(H& item, T&... rest) :
-			AnimationParallel(rest...)
+		template<typename H, typename... T> void Push(H* item, T*... rest)
 		{
-			Animations.push_back(&item);
+			Push(rest...);
+			Animations.push_back(item);
+		}
+
+	public:
+		AnimationParallel() { }
+
+		// Room for capacity children, taken from arena if it is not nullptr
+		AnimationParallel(AnimationArena* arena, std::size_t capacity) : Animations(ArenaAllocator<IAnimation<NumericType>*>(arena))
+		{
+			Animations.reserve(capacity);
 		}
 
-		template<typename H> AnimationParallel(H* item)
+		template<typename H, typename... T> AnimationParallel(H& item, T&... rest)
 		{
-			Animations.push_back(item);
+			Animations.reserve(1 + sizeof...(T));
+			Push(item, rest...);
 		}
 
-		template<typename H, typename... T> AnimationParallel(H* item, T*... rest) :
-			AnimationParallel(rest...)
+		template<typename H, typename... T> AnimationParallel(H* item, T*... rest)
 		{
-			Animations.push_back(item);
+			Animations.reserve(1 + sizeof...(T));
+			Push(item, rest...);
 		}
 
 		void Add(IAnimation<NumericType>& item)
@@ -156,43 +1261,283 @@ namespace AnimateAnything
 			Animations.push_back(item);
 		}
 
+		NumericType NextActivity(NumericType t) override
+		{
+			NumericType next = this->Never();
+			for (auto animation : Animations)
+			{
+				NumericType child = animation->NextActivity(t);
+				if (child < next) next = child;
+				if (!(t < next)) break; // cannot be earlier than t
+			}
+			return next;
+		}
+
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override { for (auto animation : Animations) visit(*animation); }
+
 		~AnimationParallel() { }
 	};
 
-	// TODO loop
+	// Moments to play as a batch, fill T and T0 and play them through any animation, the working memory is kept between plays.
+	// Nodes finish the whole batch before their children see it, so side effects are grouped by node rather than by sample.
+	template<typename NumericType> class TimeBatch
+	{
+	private:
+		std::vector<std::size_t> index;
+		BatchScratch<NumericType> scratch;
+
+	public:
+		std::vector<NumericType> T;
+		std::vector<NumericType> T0;
+
+		TimeBatch() { }
+		TimeBatch(std::size_t count) : T(count), T0(count) { }
+
+		// samples are passed down in tiles of this size so the working memory stays in cache
+		std::size_t TileSize = 256;
+
+		// Play count moments from the given arrays
+		void Play(IAnimation<NumericType>& animation, const NumericType* t, const NumericType* t0, std::size_t count)
+		{
+			while (index.size() < count) index.push_back(index.size());
+			for (std::size_t first = 0; first < count; first += TileSize)
+			{
+				std::size_t tile = count - first < TileSize ? count - first : TileSize;
+				animation.PlayBatch(TimeSamples<NumericType>{ t + first, t0 + first, index.data() + first, tile, &scratch });
+			}
+		}
+
+		// Play the moments in T and T0
+		void Play(IAnimation<NumericType>& animation)
+		{
+			Play(animation, T.data(), T0.data(), T.size() < T0.size() ? T.size() : T0.size());
+		}
+	};
+
+	// One shared animation played for many instances, each with its own start and speed.
+	// The graph is not copied, every Play evaluates all instances as one batch and actions get the instance index.
+	template<typename NumericType> class AnimationInstances
+	{
+	private:
+		TimeBatch<NumericType> batch;
+
+	public:
+		std::vector<NumericType> Start; // global time at which each instance is at local time 0
+		std::vector<NumericType> Speed; // local time units per global time unit
+
+		// Add an instance and return its index
+		std::size_t Add(NumericType start, NumericType speed = 1)
+		{
+			Start.push_back(start);
+			Speed.push_back(speed);
+			return Start.size() - 1;
+		}
+
+		std::size_t Count() const { return Start.size(); }
+
+		// Play all instances at global moment t, previous global moment t0
+		void Play(IAnimation<NumericType>& animation, NumericType t, NumericType t0)
+		{
+			std::size_t count = Start.size();
+			batch.T.resize(count);
+			batch.T0.resize(count);
+			NumericType* local = batch.T.data();
+			NumericType* local0 = batch.T0.data();
+			const NumericType* start = Start.data();
+			const NumericType* speed = Speed.data();
+			for (std::size_t i = 0; i < count; i++)
+			{
+				local[i] = (t - start[i]) * speed[i];
+				local0[i] = (t0 - start[i]) * speed[i];
+			}
+			batch.Play(animation);
+		}
+	};
+
+	// Cycle arithmetic of AnimationLoop, Play calls child(local, local0) once per stretch of cycle that (t0, t) covers.
+	// Shared with players that loop without a node.
+	template<typename NumericType> struct LoopCycles
+	{
+		NumericType Period;
+		std::size_t Count; // number of cycles, 0 is infinite
+		bool PingPong;
+
+		static NumericType FloorDiv(NumericType a, NumericType b, std::true_type) { return a / b; }
+		static NumericType FloorDiv(NumericType a, NumericType b, std::false_type) { return std::floor(a / b); }
+		static bool IsOdd(NumericType cycle, std::true_type) { return cycle % 2 != 0; }
+		static bool IsOdd(NumericType cycle, std::false_type) { return std::fmod(cycle, NumericType(2)) != 0; }
+
+		// closest values below and above, used so the boundary of a new cycle is crossed as well
+		static NumericType Below(NumericType value, std::true_type) { return value - 1; }
+		static NumericType Below(NumericType value, std::false_type) { return std::nextafter(value, -std::numeric_limits<NumericType>::infinity()); }
+		static NumericType Above(NumericType value, std::true_type) { return value + 1; }
+		static NumericType Above(NumericType value, std::false_type) { return std::nextafter(value, std::numeric_limits<NumericType>::infinity()); }
+
+		using IsIntegral = std::is_integral<NumericType>;
+
+		// cycle of t, times before the first or after the last cycle belong to it
+		NumericType Cycle(NumericType t) const
+		{
+			if (t < 0) return 0;
+			NumericType cycle = FloorDiv(t, Period, IsIntegral());
+			NumericType last = NumericType(Count - 1);
+			if (Count && last < cycle) return last;
+			// rounding of the division can be off by one cycle
+			NumericType phase = t - cycle*Period;
+			if (Period <= phase && (!Count || cycle < last)) cycle = cycle + 1;
+			else if (phase < 0 && 0 < cycle) cycle = cycle - 1;
+			return cycle;
+		}
+
+		bool Reversed(NumericType cycle) const { return PingPong && IsOdd(cycle, IsIntegral()); }
+
+		NumericType Local(NumericType t, NumericType cycle) const
+		{
+			NumericType phase = t - cycle*Period;
+			return Reversed(cycle) ? Period - phase : phase;
+		}
+
+		// local time where the cycle is left
+		NumericType Exit(NumericType cycle, bool forward) const
+		{
+			return forward == Reversed(cycle) ? 0 : Period;
+		}
+
+		// local time the new cycle is entered from, just outside when the previous cycle left from the other end
+		NumericType Entry(NumericType cycle, bool forward) const
+		{
+			NumericType entry = forward == Reversed(cycle) ? Period : 0;
+			if (PingPong) return entry;
+			return forward ? Below(entry, IsIntegral()) : Above(entry, IsIntegral());
+		}
+
+		template<typename Child> void Play(NumericType t, NumericType t0, Child child) const
+		{
+			NumericType cycle = Cycle(t), cycle0 = Cycle(t0);
+			NumericType local = Local(t, cycle), local0 = Local(t0, cycle0);
+			if (cycle == cycle0)
+			{
+				child(local, local0);
+				return;
+			}
+			bool forward = cycle0 < cycle;
+			child(Exit(cycle0, forward), local0);
+			if (forward ? cycle0 + 1 < cycle : cycle + 1 < cycle0)
+			{
+				if (forward) child(Period, Below(0, IsIntegral()));
+				else child(0, Above(Period, IsIntegral()));
+			}
+			child(local, Entry(cycle, forward));
+		}
+	};
+
+	// Repeat a child every Period, Count times or forever if Count is 0, PingPong plays every other cycle backward.
+	// The child sees local time in [0, Period], before the first and after the last cycle local time continues linearly.
+	// When (t0, t) wraps, the child is played to the end of the old cycle and from the start of the new one, so events
+	// on the way fire in order. Cycles skipped entirely by a jump are played as a single sweep, not one by one.
+	template<typename NumericType> class AnimationLoop : public IAnimation<NumericType>
+	{
+	public:
+		NumericType Period;
+		std::size_t Count; // number of cycles, 0 is infinite
+		bool PingPong;
+		IAnimation<NumericType>& Animation;
+
+		void Play(NumericType t, NumericType t0) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(1);
+			if (!(0 < Period))
+			{
+				Animation.Play(t, t0);
+				return;
+			}
+			LoopCycles<NumericType>{ Period, Count, PingPong }.Play(t, t0, [this](NumericType local, NumericType local0) { Animation.Play(local, local0); });
+		}
+
+		NumericType NextActivity(NumericType t) override
+		{
+			if (!(0 < Period)) return Animation.NextActivity(t);
+			if (Animation.NextActivity(this->Earliest()) == this->Never()) return this->Never();
+			if (PingPong) return t;
+			LoopCycles<NumericType> cycles{ Period, Count, PingPong };
+			NumericType cycle = cycles.Cycle(t), local = cycles.Local(t, cycle);
+			NumericType next = Animation.NextActivity(local);
+			// the last cycle continues, other cycles are left at the next wrap
+			if (Count && cycle == NumericType(Count - 1)) return next == this->Never() ? next : t + (next - local);
+			if (next < Period) return t + (next - local);
+			return (cycle + 1)*Period;
+		}
+
+		AnimationLoop(NumericType period, std::size_t count, bool pingPong, IAnimation<NumericType>& action) : Period(period), Count(count), PingPong(pingPong), Animation(action) { }
+		AnimationLoop(NumericType period, std::size_t count, bool pingPong, IAnimation<NumericType>* action) : Period(period), Count(count), PingPong(pingPong), Animation(*action) { }
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override { visit(Animation); }
+		~AnimationLoop() { }
+	};
+
+	// How a Container gets memory for its nodes
+	enum class ContainerStorage
+	{
+		Heap, // every node is allocated with new
+		Arena, // nodes are placed contiguously in build order in an AnimationArena
+	};
+
+	// Memory usage of a Container
+	struct ContainerStats
+	{
+		std::size_t Nodes; // number of nodes built
+		std::size_t BytesUsed; // bytes taken by nodes, including arena bookkeeping
+		std::size_t BytesReserved; // bytes requested from the system
+		std::size_t Allocations; // number of live system allocations
+	};
 
 	// Container class builds animations, stores animations and manages memory so that you don't have to
 	template<typename NumericType> class Container
 	{
 	private:
 
-		// a vector containing all the animations in this container
+		// a vector containing all the animations in this container, only used with heap storage
 		std::vector<IAnimation<NumericType>*> ownedAnimations;
 
+		// memory for the nodes with arena storage
+		ContainerStorage storage;
+		AnimationArena arena;
+		std::size_t heapBytes = 0;
+
 		// make an animation node and convert it to stuff
-		template<typename Type, typename ...Args> Type* MakeNode(Args... args)
+		template<typename Type, typename ...Args> Type* MakeNode(Args&&... args)
 		{
-			Type* node = new Type(args...);
+			if (storage == ContainerStorage::Arena)
+			{
+				return arena.Create<Type>(std::forward<Args>(args)...);
+			}
+			Type* node = new Type(std::forward<Args>(args)...);
 			ownedAnimations.push_back(node);
+			heapBytes += sizeof(Type);
 			return node;
 		}
 
 		// Append  - general case
-		template<typename H, typename ...T> void Append(AnimationParallel<NumericType>* target, H first, T... rest)
+		template<typename H, typename ...T> void Append(AnimationParallel<NumericType>* target, H&& first, T&&... rest)
 		{
-			target->Add(Parallel(first));
-			Append(target, rest...);
+			target->Add(Parallel(std::forward<H>(first)));
+			Append(target, std::forward<T>(rest)...);
 		}
 
 		// Append - stop condition
-		template<typename H, typename ...T> void Append(AnimationParallel<NumericType>* target, H first)
-		{
-			target->Add(Parallel(first));
-			// no more recursive call
-		}
+		void Append(AnimationParallel<NumericType>* target) { }
 
 	public:
+
+		Container(ContainerStorage storage = ContainerStorage::Heap, std::size_t arenaBlockSize = 64 * 1024) : storage(storage), arena(arenaBlockSize) { }
+		Container(const Container&) = delete;
+		Container& operator=(const Container&) = delete;
 		
+		// Make a node of any type, owned by the container like the nodes made by the builders
+		template<typename Type, typename ...Args> Type* Make(Args&&... args)
+		{
+			return MakeNode<Type>(std::forward<Args>(args)...);
+		}
+
 		// Parallel with 1 parameter, degenrate case, only one IAnimation node, return node
 		IAnimation<NumericType>* Parallel(IAnimation<NumericType>* node)
 		{
@@ -200,65 +1545,146 @@ namespace AnimateAnything
 		}
 
 		// Parallel with 1 parameter, degenerate case, only one lambda
-		IAnimation<NumericType>* Parallel(std::function<void(NumericType)> action)
+		IAnimation<NumericType>* Parallel(InlineFunction<void(NumericType)> action)
 		{
-			return MakeNode<AnimationActionTime<NumericType>>(action);
+			return MakeNode<AnimationActionTime<NumericType>>(std::move(action));
 		}
 
 		// Parallel with 1 parameter, degenerate case, only one lambda without param
-		IAnimation<NumericType>* Parallel(std::function<void(void)> action)
+		IAnimation<NumericType>* Parallel(InlineFunction<void(void)> action)
+		{
+			return MakeNode<AnimationActionVoid<NumericType>>(std::move(action));
+		}
+
+		// Parallel with 1 parameter, degenerate case, only one lambda for batches
+		IAnimation<NumericType>* Parallel(InlineFunction<void(const NumericType*, const std::size_t*, std::size_t)> action)
+		{
+			return MakeNode<AnimationActionBatch<NumericType>>(std::move(action));
+		}
+
+		// Parallel with 1 parameter, degenerate case, only one lambda with instance index and time
+		IAnimation<NumericType>* Parallel(InlineFunction<void(std::size_t, NumericType)> action)
 		{
-			return MakeNode<AnimationActionVoid<NumericType>>(action);
+			return MakeNode<AnimationActionInstance<NumericType>>(std::move(action));
 		}
 
-		// Parallel with 2 or more prameters
-		template<typename H1, typename H2, typename ...Tail> IAnimation<NumericType>* Parallel(H1 first, H2 second, Tail... rest)
+		// Parallel with 2 or more prameters, the children are stored in the arena with arena storage
+		template<typename H1, typename H2, typename ...Tail> IAnimation<NumericType>* Parallel(H1&& first, H2&& second, Tail&&... rest)
 		{
-			auto node = MakeNode<AnimationParallel<NumericType>>();
-			Append(node, first, second, rest...);
+			auto node = MakeNode<AnimationParallel<NumericType>>(storage == ContainerStorage::Arena ? &arena : nullptr, 2 + sizeof...(Tail));
+			Append(node, std::forward<H1>(first), std::forward<H2>(second), std::forward<Tail>(rest)...);
 			return node;
 		}
 
 		// Animation between 2 points in time
-		template<typename ...Args> IAnimation<NumericType>* Between(NumericType start, NumericType finish, Args... args)
+		template<typename ...Args> AnimationBetween<NumericType>* Between(NumericType start, NumericType finish, Args&&... args)
 		{
-			return MakeNode<AnimationBetween<NumericType>>(start, finish, Parallel(args...));
+			return MakeNode<AnimationBetween<NumericType>>(start, finish, Parallel(std::forward<Args>(args)...));
 		}
 
 		// Animation before a specific point in time
-		template<typename ...Args> IAnimation<NumericType>* Before(NumericType moment, NumericType finish, Args... args)
+		template<typename ...Args> AnimationBefore<NumericType>* Before(NumericType moment, NumericType finish, Args&&... args)
 		{
-			return MakeNode<AnimationBefore<NumericType>>(moment, Parallel(args...));
+			return MakeNode<AnimationBefore<NumericType>>(moment, Parallel(std::forward<Args>(args)...));
 		}
 
 		// Animation before a specific point in time
-		template<typename ...Args> IAnimation<NumericType>* After(NumericType moment, NumericType finish, Args... args)
+		template<typename ...Args> AnimationAfter<NumericType>* After(NumericType moment, NumericType finish, Args&&... args)
 		{
-			return MakeNode<AnimationAfter<NumericType>>(moment, Parallel(args...));
+			return MakeNode<AnimationAfter<NumericType>>(moment, Parallel(std::forward<Args>(args)...));
 		}
 
 		// Animation before a specific point in time
-		template<typename ...Args> IAnimation<NumericType>* Event(NumericType moment, NumericType finish, Args... args)
+		template<typename ...Args> IAnimation<NumericType>* Event(NumericType moment, NumericType finish, Args&&... args)
 		{
-			return MakeNode<AnimationEvent<NumericType>>(moment, Parallel(args...));
+			return MakeNode<AnimationEvent<NumericType>>(moment, Parallel(std::forward<Args>(args)...));
 		}
 
 		// Stretch
-		template<typename ...Args> IAnimation<NumericType>* Stretch(NumericType amount, NumericType finish, Args... args)
+		template<typename ...Args> IAnimation<NumericType>* Stretch(NumericType amount, NumericType finish, Args&&... args)
 		{
-			return MakeNode<AnimationStretch<NumericType>>(amount, Parallel(args...));
+			return MakeNode<AnimationStretch<NumericType>>(amount, Parallel(std::forward<Args>(args)...));
+		}
+
+		// Stretch by numerator / denominator, exact for integral time
+		template<typename ...Args> IAnimation<NumericType>* StretchRatio(NumericType numerator, NumericType denominator, Args&&... args)
+		{
+			return MakeNode<AnimationStretchRatio<NumericType>>(numerator, denominator, Parallel(std::forward<Args>(args)...));
 		}
 
 		// Skip part of animation
-		template<typename ...Args> IAnimation<NumericType>* Seek(NumericType amount, NumericType finish, Args... args)
+		template<typename ...Args> IAnimation<NumericType>* Seek(NumericType amount, NumericType finish, Args&&... args)
 		{
-			return MakeNode<AnimationSeek<NumericType>>(amount, Parallel(args...));
+			return MakeNode<AnimationSeek<NumericType>>(amount, Parallel(std::forward<Args>(args)...));
 		}
 
 		// Custom time transform for an animation
-		template<typename ...Args> IAnimation<NumericType>* TimeTransform(std::function<NumericType(NumericType)> transform, NumericType finish, Args... args)
+		template<typename ...Args> IAnimation<NumericType>* TimeTransform(InlineFunction<NumericType(NumericType)> transform, NumericType finish, Args&&... args)
+		{
+			return MakeNode<AnimationTimeTransform<NumericType>>(std::move(transform), Parallel(std::forward<Args>(args)...));
+		}
+
+		// Repeat an animation every period, count times or forever if count is 0
+		template<typename ...Args> IAnimation<NumericType>* Loop(NumericType period, std::size_t count, Args&&... args)
+		{
+			return MakeNode<AnimationLoop<NumericType>>(period, count, false, Parallel(std::forward<Args>(args)...));
+		}
+
+		// Repeat an animation every period, every other cycle plays backward
+		template<typename ...Args> IAnimation<NumericType>* PingPong(NumericType period, std::size_t count, Args&&... args)
+		{
+			return MakeNode<AnimationLoop<NumericType>>(period, count, true, Parallel(std::forward<Args>(args)...));
+		}
+
+		// Ease an animation over duration with one of the easing curves
+		template<typename Curve, typename ...Args> IAnimation<NumericType>* Ease(NumericType duration, Args&&... args)
+		{
+			return MakeNode<AnimationEase<NumericType, Curve>>(duration, Curve(), Parallel(std::forward<Args>(args)...));
+		}
+
+		// Ease an animation over duration with a curve that has parameters, like EaseCubicBezier
+		template<typename Curve, typename ...Args> IAnimation<NumericType>* Ease(Curve curve, NumericType duration, Args&&... args)
+		{
+			return MakeNode<AnimationEase<NumericType, Curve>>(duration, curve, Parallel(std::forward<Args>(args)...));
+		}
+
+		// Custom time transform baked into a table over [from, to]
+		template<typename ...Args> IAnimation<NumericType>* TimeTable(std::function<NumericType(NumericType)> transform, NumericType from, NumericType to, std::size_t resolution, double maxError, Args&&... args)
+		{
+			return MakeNode<AnimationTimeTable<NumericType>>(transform, from, to, resolution, maxError, Parallel(std::forward<Args>(args)...));
+		}
+
+		// Destroy all nodes so the container can be reused, arena memory is kept for the next build
+		void Reset()
+		{
+			for(auto node : ownedAnimations)
+			{
+				delete node;
+			}
+			ownedAnimations.clear();
+			heapBytes = 0;
+			arena.Reset();
+		}
+
+		// Memory usage statistics
+		ContainerStats Stats() const
 		{
-			return MakeNode<AnimationTimeTransform<NumericType>>(transform, Parallel(args...));
+			ContainerStats stats;
+			if (storage == ContainerStorage::Arena)
+			{
+				stats.Nodes = arena.ObjectCount();
+				stats.BytesUsed = arena.BytesUsed();
+				stats.BytesReserved = arena.BytesReserved();
+				stats.Allocations = arena.BlockCount();
+			}
+			else
+			{
+				stats.Nodes = ownedAnimations.size();
+				stats.BytesUsed = heapBytes;
+				stats.BytesReserved = heapBytes + ownedAnimations.capacity() * sizeof(IAnimation<NumericType>*);
+				stats.Allocations = ownedAnimations.size() + (ownedAnimations.capacity() ? 1 : 0);
+			}
+			return stats;
 		}
 
 		~Container()
@@ -0,0 +1,229 @@
+// AnimatAnything in C++
+// baking, a subtree that only depends on time is sampled once into quantized channels and played back by lookup
+
+#pragma once
+
+#include "AnimateAnything.h"
+#include "AnimationChannels.h"
+#include "AnimationTracks.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace AnimateAnything
+{
+	// Channel values sampled over [Start, Finish], stored as 16 bit codes with an offset and scale per channel.
+	// Every sample is kept at a fixed Step, or the keys are in Times when the samples were reduced or integral time
+	// does not divide into even steps.
+	template<typename NumericType, typename ValueType = float> class BakedChannels
+	{
+	private:
+		using Real = typename std::conditional<std::is_floating_point<NumericType>::value, NumericType, double>::type;
+
+	public:
+		NumericType Start = 0;
+		NumericType Finish = 0;
+		NumericType Step = 0;
+		std::size_t Channels = 0;
+		std::vector<NumericType> Times; // key times when reduced, empty when samples are Step apart
+		std::vector<std::uint16_t> Codes; // Channels codes per key
+		std::vector<ValueType> Offset; // value of code 0, per channel
+		std::vector<ValueType> Scale; // value of one code step, per channel
+
+		std::size_t KeyCount() const { return Channels ? Codes.size() / Channels : 0; }
+		std::size_t Bytes() const { return Codes.size() * sizeof(std::uint16_t) + Times.size() * sizeof(NumericType) + (Offset.size() + Scale.size()) * sizeof(ValueType); }
+
+		// Values at t into out, a fixed step is an index computation, reduced keys use the cursor
+		void Sample(NumericType t, ValueType* out, TrackCursor<NumericType>& cursor) const
+		{
+			std::size_t keys = KeyCount();
+			if (keys == 0) return;
+			std::size_t key = 0;
+			ValueType u = 0;
+			if (!Times.empty())
+			{
+				key = cursor.Find(Times, t, u);
+			}
+			else if (keys > 1)
+			{
+				Real position = Real(t - Start) / Real(Step);
+				if (position > 0)
+				{
+					key = std::size_t(position);
+					if (key >= keys - 1) key = keys - 2;
+					u = ValueType(position - Real(key));
+					if (u > 1) u = 1;
+				}
+			}
+			const std::uint16_t* a = &Codes[key * Channels];
+			const std::uint16_t* b = keys > 1 ? a + Channels : a;
+			const ValueType* offset = Offset.data();
+			const ValueType* scale = Scale.data();
+			for (std::size_t i = 0; i < Channels; i++)
+			{
+				ValueType code = ValueType(a[i]) + (ValueType(b[i]) - ValueType(a[i])) * u;
+				out[i] = offset[i] + scale[i] * code;
+			}
+		}
+	};
+
+	// Sample Count channels from First of buffer while playing animation at rate samples per time unit over [from, to],
+	// for integral time the rate is usually below 1.
+	// The buffer is cleared and resolved for every sample, so bake outside of a frame. With maxError above 0 the
+	// samples are reduced to keys, linear interpolation between keys stays within maxError of every sample.
+	// Quantization adds up to half a code step, 1 / 131070 of the range of a channel.
+	template<typename NumericType, typename ValueType> BakedChannels<NumericType, ValueType> BakeChannels(IAnimation<NumericType>& animation, ChannelBuffer<ValueType>& buffer,
+		std::size_t first, std::size_t count, NumericType from, NumericType to, double rate, ValueType maxError = 0)
+	{
+		BakedChannels<NumericType, ValueType> baked;
+		baked.Start = from;
+		baked.Finish = to;
+		baked.Channels = count;
+		std::size_t samples = 1;
+		if (from < to && 0 < rate) samples = std::size_t(std::ceil(double(to - from) * rate)) + 1;
+		baked.Step = samples > 1 ? NumericType((to - from) / NumericType(samples - 1)) : NumericType(0);
+		if (samples > 1 && !(0 < baked.Step)) samples = 1; // integral time too coarse for the rate
+		// integral steps are rounded down and the last one is longer, the samples are not Step apart
+		bool uneven = std::is_integral<NumericType>::value && samples > 1 && NumericType(baked.Step * NumericType(samples - 1)) != NumericType(to - from);
+
+		// sample
+		std::vector<ValueType> values(samples * count);
+		std::vector<NumericType> times(samples);
+		NumericType previous = from;
+		for (std::size_t s = 0; s < samples; s++)
+		{
+			NumericType t = s + 1 == samples ? to : NumericType(from + baked.Step * NumericType(s));
+			times[s] = t;
+			buffer.Clear();
+			animation.Play(t, previous);
+			buffer.Resolve();
+			for (std::size_t i = 0; i < count; i++) values[s * count + i] = buffer.Value(first + i);
+			previous = t;
+		}
+
+		// reduce, a key is kept where the line from the previous key would leave the error bound
+		std::vector<std::size_t> keys;
+		keys.push_back(0);
+		if (maxError > 0 && samples > 2)
+		{
+			std::size_t anchor = 0;
+			for (std::size_t end = 2; end < samples; end++)
+			{
+				bool fits = true;
+				for (std::size_t k = anchor + 1; k < end && fits; k++)
+				{
+					ValueType u = ValueType(double(times[k] - times[anchor]) / double(times[end] - times[anchor]));
+					for (std::size_t i = 0; i < count && fits; i++)
+					{
+						ValueType a = values[anchor * count + i], b = values[end * count + i];
+						fits = std::fabs(a + (b - a) * u - values[k * count + i]) <= maxError;
+					}
+				}
+				if (!fits)
+				{
+					anchor = end - 1;
+					keys.push_back(anchor);
+				}
+			}
+			if (samples > 1) keys.push_back(samples - 1);
+			for (auto key : keys) baked.Times.push_back(times[key]);
+		}
+		else
+		{
+			for (std::size_t s = 1; s < samples; s++) keys.push_back(s);
+			if (uneven) baked.Times = times;
+		}
+
+		// quantize
+		baked.Offset.assign(count, 0);
+		baked.Scale.assign(count, 0);
+		for (std::size_t i = 0; i < count; i++)
+		{
+			ValueType low = values[i], high = values[i];
+			for (auto key : keys)
+			{
+				ValueType value = values[key * count + i];
+				if (value < low) low = value;
+				if (high < value) high = value;
+			}
+			baked.Offset[i] = low;
+			baked.Scale[i] = (high - low) / ValueType(65535);
+		}
+		baked.Codes.resize(keys.size() * count);
+		for (std::size_t k = 0; k < keys.size(); k++)
+		{
+			for (std::size_t i = 0; i < count; i++)
+			{
+				ValueType scale = baked.Scale[i];
+				ValueType code = scale > 0 ? (values[keys[k] * count + i] - baked.Offset[i]) / scale : ValueType(0);
+				baked.Codes[k * count + i] = std::uint16_t(std::lround(code < 0 ? 0 : code > 65535 ? 65535 : code));
+			}
+		}
+		return baked;
+	}
+
+	// Plays a subtree that writes Count channels from First of Buffer, until Bake samples it. From then on the baked
+	// values are written instead with one lookup, the subtree is not played. Inside [Start, Finish] the baked node
+	// writes with Weight, outside it writes nothing. Weights and layers inside the subtree are baked into the values.
+	template<typename NumericType, typename ValueType = float> class AnimationBake : public IAnimation<NumericType>
+	{
+	private:
+		TrackCursor<NumericType> cursor;
+		std::vector<ValueType> output;
+		bool baked = false;
+
+	public:
+		ChannelBuffer<ValueType>& Buffer;
+		std::size_t First;
+		std::size_t Count;
+		ValueType Weight = 1;
+		IAnimation<NumericType>& Animation;
+		BakedChannels<NumericType, ValueType> Baked;
+
+		AnimationBake(ChannelBuffer<ValueType>& buffer, std::size_t first, std::size_t count, IAnimation<NumericType>& action) : output(count), Buffer(buffer), First(first), Count(count), Animation(action) { }
+		AnimationBake(ChannelBuffer<ValueType>& buffer, std::size_t first, std::size_t count, IAnimation<NumericType>* action) : output(count), Buffer(buffer), First(first), Count(count), Animation(*action) { }
+
+		// Sample the subtree over [from, to], see BakeChannels
+		void Bake(NumericType from, NumericType to, double rate, ValueType maxError = 0)
+		{
+			Baked = BakeChannels(Animation, Buffer, First, Count, from, to, rate, maxError);
+			Buffer.Clear();
+			baked = true;
+		}
+
+		// Play the subtree again
+		void Unbake()
+		{
+			Baked = BakedChannels<NumericType, ValueType>();
+			baked = false;
+		}
+
+		bool IsBaked() const { return baked; }
+
+		void Play(NumericType t, NumericType t0) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(1);
+			if (!baked)
+			{
+				Animation.Play(t, t0);
+				return;
+			}
+			if (t < Baked.Start || Baked.Finish < t) return;
+			Baked.Sample(t, output.data(), cursor);
+			Buffer.Write(First, output.data(), Count, Weight);
+		}
+
+		NumericType NextActivity(NumericType t) override
+		{
+			if (!baked) return Animation.NextActivity(t);
+			if (Baked.Finish < t) return this->Never();
+			return t < Baked.Start ? Baked.Start : t;
+		}
+
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override { visit(Animation); }
+		~AnimationBake() { }
+	};
+}
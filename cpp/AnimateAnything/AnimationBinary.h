@@ -0,0 +1,753 @@
+// AnimatAnything in C++
+// binary timelines, a graph is saved as flat arrays and played straight from a memory mapped file
+
+#pragma once
+
+#include "AnimateAnything.h"
+#include "AnimationThreads.h"
+#include "AnimationTimeline.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace AnimateAnything
+{
+	// Node kinds of the binary format
+	enum class BinaryKind : std::uint32_t { Parallel, After, Before, Between, Seek, Event, Stretch, Loop, Ease, Action };
+
+	// Easing curves of the binary format, the mode is in bits 8 and 9 of the flags
+	enum class BinaryCurve : std::uint32_t { Linear, Quad, Cubic, Expo, Elastic, Bounce };
+	enum class BinaryEaseMode : std::uint32_t { In, Out, InOut };
+
+	// Start of a binary timeline, the arrays follow at the given offsets. Values are stored in the byte order and
+	// NumericType of the machine that wrote them, a file is only loaded by a matching build.
+	struct BinaryHeader
+	{
+		char Magic[4]; // "AATL"
+		std::uint32_t Version;
+		std::uint32_t ByteOrder; // 0x01020304 as written
+		std::uint32_t NumericSize; // sizeof(NumericType)
+		std::uint32_t NumericKind; // 0 signed integer, 1 unsigned integer, 2 floating point
+		std::uint32_t Root;
+		std::uint32_t NodeCount;
+		std::uint32_t ChildCount;
+		std::uint32_t ActionCount;
+		std::uint32_t StringBytes;
+		std::uint64_t NodeOffset;
+		std::uint64_t ChildOffset;
+		std::uint64_t ActionOffset;
+		std::uint64_t StringOffset;
+	};
+
+	// One node, children are always stored before their parents so indices only point backward
+	template<typename NumericType> struct BinaryNode
+	{
+		static const std::uint32_t None = 0xffffffffu;
+		static const std::uint32_t PingPong = 1; // Loop
+		static const std::uint32_t ChangedOnly = 1; // After, Before, Between
+
+		BinaryKind Kind;
+		std::uint32_t Flags;
+		std::uint32_t Child; // child node, first entry in the child array for Parallel, action for Action
+		std::uint32_t Count; // children of Parallel, cycles of Loop, state slot of ChangedOnly ranges
+		std::uint32_t Enter; // range callbacks or None
+		std::uint32_t Exit;
+		NumericType A; // Start, Finish, Moment, Skip, Scale, Period or Duration
+		NumericType B; // Finish of Between
+	};
+
+	// A named action in the string table
+	struct BinaryAction
+	{
+		std::uint32_t Offset;
+		std::uint32_t Length;
+	};
+
+	// Actions and properties by name, graphs that are saved use the nodes made here instead of lambdas.
+	// Loading a timeline looks its action names up here, the registry must outlive the loaded timelines.
+	template<typename NumericType> class AnimationRegistry
+	{
+	private:
+		struct Entry
+		{
+			std::string Name;
+			std::unique_ptr<AnimationActionTime<NumericType>> Node;
+		};
+
+		std::vector<Entry> entries;
+		std::unordered_map<std::string, std::size_t> byName;
+		std::unordered_map<const IAnimation<NumericType>*, std::size_t> byNode;
+
+	public:
+
+		// Register an action with time, registering a name again replaces its action and keeps its node
+		IAnimation<NumericType>* Action(const std::string& name, std::function<void(NumericType)> action)
+		{
+			auto found = byName.find(name);
+			if (found != byName.end())
+			{
+				entries[found->second].Node->Action = action;
+				return entries[found->second].Node.get();
+			}
+			entries.push_back(Entry{ name, std::unique_ptr<AnimationActionTime<NumericType>>(new AnimationActionTime<NumericType>(action)) });
+			byName[name] = entries.size() - 1;
+			byNode[entries.back().Node.get()] = entries.size() - 1;
+			return entries.back().Node.get();
+		}
+
+		// Register an action without parameters
+		IAnimation<NumericType>* Action(const std::string& name, std::function<void(void)> action)
+		{
+			return Action(name, std::function<void(NumericType)>([action](NumericType) { action(); }));
+		}
+
+		// Register a property, playing it stores the local time in target
+		template<typename Type> IAnimation<NumericType>* Property(const std::string& name, Type* target)
+		{
+			return Action(name, std::function<void(NumericType)>([target](NumericType t) { *target = Type(t); }));
+		}
+
+		// Node of a name, nullptr if it is not registered
+		IAnimation<NumericType>* Find(const std::string& name) const
+		{
+			auto found = byName.find(name);
+			return found == byName.end() ? nullptr : entries[found->second].Node.get();
+		}
+
+		// Name of a node made by this registry, nullptr for other nodes
+		const std::string* NameOf(const IAnimation<NumericType>* node) const
+		{
+			auto found = byNode.find(node);
+			return found == byNode.end() ? nullptr : &entries[found->second].Name;
+		}
+
+		std::size_t Count() const { return entries.size(); }
+	};
+
+	// Saves a graph in the binary format. Supported are Parallel (and ParallelConcurrent, played in order), After,
+	// Before, Between with their options, Seek, Event, Stretch, Loop, Ease with the built-in curves and registry actions.
+	// Nodes are matched by their exact class, subclasses may play differently and are refused. Nodes shared by several
+	// parents are saved once.
+	template<typename NumericType> class BinaryWriter
+	{
+	private:
+		using Node = BinaryNode<NumericType>;
+
+		const AnimationRegistry<NumericType>& registry;
+		std::vector<Node> nodes;
+		std::vector<std::uint32_t> children;
+		std::vector<BinaryAction> actions;
+		std::string strings;
+		std::unordered_map<const IAnimation<NumericType>*, std::uint32_t> written;
+		std::unordered_map<std::string, std::uint32_t> actionIndex;
+		std::uint32_t changedOnly = 0;
+
+		bool Fail(const std::string& message)
+		{
+			if (Error.empty()) Error = message;
+			return false;
+		}
+
+		std::uint32_t Action(const std::string& name)
+		{
+			auto found = actionIndex.find(name);
+			if (found != actionIndex.end()) return found->second;
+			actions.push_back(BinaryAction{ std::uint32_t(strings.size()), std::uint32_t(name.size()) });
+			strings += name;
+			return actionIndex[name] = std::uint32_t(actions.size() - 1);
+		}
+
+		template<typename Curve> bool FindEase(IAnimation<NumericType>& animation, BinaryCurve curve, Node& node, IAnimation<NumericType>*& child)
+		{
+			std::uint32_t mode;
+			if (auto in = ExactNode<AnimationEase<NumericType, Curve>>(animation)) { node.A = in->Duration; child = &in->Animation; mode = std::uint32_t(BinaryEaseMode::In); }
+			else if (auto out = ExactNode<AnimationEase<NumericType, EaseOut<Curve>>>(animation)) { node.A = out->Duration; child = &out->Animation; mode = std::uint32_t(BinaryEaseMode::Out); }
+			else if (auto inOut = ExactNode<AnimationEase<NumericType, EaseInOut<Curve>>>(animation)) { node.A = inOut->Duration; child = &inOut->Animation; mode = std::uint32_t(BinaryEaseMode::InOut); }
+			else return false;
+			node.Kind = BinaryKind::Ease;
+			node.Flags = std::uint32_t(curve) | mode << 8;
+			return true;
+		}
+
+		// a concurrent parallel is written as a parallel, the reader plays its children in order
+		static AnimationParallel<NumericType>* FindParallel(IAnimation<NumericType>& animation)
+		{
+			if (auto concurrent = ExactNode<AnimationParallelConcurrent<NumericType>>(animation)) return concurrent;
+			return ExactNode<AnimationParallel<NumericType>>(animation);
+		}
+
+		// a node on the way to being written, its references are written first
+		struct Pending
+		{
+			IAnimation<NumericType>* Animation;
+			bool Described;
+			Node Fields;
+			IAnimation<NumericType>* Child; // node.Child once written
+			IAnimation<NumericType>* Enter;
+			IAnimation<NumericType>* Exit;
+			std::vector<IAnimation<NumericType>*> Items; // children of a parallel
+		};
+
+		std::vector<Pending> pending; // the graph is walked with this stack, deep graphs do not overflow the call stack
+		std::unordered_set<const IAnimation<NumericType>*> described; // pending nodes, meeting one again is a cycle
+
+		void Range(AnimationRange<NumericType>& range, Pending& item)
+		{
+			item.Enter = range.Enter;
+			item.Exit = range.Exit;
+			if (range.ChangedOnly)
+			{
+				item.Fields.Flags |= Node::ChangedOnly;
+				item.Fields.Count = changedOnly++;
+			}
+		}
+
+		// the fields of a node and the nodes it refers to
+		bool Describe(Pending& item)
+		{
+			IAnimation<NumericType>& animation = *item.Animation;
+			Node& node = item.Fields;
+			node = Node{ BinaryKind::Action, 0, Node::None, 0, Node::None, Node::None, NumericType(0), NumericType(0) };
+			if (auto name = registry.NameOf(&animation))
+			{
+				node.Child = Action(*name);
+			}
+			else if (auto parallel = FindParallel(animation))
+			{
+				node.Kind = BinaryKind::Parallel;
+				parallel->ForEachChild([&item](IAnimation<NumericType>& child) { item.Items.push_back(&child); });
+			}
+			else if (auto between = ExactNode<AnimationBetween<NumericType>>(animation))
+			{
+				node.Kind = BinaryKind::Between;
+				node.A = between->Start;
+				node.B = between->Finish;
+				item.Child = &between->Animation;
+				Range(*between, item);
+			}
+			else if (auto after = ExactNode<AnimationAfter<NumericType>>(animation))
+			{
+				node.Kind = BinaryKind::After;
+				node.A = after->Start;
+				item.Child = &after->Animation;
+				Range(*after, item);
+			}
+			else if (auto before = ExactNode<AnimationBefore<NumericType>>(animation))
+			{
+				node.Kind = BinaryKind::Before;
+				node.A = before->Finish;
+				item.Child = &before->Animation;
+				Range(*before, item);
+			}
+			else if (auto seek = ExactNode<AnimationSeek<NumericType>>(animation))
+			{
+				node.Kind = BinaryKind::Seek;
+				node.A = seek->Skip;
+				item.Child = &seek->Animation;
+			}
+			else if (auto event = ExactNode<AnimationEvent<NumericType>>(animation))
+			{
+				node.Kind = BinaryKind::Event;
+				node.A = event->Moment;
+				item.Child = &event->Animation;
+			}
+			else if (auto stretch = ExactNode<AnimationStretch<NumericType>>(animation))
+			{
+				node.Kind = BinaryKind::Stretch;
+				node.A = stretch->Scale;
+				item.Child = &stretch->Animation;
+			}
+			else if (auto loop = ExactNode<AnimationLoop<NumericType>>(animation))
+			{
+				if (loop->Count > 0xffffffffu) return Fail("loop count does not fit the binary format");
+				node.Kind = BinaryKind::Loop;
+				node.A = loop->Period;
+				node.Count = std::uint32_t(loop->Count);
+				node.Flags = loop->PingPong ? Node::PingPong : 0;
+				item.Child = &loop->Animation;
+			}
+			else if (!FindEase<EaseLinear>(animation, BinaryCurve::Linear, node, item.Child) &&
+				!FindEase<EaseQuad>(animation, BinaryCurve::Quad, node, item.Child) &&
+				!FindEase<EaseCubic>(animation, BinaryCurve::Cubic, node, item.Child) &&
+				!FindEase<EaseExpo>(animation, BinaryCurve::Expo, node, item.Child) &&
+				!FindEase<EaseElastic>(animation, BinaryCurve::Elastic, node, item.Child) &&
+				!FindEase<EaseBounce>(animation, BinaryCurve::Bounce, node, item.Child))
+			{
+				return Fail("node without a binary form, use registry actions instead of lambdas");
+			}
+			return true;
+		}
+
+		// write the children, then the node, index is the position of the node. References are written in the order
+		// enter, exit, child or the children of a parallel in order, so nodes get the same indices as a recursive walk.
+		bool Write(IAnimation<NumericType>& animation, std::uint32_t& index)
+		{
+			pending.clear();
+			described.clear();
+			pending.push_back(Pending{ &animation, false, Node(), nullptr, nullptr, nullptr, {} });
+			while (!pending.empty())
+			{
+				Pending& item = pending.back();
+				if (written.count(item.Animation))
+				{
+					pending.pop_back();
+					continue;
+				}
+				if (!item.Described)
+				{
+					if (!described.insert(item.Animation).second) return Fail("the graph has a cycle");
+					item.Described = true;
+					if (!Describe(item)) return false;
+					std::vector<IAnimation<NumericType>*> references(item.Items.rbegin(), item.Items.rend());
+					for (auto reference : { item.Child, item.Exit, item.Enter }) if (reference) references.push_back(reference);
+					for (auto reference : references) pending.push_back(Pending{ reference, false, Node(), nullptr, nullptr, nullptr, {} });
+					continue;
+				}
+				Node node = item.Fields;
+				if (item.Child) node.Child = written[item.Child];
+				if (item.Enter) node.Enter = written[item.Enter];
+				if (item.Exit) node.Exit = written[item.Exit];
+				if (node.Kind == BinaryKind::Parallel)
+				{
+					node.Child = std::uint32_t(children.size());
+					node.Count = std::uint32_t(item.Items.size());
+					for (auto child : item.Items) children.push_back(written[child]);
+				}
+				if (nodes.size() >= Node::None) return Fail("too many nodes");
+				written[item.Animation] = std::uint32_t(nodes.size());
+				nodes.push_back(node);
+				described.erase(item.Animation);
+				pending.pop_back();
+			}
+			index = written[&animation];
+			return true;
+		}
+
+		static std::size_t Align(std::size_t offset) { return (offset + 7) & ~std::size_t(7); }
+
+	public:
+		std::string Error; // why the last Write failed
+
+		BinaryWriter(const AnimationRegistry<NumericType>& registry) : registry(registry) { }
+
+		// Serialize the graph under root into out, false if a node has no binary form
+		bool Write(IAnimation<NumericType>& root, std::vector<char>& out)
+		{
+			nodes.clear();
+			children.clear();
+			actions.clear();
+			strings.clear();
+			written.clear();
+			actionIndex.clear();
+			changedOnly = 0;
+			Error.clear();
+			std::uint32_t rootIndex = 0;
+			if (!Write(root, rootIndex)) return false;
+
+			BinaryHeader header;
+			std::memcpy(header.Magic, "AATL", 4);
+			header.Version = 1;
+			header.ByteOrder = 0x01020304;
+			header.NumericSize = sizeof(NumericType);
+			header.NumericKind = std::is_floating_point<NumericType>::value ? 2 : (std::is_signed<NumericType>::value ? 0 : 1);
+			header.Root = rootIndex;
+			header.NodeCount = std::uint32_t(nodes.size());
+			header.ChildCount = std::uint32_t(children.size());
+			header.ActionCount = std::uint32_t(actions.size());
+			header.StringBytes = std::uint32_t(strings.size());
+			header.NodeOffset = Align(sizeof(BinaryHeader));
+			header.ChildOffset = Align(header.NodeOffset + nodes.size() * sizeof(Node));
+			header.ActionOffset = Align(header.ChildOffset + children.size() * sizeof(std::uint32_t));
+			header.StringOffset = header.ActionOffset + actions.size() * sizeof(BinaryAction);
+
+			out.assign(std::size_t(header.StringOffset + strings.size()), 0);
+			std::memcpy(out.data(), &header, sizeof(header));
+			if (!nodes.empty()) std::memcpy(out.data() + header.NodeOffset, nodes.data(), nodes.size() * sizeof(Node));
+			if (!children.empty()) std::memcpy(out.data() + header.ChildOffset, children.data(), children.size() * sizeof(std::uint32_t));
+			if (!actions.empty()) std::memcpy(out.data() + header.ActionOffset, actions.data(), actions.size() * sizeof(BinaryAction));
+			if (!strings.empty()) std::memcpy(out.data() + header.StringOffset, strings.data(), strings.size());
+			return true;
+		}
+
+		// Serialize the graph under root into a file
+		bool Save(IAnimation<NumericType>& root, const std::string& path)
+		{
+			std::vector<char> data;
+			if (!Write(root, data)) return false;
+			FILE* file = std::fopen(path.c_str(), "wb");
+			if (!file) return Fail("cannot open " + path);
+			bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+			ok = std::fclose(file) == 0 && ok;
+			return ok || Fail("cannot write " + path);
+		}
+	};
+
+	// Read only memory mapping of a whole file
+	class BinaryMapping
+	{
+	private:
+		const char* data = nullptr;
+		std::size_t size = 0;
+#ifdef _WIN32
+		HANDLE file = INVALID_HANDLE_VALUE;
+		HANDLE mapping = nullptr;
+#endif
+
+	public:
+		BinaryMapping() { }
+
+		BinaryMapping(const std::string& path)
+		{
+#ifdef _WIN32
+			file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE) return;
+			LARGE_INTEGER length;
+			if (!GetFileSizeEx(file, &length) || length.QuadPart == 0) return;
+			mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (!mapping) return;
+			data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			if (data) size = std::size_t(length.QuadPart);
+#else
+			int file = open(path.c_str(), O_RDONLY);
+			if (file < 0) return;
+			struct stat status;
+			if (fstat(file, &status) == 0 && status.st_size > 0)
+			{
+				void* mapped = mmap(nullptr, std::size_t(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+				if (mapped != MAP_FAILED)
+				{
+					data = static_cast<const char*>(mapped);
+					size = std::size_t(status.st_size);
+				}
+			}
+			close(file);
+#endif
+		}
+
+		BinaryMapping(const BinaryMapping&) = delete;
+		BinaryMapping& operator=(const BinaryMapping&) = delete;
+
+		~BinaryMapping()
+		{
+#ifdef _WIN32
+			if (data) UnmapViewOfFile(data);
+			if (mapping) CloseHandle(mapping);
+			if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+			if (data) munmap(const_cast<char*>(data), size);
+#endif
+		}
+
+		const char* Data() const { return data; }
+		std::size_t Size() const { return size; }
+	};
+
+	// Plays a binary timeline in place, from a file it maps or from memory the caller keeps alive.
+	// Loading checks the layout and looks the actions up in the registry, nodes are not constructed.
+	// An invalid timeline plays nothing, Error tells what is wrong with it.
+	template<typename NumericType> class AnimationBinary : public IAnimation<NumericType>
+	{
+	private:
+		using Node = BinaryNode<NumericType>;
+		using Real = typename std::conditional<std::is_floating_point<NumericType>::value, NumericType, double>::type;
+
+		struct RangeState
+		{
+			NumericType Last;
+			bool Played;
+		};
+
+		std::unique_ptr<BinaryMapping> mapping;
+		const Node* nodes = nullptr;
+		const std::uint32_t* children = nullptr;
+		std::uint32_t root = 0;
+		std::uint32_t nodeCount = 0;
+		std::vector<IAnimation<NumericType>*> actions;
+		std::vector<RangeState> states; // for ChangedOnly ranges
+
+		// a node to play with its times, the graph is played with a stack so deep graphs do not overflow the call stack
+		struct Frame
+		{
+			std::uint32_t Index;
+			NumericType T;
+			NumericType T0;
+		};
+
+		std::vector<Frame> stack;
+
+		bool Fail(const std::string& message)
+		{
+			Error = message;
+			nodes = nullptr;
+			return false;
+		}
+
+		// count items at offset are inside size, without sums that can wrap
+		static bool Fits(std::uint64_t offset, std::uint64_t count, std::size_t item, std::size_t size)
+		{
+			return offset <= size && count <= (size - offset) / item;
+		}
+
+		bool Load(const char* data, std::size_t size, const AnimationRegistry<NumericType>& registry)
+		{
+			BinaryHeader header;
+			if (!data || size < sizeof(header)) return Fail("no timeline");
+			std::memcpy(&header, data, sizeof(header));
+			if (std::memcmp(header.Magic, "AATL", 4) != 0) return Fail("not a timeline");
+			if (header.Version != 1) return Fail("unknown version");
+			std::uint32_t kind = std::is_floating_point<NumericType>::value ? 2 : (std::is_signed<NumericType>::value ? 0 : 1);
+			if (header.ByteOrder != 0x01020304 || header.NumericSize != sizeof(NumericType) || header.NumericKind != kind) return Fail("written for another NumericType or byte order");
+			if (reinterpret_cast<std::uintptr_t>(data) % alignof(Node) != 0 || header.NodeOffset % alignof(Node) != 0 || header.ChildOffset % alignof(std::uint32_t) != 0 || header.ActionOffset % alignof(BinaryAction) != 0) return Fail("misaligned");
+			if (!Fits(header.NodeOffset, header.NodeCount, sizeof(Node), size) ||
+				!Fits(header.ChildOffset, header.ChildCount, sizeof(std::uint32_t), size) ||
+				!Fits(header.ActionOffset, header.ActionCount, sizeof(BinaryAction), size) ||
+				!Fits(header.StringOffset, header.StringBytes, 1, size)) return Fail("truncated");
+			if (header.Root >= header.NodeCount) return Fail("bad root");
+
+			const Node* table = reinterpret_cast<const Node*>(data + header.NodeOffset);
+			const std::uint32_t* list = reinterpret_cast<const std::uint32_t*>(data + header.ChildOffset);
+			const BinaryAction* named = reinterpret_cast<const BinaryAction*>(data + header.ActionOffset);
+			const char* strings = data + header.StringOffset;
+
+			actions.assign(header.ActionCount, nullptr);
+			for (std::uint32_t i = 0; i < header.ActionCount; i++)
+			{
+				if (std::uint64_t(named[i].Offset) + named[i].Length > header.StringBytes) return Fail("bad action name");
+				std::string name(strings + named[i].Offset, named[i].Length);
+				actions[i] = registry.Find(name);
+				if (!actions[i]) return Fail("action " + name + " is not registered");
+			}
+
+			// every reference points to an earlier node, so playing always ends. The writer gives every ChangedOnly range
+			// its own slot, there are fewer slots than nodes.
+			std::uint32_t slots = 0;
+			for (std::uint32_t i = 0; i < header.NodeCount; i++)
+			{
+				const Node& node = table[i];
+				bool ok = true;
+				switch (node.Kind)
+				{
+				case BinaryKind::Parallel:
+					ok = std::uint64_t(node.Child) + node.Count <= header.ChildCount;
+					for (std::uint32_t c = 0; ok && c < node.Count; c++) ok = list[node.Child + c] < i;
+					break;
+				case BinaryKind::After:
+				case BinaryKind::Before:
+				case BinaryKind::Between:
+					ok = node.Child < i && (node.Enter == Node::None || node.Enter < i) && (node.Exit == Node::None || node.Exit < i);
+					if (node.Flags & Node::ChangedOnly)
+					{
+						ok = ok && node.Count < header.NodeCount;
+						if (ok) slots = std::max(slots, node.Count + 1);
+					}
+					break;
+				case BinaryKind::Seek:
+				case BinaryKind::Event:
+				case BinaryKind::Stretch:
+				case BinaryKind::Loop:
+					ok = node.Child < i;
+					break;
+				case BinaryKind::Ease:
+					ok = node.Child < i && (node.Flags & 0xff) <= std::uint32_t(BinaryCurve::Bounce) && (node.Flags >> 8) <= std::uint32_t(BinaryEaseMode::InOut);
+					break;
+				case BinaryKind::Action:
+					ok = node.Child < header.ActionCount;
+					break;
+				default:
+					ok = false;
+				}
+				if (!ok) return Fail("bad node " + std::to_string(i));
+			}
+			states.assign(slots, RangeState{ NumericType(0), false });
+			nodes = table;
+			children = list;
+			root = header.Root;
+			nodeCount = header.NodeCount;
+			Error.clear();
+			return true;
+		}
+
+		template<typename Curve> static Real Ease(std::uint32_t mode, Real x)
+		{
+			if (mode == std::uint32_t(BinaryEaseMode::Out)) return EaseOut<Curve>()(x);
+			if (mode == std::uint32_t(BinaryEaseMode::InOut)) return EaseInOut<Curve>()(x);
+			return Curve()(x);
+		}
+
+		static NumericType Ease(const Node& node, NumericType t)
+		{
+			Real x = Real(t) / Real(node.A);
+			x = x < 0 ? Real(0) : (x > 1 ? Real(1) : x);
+			std::uint32_t mode = node.Flags >> 8;
+			switch (BinaryCurve(node.Flags & 0xff))
+			{
+			case BinaryCurve::Linear: x = Ease<EaseLinear>(mode, x); break;
+			case BinaryCurve::Quad: x = Ease<EaseQuad>(mode, x); break;
+			case BinaryCurve::Cubic: x = Ease<EaseCubic>(mode, x); break;
+			case BinaryCurve::Expo: x = Ease<EaseExpo>(mode, x); break;
+			case BinaryCurve::Elastic: x = Ease<EaseElastic>(mode, x); break;
+			case BinaryCurve::Bounce: x = Ease<EaseBounce>(mode, x); break;
+			}
+			return NumericType(x * Real(node.A));
+		}
+
+		void Push(std::uint32_t index, NumericType t, NumericType t0) { stack.push_back(Frame{ index, t, t0 }); }
+
+		// the same as AnimationRange::PlayRange, what plays first is pushed last
+		void PushRange(const Node& node, bool inside, bool inside0, NumericType local, NumericType local0)
+		{
+			bool play = inside;
+			if (node.Flags & Node::ChangedOnly)
+			{
+				RangeState& state = states[node.Count];
+				if (!inside) state.Played = false;
+				else if (state.Played && state.Last == local) play = false;
+				else
+				{
+					state.Played = true;
+					state.Last = local;
+				}
+			}
+			if (play) Push(node.Child, local, local0);
+			if (node.Enter != Node::None && inside && !inside0) Push(node.Enter, local, local0);
+			if (node.Exit != Node::None && inside0 && !inside) Push(node.Exit, local, local0);
+		}
+
+		// play a node or push its children, the children of a node play before the nodes pushed earlier
+		void PlayNode(const Frame& frame)
+		{
+			const Node& node = nodes[frame.Index];
+			NumericType t = frame.T, t0 = frame.T0;
+			switch (node.Kind)
+			{
+			case BinaryKind::Parallel:
+				for (std::uint32_t i = node.Count; i > 0; i--) Push(children[node.Child + i - 1], t, t0);
+				break;
+			case BinaryKind::After:
+				PushRange(node, node.A <= t, node.A <= t0, t - node.A, t0 - node.A);
+				break;
+			case BinaryKind::Before:
+				PushRange(node, t < node.A, t0 < node.A, t - node.A, t0 - node.A);
+				break;
+			case BinaryKind::Between:
+				PushRange(node, node.A <= t && t < node.B, node.A <= t0 && t0 < node.B, t - node.A, t0 - node.A);
+				break;
+			case BinaryKind::Seek:
+				Push(node.Child, t + node.A, t0 + node.A);
+				break;
+			case BinaryKind::Event:
+				if ((node.A <= t && t0 < node.A) || (t <= node.A && node.A < t0)) Push(node.Child, t, t0);
+				break;
+			case BinaryKind::Stretch:
+				Push(node.Child, t*node.A, t0*node.A);
+				break;
+			case BinaryKind::Loop:
+				if (!(0 < node.A)) Push(node.Child, t, t0);
+				else
+				{
+					// the cycles are played in order, pushed in reverse
+					std::size_t first = stack.size();
+					LoopCycles<NumericType>{ node.A, node.Count, (node.Flags & Node::PingPong) != 0 }.Play(t, t0, [&](NumericType local, NumericType local0) { Push(node.Child, local, local0); });
+					std::reverse(stack.begin() + first, stack.end());
+				}
+				break;
+			case BinaryKind::Ease:
+				Push(node.Child, Ease(node, t), Ease(node, t0));
+				break;
+			case BinaryKind::Action:
+				actions[node.Child]->Play(t, t0);
+				break;
+			}
+		}
+
+	public:
+		std::string Error; // why loading failed, empty when the timeline is valid
+
+		// Map a file and play from the mapping
+		AnimationBinary(const std::string& path, const AnimationRegistry<NumericType>& registry) : mapping(new BinaryMapping(path))
+		{
+			if (!mapping->Data()) Fail("cannot map " + path);
+			else Load(mapping->Data(), mapping->Size(), registry);
+		}
+
+		// Play from memory the caller keeps alive and unchanged, it must be aligned for NumericType
+		AnimationBinary(const void* data, std::size_t size, const AnimationRegistry<NumericType>& registry)
+		{
+			Load(static_cast<const char*>(data), size, registry);
+		}
+
+		AnimationBinary(const AnimationBinary&) = delete;
+		AnimationBinary& operator=(const AnimationBinary&) = delete;
+
+		bool Valid() const { return nodes != nullptr; }
+		std::size_t NodeCount() const { return Valid() ? nodeCount : 0; }
+
+		void Play(NumericType t, NumericType t0) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(1);
+			if (!nodes) return;
+			// an action may play this timeline again, it only takes the frames it pushes
+			std::size_t base = stack.size();
+			Push(root, t, t0);
+			while (stack.size() > base)
+			{
+				Frame frame = stack.back();
+				stack.pop_back();
+				PlayNode(frame);
+			}
+		}
+
+		NumericType NextActivity(NumericType t) override { return Valid() ? t : this->Never(); }
+
+		// the registry actions the timeline plays
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override
+		{
+			for (auto action : actions) visit(*action);
+		}
+
+		// the change suppression slots of the ranges
+		void SaveState(std::vector<char>& state) const override
+		{
+			for (auto& slot : states)
+			{
+				SaveValue(state, slot.Last);
+				SaveValue(state, slot.Played);
+			}
+		}
+
+		const char* RestoreState(const char* state) override
+		{
+			for (auto& slot : states)
+			{
+				state = RestoreValue(state, slot.Last);
+				state = RestoreValue(state, slot.Played);
+			}
+			return state;
+		}
+
+		~AnimationBinary() { }
+	};
+}
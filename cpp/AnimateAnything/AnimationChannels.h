@@ -0,0 +1,192 @@
+// AnimatAnything in C++
+// channel output, leaves write weighted values into one buffer that blends and layers them once per frame
+
+#pragma once
+
+#include "AnimateAnything.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace AnimateAnything
+{
+	enum class ChannelMode { Blend, Additive };
+
+	// Output of a frame as contiguous channels. Writes are accumulated as they come, Resolve turns them into values:
+	// blended writes are averaged by weight and mixed with Base while their total weight is below 1, additive writes
+	// are added on top. Call Clear before playing a frame and Resolve after it, then read Values.
+	// Writes are not synchronized, play graphs that write here on one thread.
+	template<typename ValueType = float> class ChannelBuffer
+	{
+	private:
+		std::vector<ValueType> blend; // sum of value * weight
+		std::vector<ValueType> weight; // sum of weight
+		std::vector<ValueType> additive; // sum of value * weight of additive writes
+		std::vector<ValueType> output;
+		ValueType layerWeight = 1;
+		ChannelMode layerMode = ChannelMode::Blend;
+
+	public:
+		std::vector<ValueType> Base; // value of a channel nothing writes to, the rest pose
+
+		// Weight and mode applied to the writes of a layer, see AnimationChannelLayer
+		struct Layer
+		{
+			ValueType Weight;
+			ChannelMode Mode;
+		};
+
+		ChannelBuffer(std::size_t channels, ValueType rest = 0) :
+			blend(channels), weight(channels), additive(channels), output(channels, rest), Base(channels, rest) { }
+
+		std::size_t Count() const { return output.size(); }
+
+		// Forget the writes of the previous frame
+		void Clear()
+		{
+			std::fill(blend.begin(), blend.end(), ValueType(0));
+			std::fill(weight.begin(), weight.end(), ValueType(0));
+			std::fill(additive.begin(), additive.end(), ValueType(0));
+		}
+
+		// Write a channel, the weight is multiplied by the weight of the current layer
+		void Write(std::size_t channel, ValueType value, ValueType amount = 1)
+		{
+			amount *= layerWeight;
+			if (layerMode == ChannelMode::Additive)
+			{
+				additive[channel] += value * amount;
+				return;
+			}
+			blend[channel] += value * amount;
+			weight[channel] += amount;
+		}
+
+		// Write count consecutive channels from first
+		void Write(std::size_t first, const ValueType* values, std::size_t count, ValueType amount = 1)
+		{
+			amount *= layerWeight;
+			if (layerMode == ChannelMode::Additive)
+			{
+				ValueType* sum = additive.data() + first;
+				for (std::size_t i = 0; i < count; i++) sum[i] += values[i] * amount;
+				return;
+			}
+			ValueType* sum = blend.data() + first;
+			ValueType* total = weight.data() + first;
+			for (std::size_t i = 0; i < count; i++)
+			{
+				sum[i] += values[i] * amount;
+				total[i] += amount;
+			}
+		}
+
+		// Set the layer for the following writes, returns the previous one. Nested layers multiply their weights and
+		// everything under an additive layer is additive.
+		Layer PushLayer(ValueType amount, ChannelMode mode)
+		{
+			Layer previous{ layerWeight, layerMode };
+			layerWeight *= amount;
+			if (mode == ChannelMode::Additive) layerMode = mode;
+			return previous;
+		}
+
+		void PopLayer(Layer previous)
+		{
+			layerWeight = previous.Weight;
+			layerMode = previous.Mode;
+		}
+
+		// Compute the values of all channels, a plain loop over contiguous arrays so the compiler can vectorize it
+		void Resolve()
+		{
+			std::size_t count = output.size();
+			const ValueType* sum = blend.data();
+			const ValueType* total = weight.data();
+			const ValueType* add = additive.data();
+			const ValueType* rest = Base.data();
+			ValueType* out = output.data();
+			for (std::size_t i = 0; i < count; i++)
+			{
+				// weights above 1 normalize and below 1 leave the rest to the base, max(a, b) is written as
+				// (a + b + |a - b|) / 2 because compilers do not vectorize float comparisons that may trap
+				ValueType w = total[i];
+				ValueType scale = ValueType(2) / (w + 1 + std::fabs(w - 1));
+				ValueType remaining = (1 - w + std::fabs(1 - w)) / 2;
+				out[i] = sum[i] * scale + rest[i] * remaining + add[i];
+			}
+		}
+
+		const ValueType* Values() const { return output.data(); }
+		ValueType Value(std::size_t channel) const { return output[channel]; }
+	};
+
+	// Writes the local time as the value of a channel
+	template<typename NumericType, typename ValueType = float> class AnimationChannel : public IAnimation<NumericType>
+	{
+	public:
+		ChannelBuffer<ValueType>& Buffer;
+		std::size_t Channel;
+		ValueType Weight;
+		void Play(NumericType t, NumericType t0) override { ANIMATEANYTHING_PROFILE_PLAY(1); Buffer.Write(Channel, ValueType(t), Weight); }
+		AnimationChannel(ChannelBuffer<ValueType>& buffer, std::size_t channel, ValueType weight = 1) : Buffer(buffer), Channel(channel), Weight(weight) { }
+		~AnimationChannel() { }
+	};
+
+	// Plays a child that fills Count values at Source, like a track, then writes them to consecutive channels
+	template<typename NumericType, typename ValueType = float> class AnimationChannelSource : public IAnimation<NumericType>
+	{
+	public:
+		ChannelBuffer<ValueType>& Buffer;
+		std::size_t First;
+		std::size_t Count;
+		const ValueType* Source;
+		ValueType Weight;
+		IAnimation<NumericType>& Animation;
+		void Play(NumericType t, NumericType t0) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(1);
+			Animation.Play(t, t0);
+			Buffer.Write(First, Source, Count, Weight);
+		}
+		NumericType NextActivity(NumericType t) override { return Animation.NextActivity(t); }
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override { visit(Animation); }
+		AnimationChannelSource(ChannelBuffer<ValueType>& buffer, std::size_t first, std::size_t count, const ValueType* source, ValueType weight, IAnimation<NumericType>& action) :
+			Buffer(buffer), First(first), Count(count), Source(source), Weight(weight), Animation(action) { }
+		AnimationChannelSource(ChannelBuffer<ValueType>& buffer, std::size_t first, std::size_t count, const ValueType* source, ValueType weight, IAnimation<NumericType>* action) :
+			Buffer(buffer), First(first), Count(count), Source(source), Weight(weight), Animation(*action) { }
+		~AnimationChannelSource() { }
+	};
+
+	// Plays a child as a layer, its channel writes are weighted by Weight and blended or added depending on Mode.
+	// Two timelines driving the same channels can be crossfaded by playing both under layers.
+	template<typename NumericType, typename ValueType = float> class AnimationChannelLayer : public IAnimation<NumericType>
+	{
+	public:
+		ChannelBuffer<ValueType>& Buffer;
+		ValueType Weight;
+		ChannelMode Mode;
+		IAnimation<NumericType>& Animation;
+		void Play(NumericType t, NumericType t0) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(1);
+			auto previous = Buffer.PushLayer(Weight, Mode);
+			Animation.Play(t, t0);
+			Buffer.PopLayer(previous);
+		}
+		void PlayBatch(const TimeSamples<NumericType>& samples) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(samples.Count);
+			auto previous = Buffer.PushLayer(Weight, Mode);
+			Animation.PlayBatch(samples);
+			Buffer.PopLayer(previous);
+		}
+		NumericType NextActivity(NumericType t) override { return Animation.NextActivity(t); }
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override { visit(Animation); }
+		AnimationChannelLayer(ChannelBuffer<ValueType>& buffer, ValueType weight, ChannelMode mode, IAnimation<NumericType>& action) : Buffer(buffer), Weight(weight), Mode(mode), Animation(action) { }
+		AnimationChannelLayer(ChannelBuffer<ValueType>& buffer, ValueType weight, ChannelMode mode, IAnimation<NumericType>* action) : Buffer(buffer), Weight(weight), Mode(mode), Animation(*action) { }
+		~AnimationChannelLayer() { }
+	};
+}
@@ -0,0 +1,148 @@
+// AnimatAnything in C++
+// checkpointed seek, state is saved while playing forward so a seek replays from the nearest earlier checkpoint
+
+#pragma once
+
+#include "AnimateAnything.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace AnimateAnything
+{
+	// Plays a child and saves its state every Interval while time moves past the last checkpoint. Seek restores the
+	// nearest checkpoint before the target and replays from there, so its cost depends on Interval, not on where the
+	// target is. State is whatever the nodes save with SaveState plus the values and objects given to Track.
+	// Playing a span is assumed to give the same state every time, checkpoints are not updated when playing again.
+	template<typename NumericType> class AnimationCheckpoints : public IAnimation<NumericType>
+	{
+	private:
+		struct Checkpoint
+		{
+			NumericType Time;
+			std::size_t Offset; // in data
+		};
+
+		struct Tracked
+		{
+			std::function<void(std::vector<char>&)> Save;
+			std::function<const char*(const char*)> Restore;
+		};
+
+		std::vector<IAnimation<NumericType>*> nodes; // every node of the graph once
+		std::vector<Tracked> tracked;
+		std::vector<Checkpoint> checkpoints; // in time order, the first one is the state at Start
+		std::vector<char> data;
+
+		void Record(NumericType t)
+		{
+			checkpoints.push_back(Checkpoint{ t, data.size() });
+			for (auto node : nodes) node->SaveState(data);
+			for (auto& item : tracked) item.Save(data);
+		}
+
+		void Restore(const Checkpoint& checkpoint)
+		{
+			const char* state = data.data() + checkpoint.Offset;
+			for (auto node : nodes) state = node->RestoreState(state);
+			for (auto& item : tracked) state = item.Restore(state);
+		}
+
+		// the state before anything played is the first checkpoint
+		void Begin()
+		{
+			if (checkpoints.empty()) Record(Start);
+		}
+
+	public:
+		NumericType Interval;
+		NumericType Start; // time the graph is in its initial state
+		IAnimation<NumericType>& Animation;
+
+		AnimationCheckpoints(NumericType interval, NumericType start, IAnimation<NumericType>& action) : Interval(interval), Start(start), Animation(action) { Collect(); }
+		AnimationCheckpoints(NumericType interval, NumericType start, IAnimation<NumericType>* action) : Interval(interval), Start(start), Animation(*action) { Collect(); }
+
+		// Find the nodes of the graph again after it changed, the checkpoints are dropped
+		void Collect()
+		{
+			nodes.clear();
+			std::unordered_set<IAnimation<NumericType>*> seen;
+			std::function<void(IAnimation<NumericType>&)> walk = [&](IAnimation<NumericType>& node)
+			{
+				if (!seen.insert(&node).second) return;
+				nodes.push_back(&node);
+				node.ForEachChild(walk);
+			};
+			walk(Animation);
+			checkpoints.clear();
+			data.clear();
+		}
+
+		// Keep a variable in the checkpoints, for state that actions keep outside the graph. Track before the first play,
+		// tracking later drops the checkpoints and the current state becomes the initial one.
+		template<typename Type> void Track(Type& value)
+		{
+			Type* target = &value;
+			Track([target](std::vector<char>& state) { SaveValue(state, *target); }, [target](const char* state) { return RestoreValue(state, *target); });
+		}
+
+		// Keep an object in the checkpoints, restore reads what save appended and returns the end of it
+		void Track(std::function<void(std::vector<char>&)> save, std::function<const char*(const char*)> restore)
+		{
+			tracked.push_back(Tracked{ std::move(save), std::move(restore) });
+			checkpoints.clear();
+			data.clear();
+		}
+
+		void Play(NumericType t, NumericType t0) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(1);
+			Begin();
+			Animation.Play(t, t0);
+			if (0 < Interval && !(t < checkpoints.back().Time + Interval)) Record(t);
+		}
+
+		// Jump to t: restore the last checkpoint at or before t and play forward from it. With a step the span is
+		// replayed in steps of that length like frames, needed when actions count plays or loops skip cycles.
+		void Seek(NumericType t, NumericType step = 0)
+		{
+			Begin();
+			auto after = std::upper_bound(checkpoints.begin(), checkpoints.end(), t, [](NumericType time, const Checkpoint& checkpoint) { return time < checkpoint.Time; });
+			const Checkpoint& from = after == checkpoints.begin() ? checkpoints.front() : *(after - 1);
+			NumericType time = from.Time;
+			Restore(from);
+			if (0 < step)
+			{
+				while (time + step < t)
+				{
+					Play(time + step, time);
+					time = time + step;
+				}
+			}
+			Play(t, time);
+		}
+
+		// Record checkpoints up to finish ahead of time by playing in steps from the last one, the graph is left at finish
+		void Preroll(NumericType finish, NumericType step) { Seek(finish, step); }
+
+		// Drop all checkpoints but the initial state
+		void Clear()
+		{
+			if (checkpoints.size() < 2) return;
+			data.resize(checkpoints[1].Offset);
+			checkpoints.resize(1);
+		}
+
+		std::size_t Count() const { return checkpoints.size(); }
+		std::size_t Bytes() const { return data.size(); }
+
+		NumericType NextActivity(NumericType t) override { return Animation.NextActivity(t); }
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override { visit(Animation); }
+		~AnimationCheckpoints() { }
+	};
+}
@@ -0,0 +1,316 @@
+// AnimatAnything in C++
+// event queue, keeps the absolute moments of events sorted so a jump in time only visits the events it crosses
+
+#pragma once
+
+#include "AnimationTimeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace AnimateAnything
+{
+	// Fires the events crossed by (t0, t] in time order, or by [t, t0) in reverse time order when time goes backward.
+	// Events can be collected from a graph of AnimationEvent nodes or added with their absolute moment.
+	// Only events are played, leaves of a collected graph that are not under an event are ignored. Events under a loop
+	// fire in time order with the others: the cycles a Play crosses are expanded the way the loop plays them, cycles
+	// skipped by a jump as a single sweep. Events under another node the timeline keeps whole, an ease or a custom node,
+	// have no moment the queue can sort: such a subtree plays through its path on every Play that moves in time, after
+	// the sorted events.
+	template<typename NumericType> class AnimationEventQueue : public IAnimation<NumericType>
+	{
+	private:
+
+		static const std::size_t None = std::size_t(-1);
+
+		using Bound = long double;
+
+		struct Entry
+		{
+			NumericType Start; // lower bound of the absolute moment
+			NumericType Finish; // upper bound of the absolute moment
+			std::size_t Segment; // segment of the compiled graph, None for events added with a moment
+			IAnimation<NumericType>* Target;
+			std::size_t Order; // events at the same moment fire in the order they were added
+		};
+
+		// absolute time of a local time, Scale*t + Offset
+		struct Placement
+		{
+			Bound Scale;
+			Bound Offset;
+
+			Bound operator()(Bound t) const { return Scale*t + Offset; }
+
+			// the placement of t when the local time is scale*t + offset
+			Placement Then(Bound scale, Bound offset) const { return Placement{ Scale*scale, Scale*offset + Offset }; }
+		};
+
+		// an event or an opaque segment crossed by a Play, with the times it plays with
+		struct Firing
+		{
+			Bound Moment; // absolute moment, orders the events of loop cycles with the other events
+			std::size_t Order;
+			AnimationEventQueue* Queue; // the queue of a loop body for the events in its cycles
+			const Entry* Event; // nullptr for an opaque segment of Queue
+			std::size_t Segment;
+			NumericType T;
+			NumericType T0;
+		};
+
+		// a loop with events below it, its body has a queue of its own
+		struct Loop
+		{
+			std::size_t Segment;
+			const AnimationLoop<NumericType>* Node;
+			std::unique_ptr<AnimationEventQueue> Body;
+			Placement Absolute; // absolute time of the time the loop is played with
+			std::size_t Order;
+		};
+
+		std::unique_ptr<AnimationTimeline<NumericType>> graph;
+		std::vector<Entry> entries;
+		std::vector<Entry> open; // moments that could not be bounded, candidates for every range, kept apart so they do not slow the search
+		std::vector<Loop> loops;
+		std::vector<std::size_t> opaque; // segments of the graph with events the queue cannot see
+		std::vector<Firing> crossed;
+		NumericType width = 0; // largest Finish - Start of entries, bounds how far before a range a candidate can start
+		bool sorted = true;
+
+		static bool Earlier(const Firing& a, const Firing& b) { return a.Moment < b.Moment || (!(b.Moment < a.Moment) && a.Order < b.Order); }
+
+		void Sort()
+		{
+			auto start = [](const Entry& a, const Entry& b) { return a.Start < b.Start; };
+			std::stable_sort(entries.begin(), entries.end(), start);
+			std::stable_sort(open.begin(), open.end(), start);
+			sorted = true;
+		}
+
+		void Insert(Entry entry)
+		{
+			entry.Order = entries.size() + open.size() + loops.size();
+			if (std::numeric_limits<NumericType>::lowest() < entry.Start && entry.Finish < std::numeric_limits<NumericType>::max())
+			{
+				entries.push_back(entry);
+				width = std::max(width, entry.Finish - entry.Start);
+			}
+			else open.push_back(entry);
+			sorted = false;
+		}
+
+		// an event below a node the timeline plays whole
+		static bool HasEvent(IAnimation<NumericType>& node)
+		{
+			if (dynamic_cast<AnimationEvent<NumericType>*>(&node)) return true;
+			bool found = false;
+			node.ForEachChild([&found](IAnimation<NumericType>& child) { found = found || HasEvent(child); });
+			return found;
+		}
+
+		// a loop segment whose path only shifts and scales time, false for other segments
+		bool AddLoop(std::size_t index)
+		{
+			const TimelineSegment<NumericType>& segment = graph->Segments()[index];
+			auto loop = ExactNode<AnimationLoop<NumericType>>(*segment.Target);
+			if (!loop) return false;
+			Bound scale = 1, offset = 0;
+			const TimelineStep<NumericType>* step = graph->Steps().data() + segment.FirstStep;
+			for (std::size_t i = 0; i < segment.StepCount; i++)
+			{
+				Bound value = static_cast<Bound>(step[i].Value);
+				switch (step[i].Kind)
+				{
+				case TimelineStep<NumericType>::Subtract: offset -= value; break;
+				case TimelineStep<NumericType>::Add: offset += value; break;
+				case TimelineStep<NumericType>::Multiply: scale *= value; offset *= value; break;
+				default: break;
+				}
+			}
+			if (scale == 0 || !std::isfinite(scale) || !std::isfinite(offset)) return false;
+			Placement absolute{ 1 / scale, -offset / scale };
+			loops.push_back(Loop{ index, loop, std::unique_ptr<AnimationEventQueue>(new AnimationEventQueue(loop->Animation)), absolute, entries.size() + open.size() + loops.size() });
+			return true;
+		}
+
+		// the same test AnimationEvent does, segments of the graph replay their whole path instead
+		void Fire(const Entry& entry, NumericType t, NumericType t0)
+		{
+			if (entry.Segment != None)
+			{
+				graph->PlaySegment(entry.Segment, t, t0);
+			}
+			else if ((entry.Start <= t && t0 < entry.Start) || (t <= entry.Start && entry.Start < t0))
+			{
+				entry.Target->Play(t, t0);
+			}
+		}
+
+		static void Fire(const Firing& firing)
+		{
+			if (firing.Event) firing.Queue->Fire(*firing.Event, firing.T, firing.T0);
+			else firing.Queue->graph->PlaySegment(firing.Segment, firing.T, firing.T0);
+		}
+
+		// Append what (t0, t) crosses in ascending moments, placed in absolute time with place. Inside a loop body order
+		// is the order of the loop and the opaque segments are placed at t, at the top they play after the others.
+		void Collect(NumericType t, NumericType t0, const Placement& place, std::size_t order, std::vector<Firing>& out)
+		{
+			if (!(t < t0) && !(t0 < t)) return; // nothing is crossed
+			if (!sorted) Sort();
+			NumericType from = std::min(t, t0), to = std::max(t, t0);
+			std::size_t first = out.size();
+			for (auto& entry : open)
+			{
+				if (entry.Start <= to && !(entry.Finish < from)) out.push_back(Firing{ place(entry.Start), order == None ? entry.Order : order, this, &entry, None, t, t0 });
+			}
+			std::size_t merge = out.size();
+			auto begin = entries.begin();
+			if (std::numeric_limits<NumericType>::lowest() + width <= from)
+			{
+				begin = std::lower_bound(entries.begin(), entries.end(), from - width, [](const Entry& entry, NumericType value) { return entry.Start < value; });
+			}
+			auto end = std::upper_bound(begin, entries.end(), to, [](NumericType value, const Entry& entry) { return value < entry.Start; });
+			for (auto entry = begin; entry != end; ++entry)
+			{
+				if (!(entry->Finish < from)) out.push_back(Firing{ place(entry->Start), order == None ? entry->Order : order, this, &*entry, None, t, t0 });
+			}
+			// a reversed placement turns ascending local moments into descending absolute ones
+			if (place.Scale < 0)
+			{
+				std::reverse(out.begin() + first, out.begin() + merge);
+				std::reverse(out.begin() + merge, out.end());
+			}
+			if (first < merge && merge < out.size()) std::inplace_merge(out.begin() + first, out.begin() + merge, out.end(), Earlier);
+
+			std::size_t expanded = out.size();
+			for (auto& loop : loops) Expand(loop, t, t0, place, order, out);
+			if (order != None)
+			{
+				for (auto index : opaque) out.push_back(Firing{ place(t), order, this, nullptr, index, t, t0 });
+			}
+			if (expanded < out.size())
+			{
+				std::stable_sort(out.begin() + expanded, out.end(), Earlier);
+				std::inplace_merge(out.begin() + first, out.begin() + expanded, out.end(), Earlier);
+			}
+		}
+
+		// the events in the cycles (t0, t) crosses, each part of the loop play collected by the body with its cycle
+		void Expand(Loop& loop, NumericType t, NumericType t0, const Placement& place, std::size_t order, std::vector<Firing>& out)
+		{
+			const TimelineSegment<NumericType>& segment = graph->Segments()[loop.Segment];
+			if (t < segment.Start || segment.Finish < t) return;
+			const TimelineStep<NumericType>* step = graph->Steps().data() + segment.FirstStep;
+			for (std::size_t i = 0; i < segment.StepCount; i++)
+			{
+				if (!step[i].Apply(t, t0)) return;
+			}
+			const AnimationLoop<NumericType>& node = *loop.Node;
+			Placement absolute = place.Then(loop.Absolute.Scale, loop.Absolute.Offset);
+			order = order == None ? loop.Order : order;
+			if (!(0 < node.Period))
+			{
+				loop.Body->Collect(t, t0, absolute, order, out);
+				return;
+			}
+			LoopCycles<NumericType> cycles{ node.Period, node.Count, node.PingPong };
+			NumericType cycle = cycles.Cycle(t), cycle0 = cycles.Cycle(t0);
+			bool forward = cycle0 < cycle;
+			bool skipped = forward ? cycle0 + 1 < cycle : cycle + 1 < cycle0;
+			int part = 0;
+			cycles.Play(t, t0, [&](NumericType local, NumericType local0)
+			{
+				// the parts are the old cycle, the skipped ones as a sweep placed at the first of them, the new cycle
+				bool sweep = part == 1 && skipped;
+				NumericType at = part == 0 ? cycle0 : sweep ? (forward ? cycle0 + 1 : cycle0 - 1) : cycle;
+				bool reversed = !sweep && cycles.Reversed(at);
+				Bound start = static_cast<Bound>(at)*static_cast<Bound>(node.Period);
+				Placement inCycle = reversed ? absolute.Then(-1, start + static_cast<Bound>(node.Period)) : absolute.Then(1, start);
+				loop.Body->Collect(local, local0, inCycle, order, out);
+				part++;
+			});
+		}
+
+	public:
+
+		AnimationEventQueue() { }
+
+		// Collect the events under root, the graph must outlive the queue and should not change while it is used
+		AnimationEventQueue(IAnimation<NumericType>& root) : graph(new AnimationTimeline<NumericType>(root))
+		{
+			auto& segments = graph->Segments();
+			for (std::size_t i = 0; i < segments.size(); i++)
+			{
+				if (segments[i].IsEvent) Insert(Entry{ segments[i].Start, segments[i].Finish, i, segments[i].Target, 0 });
+				else if (HasEvent(*segments[i].Target) && !AddLoop(i)) opaque.push_back(i);
+			}
+		}
+
+		// Add an event at an absolute moment, it plays with the times the queue is played with
+		void Add(NumericType moment, IAnimation<NumericType>& animation) { Insert(Entry{ moment, moment, None, &animation, 0 }); }
+		void Add(NumericType moment, IAnimation<NumericType>* animation) { Insert(Entry{ moment, moment, None, animation, 0 }); }
+
+		std::size_t Count() const { return entries.size() + open.size(); }
+
+		// subtrees with events below nodes the timeline keeps whole other than loops, they play on every Play
+		std::size_t OpaqueCount() const { return opaque.size(); }
+
+		NumericType NextActivity(NumericType t) override
+		{
+			if (!sorted) Sort();
+			// the first event whose moment may still be ahead
+			NumericType next = opaque.empty() && loops.empty() ? this->Never() : graph->NextActivity(t);
+			for (auto& entry : open)
+			{
+				if (t < entry.Finish) next = std::min(next, entry.Start < t ? t : entry.Start);
+			}
+			auto entry = entries.begin();
+			if (std::numeric_limits<NumericType>::lowest() + width <= t)
+			{
+				entry = std::lower_bound(entries.begin(), entries.end(), t - width, [](const Entry& entry, NumericType value) { return entry.Start < value; });
+			}
+			for (; entry != entries.end(); ++entry)
+			{
+				if (t < entry->Finish) return std::min(next, entry->Start < t ? t : entry->Start);
+			}
+			return next;
+		}
+
+		void Play(NumericType t, NumericType t0) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(1);
+			if (!(t < t0) && !(t0 < t)) return; // nothing is crossed
+			crossed.clear();
+			Collect(t, t0, Placement{ 1, 0 }, None, crossed);
+			if (t0 < t)
+			{
+				for (auto& firing : crossed) Fire(firing);
+			}
+			else
+			{
+				for (auto firing = crossed.rbegin(); firing != crossed.rend(); ++firing) Fire(*firing);
+			}
+			for (auto index : opaque) graph->PlaySegment(index, t, t0);
+		}
+
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override
+		{
+			if (graph) visit(*graph);
+			for (auto& entry : entries)
+			{
+				if (entry.Segment == None) visit(*entry.Target);
+			}
+			for (auto& entry : open)
+			{
+				if (entry.Segment == None) visit(*entry.Target);
+			}
+		}
+
+		~AnimationEventQueue() { }
+	};
+}
@@ -0,0 +1,243 @@
+// AnimatAnything in C++
+// handoff between threads, graphs are published as immutable snapshots and results flow through lock-free buffers
+
+#pragma once
+
+#include "AnimateAnything.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace AnimateAnything
+{
+	// A graph with the container that owns its nodes. Build or change it freely until it is published,
+	// after that it belongs to the players and is not changed anymore.
+	template<typename NumericType> class AnimationSnapshot
+	{
+	public:
+		Container<NumericType> Nodes;
+		IAnimation<NumericType>* Root = nullptr;
+
+		AnimationSnapshot(ContainerStorage storage = ContainerStorage::Arena) : Nodes(storage) { }
+		AnimationSnapshot(const AnimationSnapshot&) = delete;
+		AnimationSnapshot& operator=(const AnimationSnapshot&) = delete;
+	};
+
+	// Plays whatever snapshot was published last. Editors build a new snapshot on any thread and Publish it, the swap
+	// is a single atomic exchange. Players never wait: each reader announces the snapshot it is playing in a hazard
+	// slot, replaced snapshots are deleted by the editors once no slot points at them anymore.
+	// Readers are numbered from 0, each number is used by one thread at a time, Play uses reader 0. NextActivity and
+	// ForEachChild have slots of their own after the readers, so they can be called while a reader is playing.
+	template<typename NumericType> class AnimationPublisher : public IAnimation<NumericType>
+	{
+	private:
+		using Snapshot = AnimationSnapshot<NumericType>;
+
+		std::atomic<Snapshot*> current;
+		std::unique_ptr<std::atomic<Snapshot*>[]> hazards; // the readers, then the slots of NextActivity and ForEachChild
+		std::size_t readers;
+
+		std::mutex editLock; // editors only, guards retired
+		std::vector<Snapshot*> retired;
+
+		// delete the retired snapshots no reader is playing, editLock is held
+		void Collect()
+		{
+			std::size_t kept = 0;
+			for (auto snapshot : retired)
+			{
+				bool used = false;
+				for (std::size_t i = 0; i < readers + 2 && !used; i++) used = hazards[i].load() == snapshot;
+				if (used) retired[kept++] = snapshot;
+				else delete snapshot;
+			}
+			retired.resize(kept);
+		}
+
+	public:
+		AnimationPublisher(std::size_t readers = 1) : current(nullptr), hazards(new std::atomic<Snapshot*>[(readers ? readers : 1) + 2]), readers(readers ? readers : 1)
+		{
+			for (std::size_t i = 0; i < this->readers + 2; i++) hazards[i].store(nullptr);
+		}
+
+		AnimationPublisher(const AnimationPublisher&) = delete;
+		AnimationPublisher& operator=(const AnimationPublisher&) = delete;
+
+		// Replace the played graph, the previous one is deleted when no reader uses it
+		void Publish(std::unique_ptr<Snapshot> snapshot)
+		{
+			Snapshot* previous = current.exchange(snapshot.release());
+			std::lock_guard<std::mutex> guard(editLock);
+			if (previous) retired.push_back(previous);
+			Collect();
+		}
+
+		// Delete the replaced snapshots that are not in use anymore, Publish does this as well
+		void Reclaim()
+		{
+			std::lock_guard<std::mutex> guard(editLock);
+			Collect();
+		}
+
+		// Snapshots replaced but still in use
+		std::size_t Retired()
+		{
+			std::lock_guard<std::mutex> guard(editLock);
+			return retired.size();
+		}
+
+		// Pin the current snapshot for a reader, it stays alive until Release, nullptr if nothing is published
+		Snapshot* Acquire(std::size_t reader)
+		{
+			auto& hazard = hazards[reader];
+			Snapshot* snapshot = current.load();
+			for (;;)
+			{
+				hazard.store(snapshot);
+				// the snapshot may have been replaced and deleted before the hazard was visible, check again
+				Snapshot* again = current.load();
+				if (again == snapshot) return snapshot;
+				snapshot = again;
+			}
+		}
+
+		void Release(std::size_t reader) { hazards[reader].store(nullptr, std::memory_order_release); }
+
+		// Play the current snapshot as reader
+		void Play(std::size_t reader, NumericType t, NumericType t0)
+		{
+			Snapshot* snapshot = Acquire(reader);
+			if (snapshot && snapshot->Root) snapshot->Root->Play(t, t0);
+			Release(reader);
+		}
+
+		void Play(NumericType t, NumericType t0) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(1);
+			Play(0, t, t0);
+		}
+
+		NumericType NextActivity(NumericType t) override
+		{
+			Snapshot* snapshot = Acquire(readers);
+			NumericType next = snapshot && snapshot->Root ? snapshot->Root->NextActivity(t) : t; // a graph may still be published
+			Release(readers);
+			return next;
+		}
+
+		// Visits the current root, the snapshot is pinned only during the visit: pointers to its nodes must not be kept
+		// after visit returns, a tool that needs them longer pins the snapshot with Acquire and Release of a reader
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override
+		{
+			Snapshot* snapshot = Acquire(readers + 1);
+			if (snapshot && snapshot->Root) visit(*snapshot->Root);
+			Release(readers + 1);
+		}
+
+		// no readers may be left
+		~AnimationPublisher()
+		{
+			delete current.load();
+			for (auto snapshot : retired) delete snapshot;
+		}
+	};
+
+	// Bounded queue for one producer thread and one consumer thread, neither ever waits for the other.
+	// Capacity is rounded up to a power of two.
+	template<typename Type> class SpscQueue
+	{
+	private:
+		std::vector<Type> items;
+		std::size_t mask;
+		alignas(64) std::atomic<std::size_t> head; // next item to pop, written by the consumer
+		alignas(64) std::atomic<std::size_t> tail; // next free slot, written by the producer
+		alignas(64) std::size_t cachedHead = 0; // producer copy of head
+		std::size_t cachedTail = 0; // consumer copy of tail, only the consumer uses it
+
+	public:
+		SpscQueue(std::size_t capacity) : head(0), tail(0)
+		{
+			std::size_t size = 2;
+			while (size < capacity) size *= 2;
+			items.resize(size);
+			mask = size - 1;
+		}
+
+		SpscQueue(const SpscQueue&) = delete;
+		SpscQueue& operator=(const SpscQueue&) = delete;
+
+		std::size_t Capacity() const { return items.size(); }
+
+		// Producer: false if the queue is full
+		bool TryPush(Type item)
+		{
+			std::size_t position = tail.load(std::memory_order_relaxed);
+			if (position - cachedHead >= items.size())
+			{
+				cachedHead = head.load(std::memory_order_acquire);
+				if (position - cachedHead >= items.size()) return false;
+			}
+			items[position & mask] = std::move(item);
+			tail.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Consumer: false if the queue is empty
+		bool TryPop(Type& item)
+		{
+			std::size_t position = head.load(std::memory_order_relaxed);
+			if (position == cachedTail)
+			{
+				cachedTail = tail.load(std::memory_order_acquire);
+				if (position == cachedTail) return false;
+			}
+			item = std::move(items[position & mask]);
+			head.store(position + 1, std::memory_order_release);
+			return true;
+		}
+	};
+
+	// Latest value from one writer thread to one reader thread. The writer fills Back and publishes it, the reader
+	// takes the newest published value with Update. Neither waits, values the reader did not take are overwritten.
+	template<typename Type> class TripleBuffer
+	{
+	private:
+		static const unsigned Fresh = 4; // the middle buffer was published after the reader last took it
+
+		Type buffers[3];
+		std::atomic<unsigned> middle; // index of the middle buffer and the Fresh bit
+		unsigned back = 0; // writer only
+		unsigned front = 1; // reader only
+
+	public:
+		TripleBuffer() : middle(2) { }
+		TripleBuffer(const Type& value) : buffers{ value, value, value }, middle(2) { }
+
+		TripleBuffer(const TripleBuffer&) = delete;
+		TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+		// Writer: the buffer to fill, it keeps what was written to it two publishes ago
+		Type& Back() { return buffers[back]; }
+
+		// Writer: make Back the newest value and continue with another buffer
+		void Publish()
+		{
+			back = middle.exchange(back | Fresh, std::memory_order_acq_rel) & ~Fresh;
+		}
+
+		// Reader: take the newest value if there is one, returns false if nothing was published since the last update
+		bool Update()
+		{
+			if (!(middle.load(std::memory_order_relaxed) & Fresh)) return false;
+			front = middle.exchange(front, std::memory_order_acq_rel) & ~Fresh;
+			return true;
+		}
+
+		// Reader: the value taken by the last Update
+		const Type& Front() const { return buffers[front]; }
+	};
+}
@@ -0,0 +1,522 @@
+// AnimatAnything in C++
+// graph optimizer, rebuilds a finished graph with time chains folded, parallels flattened and ranges that never play removed
+
+#pragma once
+
+#include "AnimateAnything.h"
+#include "AnimationTimeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace AnimateAnything
+{
+	// One stage of an AnimationChain: checks on local time, then one transform
+	template<typename NumericType> struct ChainStage
+	{
+		enum Check : unsigned char
+		{
+			AtLeast = 1, // Lo <= t
+			Below = 2, // t < Hi
+			Crossing = 4, // t0 -> t crosses Moment
+		};
+
+		enum TransformKind : unsigned char { Add, Multiply, Subtract }; // Subtract only where -Value does not exist
+
+		NumericType Lo;
+		NumericType Hi;
+		NumericType Moment;
+		NumericType Value;
+		unsigned char Checks;
+		TransformKind Transform;
+	};
+
+#ifndef ANIMATEANYTHING_CHAIN_STAGES
+#define ANIMATEANYTHING_CHAIN_STAGES 4 // stages an AnimationChain keeps inline, longer chains are split
+#endif
+
+	// Plays its child through a chain of time checks and transforms in a single call. AnimationOptimizer makes these
+	// from nested range, seek, stretch and event nodes, Source is the node the chain was folded from. The checks of
+	// a stage test the same t, so a stage costs a few predictable branches where the nodes cost a call each.
+	template<typename NumericType> class AnimationChain : public IAnimation<NumericType>
+	{
+	private:
+		using Stage = ChainStage<NumericType>;
+
+		static bool Crossed(NumericType moment, NumericType t, NumericType t0) { return (moment <= t && t0 < moment) || (t <= moment && moment < t0); }
+
+	public:
+		static const std::size_t Capacity = ANIMATEANYTHING_CHAIN_STAGES;
+
+		Stage Stages[Capacity];
+		std::size_t Count;
+		IAnimation<NumericType>& Animation;
+		IAnimation<NumericType>* Source; // answers NextActivity, nullptr if the chain is active at any time
+
+		void Play(NumericType t, NumericType t0) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(1);
+			for (const Stage* stage = Stages, *end = Stages + Count; stage != end; ++stage)
+			{
+				if (unsigned char checks = stage->Checks)
+				{
+					if ((checks & Stage::AtLeast) && !(stage->Lo <= t)) return;
+					if ((checks & Stage::Below) && !(t < stage->Hi)) return;
+					if ((checks & Stage::Crossing) && !Crossed(stage->Moment, t, t0)) return;
+				}
+				NumericType value = stage->Value;
+				if (stage->Transform == Stage::Add)
+				{
+					t = t + value;
+					t0 = t0 + value;
+				}
+				else if (stage->Transform == Stage::Multiply)
+				{
+					t = t*value;
+					t0 = t0*value;
+				}
+				else
+				{
+					t = t - value;
+					t0 = t0 - value;
+				}
+			}
+			ANIMATEANYTHING_PROFILE_HIT(1);
+			Animation.Play(t, t0);
+		}
+
+		void PlayBatch(const TimeSamples<NumericType>& samples) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(samples.Count);
+			TimeSamples<NumericType> local = samples;
+			std::size_t frames = 0;
+			for (std::size_t i = 0; i < Count && local.Count; i++)
+			{
+				const Stage stage = Stages[i];
+				if (stage.Checks)
+				{
+					local = samples.Scratch->Select(local, 0, [stage](NumericType t, NumericType t0)
+					{
+						return (!(stage.Checks & Stage::AtLeast) || stage.Lo <= t) && (!(stage.Checks & Stage::Below) || t < stage.Hi) && (!(stage.Checks & Stage::Crossing) || Crossed(stage.Moment, t, t0));
+					});
+					frames++;
+				}
+				NumericType value = stage.Value;
+				if (stage.Transform == Stage::Multiply && value == 1) continue;
+				switch (stage.Transform)
+				{
+				case Stage::Add: local = samples.Scratch->Map(local, [value](NumericType t) { return t + value; }); break;
+				case Stage::Subtract: local = samples.Scratch->Map(local, [value](NumericType t) { return t - value; }); break;
+				case Stage::Multiply: local = samples.Scratch->Map(local, [value](NumericType t) { return t*value; }); break;
+				}
+				frames++;
+			}
+			ANIMATEANYTHING_PROFILE_HIT(local.Count);
+			if (local.Count) Animation.PlayBatch(local);
+			for (; frames; frames--) samples.Scratch->Pop();
+		}
+
+		NumericType NextActivity(NumericType t) override { return Source ? Source->NextActivity(t) : t; }
+
+		// Up to Capacity stages
+		AnimationChain(const ChainStage<NumericType>* stages, std::size_t count, IAnimation<NumericType>& action, IAnimation<NumericType>* source = nullptr) : Count(count < Capacity ? count : Capacity), Animation(action), Source(source)
+		{
+			std::copy(stages, stages + Count, Stages);
+		}
+		AnimationChain(const ChainStage<NumericType>* stages, std::size_t count, IAnimation<NumericType>* action, IAnimation<NumericType>* source = nullptr) : AnimationChain(stages, count, *action, source) { }
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override { visit(Animation); }
+		~AnimationChain() { }
+	};
+
+	// Size of a graph: distinct nodes, and the most calls nested from the root down to a leaf
+	struct GraphShape
+	{
+		std::size_t Nodes;
+		std::size_t Depth;
+	};
+
+	template<typename NumericType> GraphShape MeasureGraph(IAnimation<NumericType>& root)
+	{
+		std::unordered_map<IAnimation<NumericType>*, std::size_t> depths;
+		std::function<std::size_t(IAnimation<NumericType>&)> depth = [&](IAnimation<NumericType>& node)
+		{
+			auto found = depths.find(&node);
+			if (found != depths.end()) return found->second;
+			depths[&node] = 1; // a cycle ends here
+			std::size_t deepest = 0;
+			node.ForEachChild([&](IAnimation<NumericType>& child) { deepest = std::max(deepest, depth(child)); });
+			return depths[&node] = deepest + 1;
+		};
+		std::size_t levels = depth(root);
+		return GraphShape{ depths.size(), levels };
+	}
+
+	// What an optimization changed
+	struct OptimizerStats
+	{
+		GraphShape Before;
+		GraphShape After;
+		std::size_t Folded = 0; // range, seek, stretch and event nodes replaced by chains
+		std::size_t Flattened = 0; // parallels merged into their parent
+		std::size_t Pruned = 0; // subtrees removed because the ranges above them never let them play
+	};
+
+	// Rebuilds a finished graph into a container so that it plays the same with fewer calls. Runs of range, seek,
+	// stretch and event nodes become one AnimationChain, nested parallels are merged, and the range of local time
+	// each node can see is followed down the tree to remove children that can never play and checks that always pass.
+	// Loops and time transforms are rebuilt around their optimized child, other nodes are used in place, like the
+	// leaves, so the source graph must outlive the result. Nodes with state stay shared, checkpoints keep working.
+	template<typename NumericType> class AnimationOptimizer
+	{
+	private:
+		using Step = TimelineStep<NumericType>;
+
+		// the values local time can take, [Lo, Hi] or [Lo, Hi) with each side optional
+		struct Range
+		{
+			NumericType Lo = 0;
+			NumericType Hi = 0;
+			bool HasLo = false;
+			bool HasHi = false;
+			bool HiOpen = false;
+
+			bool operator<(const Range& other) const { return std::tie(HasLo, Lo, HasHi, Hi, HiOpen) < std::tie(other.HasLo, other.Lo, other.HasHi, other.Hi, other.HiOpen); }
+		};
+
+		Container<NumericType>& container;
+		std::map<std::pair<IAnimation<NumericType>*, Range>, IAnimation<NumericType>*> built; // shared subtrees are rebuilt once per range
+		std::unordered_map<IAnimation<NumericType>*, std::pair<std::vector<Step>, IAnimation<NumericType>*>> chains; // steps and child of the chains made here
+
+		static bool Integral() { return std::is_integral<NumericType>::value; }
+
+		// bound + value or bound - value, false if an integral bound overflows or a floating one is not a number
+		static bool Shift(NumericType& bound, NumericType value, bool add)
+		{
+			if (Integral())
+			{
+				const NumericType lowest = std::numeric_limits<NumericType>::lowest(), highest = std::numeric_limits<NumericType>::max();
+				if (add && (0 < value ? highest - value < bound : bound < lowest - value)) return false;
+				if (!add && (0 < value ? bound < lowest + value : highest + value < bound)) return false;
+			}
+			bound = add ? bound + value : bound - value;
+			return bound == bound;
+		}
+
+		static void Unbound(Range& range)
+		{
+			range = Range();
+		}
+
+		// Narrow range by a step, false if the step never passes, redundant if it always passes or changes nothing.
+		// Rounding is monotone, so bounds pushed through the same operations as t stay exact.
+		static bool Narrow(Range& range, const Step& step, bool& redundant)
+		{
+			NumericType value = step.Value;
+			redundant = false;
+			switch (step.Kind)
+			{
+			case Step::AtLeast:
+				if (range.HasHi && (range.HiOpen ? !(value < range.Hi) : range.Hi < value)) return false;
+				if (range.HasLo && !(range.Lo < value)) redundant = true;
+				else
+				{
+					range.Lo = value;
+					range.HasLo = true;
+				}
+				return true;
+			case Step::Below:
+				if (range.HasLo && !(range.Lo < value)) return false;
+				if (range.HasHi && (range.HiOpen ? !(value < range.Hi) : range.Hi < value)) redundant = true;
+				else
+				{
+					range.Hi = value;
+					range.HasHi = true;
+					range.HiOpen = true;
+				}
+				return true;
+			case Step::Subtract:
+			case Step::Add:
+			{
+				bool add = step.Kind == Step::Add;
+				// t - 0 is t, t + 0 turns -0 into 0 unless time is integral
+				if (value == 0 && (Integral() || add == std::signbit(value)))
+				{
+					redundant = true;
+					return true;
+				}
+				if ((range.HasLo && !Shift(range.Lo, value, add)) || (range.HasHi && !Shift(range.Hi, value, add))) Unbound(range);
+				range.HiOpen = false;
+				return true;
+			}
+			case Step::Multiply:
+				if (value == 1)
+				{
+					redundant = true;
+					return true;
+				}
+				if (value == 0)
+				{
+					range.Lo = range.Hi = 0;
+					range.HasLo = range.HasHi = true;
+					range.HiOpen = false;
+					return true;
+				}
+				// integral products may overflow, only floating bounds are kept
+				if (Integral() || !(value == value))
+				{
+					Unbound(range);
+					return true;
+				}
+				if (value < 0)
+				{
+					std::swap(range.Lo, range.Hi);
+					std::swap(range.HasLo, range.HasHi);
+				}
+				range.Lo = range.Lo*value;
+				range.Hi = range.Hi*value;
+				range.HiOpen = false;
+				if (!(range.Lo == range.Lo) || !(range.Hi == range.Hi)) Unbound(range);
+				return true;
+			case Step::Crossing:
+				return true; // depends on t0, which no range limits
+			}
+			return true;
+		}
+
+		static bool IsTransform(const Step& step) { return step.Kind == Step::Subtract || step.Kind == Step::Add || step.Kind == Step::Multiply; }
+
+		// Simplify the steps entering with range, range is left at what the child sees. False if they never pass.
+		bool Simplify(const std::vector<Step>& path, Range& range, std::vector<Step>& steps) const
+		{
+			steps.clear();
+			bool fold = Integral() || FoldRounding;
+			for (const Step& step : path)
+			{
+				bool redundant;
+				if (!Narrow(range, step, redundant)) return false;
+				if (redundant) continue;
+				if (!steps.empty())
+				{
+					Step& last = steps.back();
+					// adjacent checks of one kind test the same t, the stricter one decides
+					if ((step.Kind == Step::AtLeast || step.Kind == Step::Below) && last.Kind == step.Kind)
+					{
+						last.Value = step.Value;
+						continue;
+					}
+					if (fold && IsTransform(step) && IsTransform(last) && (step.Kind == Step::Multiply) == (last.Kind == Step::Multiply))
+					{
+						if (step.Kind == Step::Multiply) last.Value = last.Value*step.Value;
+						else
+						{
+							NumericType shift = last.Kind == Step::Add ? last.Value : NumericType(0) - last.Value;
+							shift = step.Kind == Step::Add ? shift + step.Value : shift - step.Value;
+							last = Step{ Step::Add, shift };
+						}
+						bool identity = last.Kind == Step::Multiply ? last.Value == 1 : last.Value == 0;
+						if (identity) steps.pop_back();
+						continue;
+					}
+				}
+				steps.push_back(step);
+			}
+			return true;
+		}
+
+		template<typename Node, typename ...Args> Node* Make(Args&&... args)
+		{
+			return container.template Make<Node>(std::forward<Args>(args)...);
+		}
+
+		// Checks up to the next transform go in one stage, they all test the same t. t - v is t + -v, and t * 1 is t,
+		// so a stage only has to tell adding from multiplying.
+		static std::vector<ChainStage<NumericType>> Compile(const std::vector<Step>& steps)
+		{
+			using Stage = ChainStage<NumericType>;
+			std::vector<Stage> stages;
+			const Stage none = Stage{ 0, 0, 0, 1, 0, Stage::Multiply };
+			Stage stage = none;
+			for (const Step& step : steps)
+			{
+				switch (step.Kind)
+				{
+				case Step::AtLeast:
+					if (!(stage.Checks & Stage::AtLeast) || stage.Lo < step.Value) stage.Lo = step.Value;
+					stage.Checks |= Stage::AtLeast;
+					break;
+				case Step::Below:
+					if (!(stage.Checks & Stage::Below) || step.Value < stage.Hi) stage.Hi = step.Value;
+					stage.Checks |= Stage::Below;
+					break;
+				case Step::Crossing:
+					if (stage.Checks & Stage::Crossing)
+					{
+						stages.push_back(stage);
+						stage = none;
+					}
+					stage.Moment = step.Value;
+					stage.Checks |= Stage::Crossing;
+					break;
+				case Step::Subtract:
+					// the negation of the lowest integer does not exist
+					stage.Transform = std::is_signed<NumericType>::value && step.Value == std::numeric_limits<NumericType>::lowest() ? Stage::Subtract : Stage::Add;
+					stage.Value = stage.Transform == Stage::Add ? NumericType(NumericType(-1) * step.Value) : step.Value;
+					stages.push_back(stage);
+					stage = none;
+					break;
+				case Step::Add:
+				case Step::Multiply:
+					stage.Transform = step.Kind == Step::Add ? Stage::Add : Stage::Multiply;
+					stage.Value = step.Value;
+					stages.push_back(stage);
+					stage = none;
+					break;
+				}
+			}
+			if (stage.Checks) stages.push_back(stage);
+			return stages;
+		}
+
+		// the optimized form of node for local time in range, nullptr if it can never play
+		IAnimation<NumericType>* Rebuild(IAnimation<NumericType>& node, const Range& range)
+		{
+			auto key = std::make_pair(&node, range);
+			auto found = built.find(key);
+			if (found != built.end()) return found->second;
+			IAnimation<NumericType>* result = Chain(node, range);
+			built[key] = result;
+			return result;
+		}
+
+		IAnimation<NumericType>* Chain(IAnimation<NumericType>& node, Range range)
+		{
+			std::vector<Step> path, steps;
+			std::size_t folded = 0;
+			IAnimation<NumericType>* tail = &node;
+			while (IAnimation<NumericType>* child = AppendSteps(*tail, path))
+			{
+				tail = child;
+				folded++;
+			}
+			Range local = range;
+			if (!Simplify(path, local, steps))
+			{
+				Stats.Pruned++;
+				return nullptr;
+			}
+			IAnimation<NumericType>* end = Inner(*tail, local);
+			if (!end) return nullptr;
+
+			// a parallel left with one chain continues this chain
+			auto below = chains.find(end);
+			bool merged = below != chains.end();
+			if (merged)
+			{
+				path = steps;
+				path.insert(path.end(), below->second.first.begin(), below->second.first.end());
+				local = range;
+				Simplify(path, local, steps);
+				end = below->second.second;
+			}
+			if (steps.empty()) return end;
+			if (folded == 1 && !merged) return end == tail ? &node : Reparent(node, *end); // a single node plays faster than a chain
+			Stats.Folded += folded;
+			// long chains are split, the inner parts cannot answer for the source node
+			std::vector<ChainStage<NumericType>> stages = Compile(steps);
+			const std::size_t capacity = AnimationChain<NumericType>::Capacity;
+			IAnimation<NumericType>* inner = end;
+			for (std::size_t first = (stages.size() - 1) / capacity * capacity; first; first -= capacity)
+			{
+				inner = Make<AnimationChain<NumericType>>(stages.data() + first, stages.size() - first, *inner, nullptr);
+				stages.resize(first);
+			}
+			auto chain = Make<AnimationChain<NumericType>>(stages.data(), stages.size(), *inner, &node);
+			chains[chain] = std::make_pair(std::move(steps), end);
+			return chain;
+		}
+
+		// a copy of a range, seek, stretch or event node over another child
+		IAnimation<NumericType>* Reparent(IAnimation<NumericType>& node, IAnimation<NumericType>& child)
+		{
+			if (auto between = ExactNode<AnimationBetween<NumericType>>(node)) return Make<AnimationBetween<NumericType>>(between->Start, between->Finish, child);
+			if (auto after = ExactNode<AnimationAfter<NumericType>>(node)) return Make<AnimationAfter<NumericType>>(after->Start, child);
+			if (auto before = ExactNode<AnimationBefore<NumericType>>(node)) return Make<AnimationBefore<NumericType>>(before->Finish, child);
+			if (auto seek = ExactNode<AnimationSeek<NumericType>>(node)) return Make<AnimationSeek<NumericType>>(seek->Skip, child);
+			if (auto stretch = ExactNode<AnimationStretch<NumericType>>(node)) return Make<AnimationStretch<NumericType>>(stretch->Scale, child);
+			auto event = ExactNode<AnimationEvent<NumericType>>(node);
+			return Make<AnimationEvent<NumericType>>(event->Moment, child);
+		}
+
+		// the node at the end of a chain, subclasses of the known nodes and other nodes are kept as they are
+		IAnimation<NumericType>* Inner(IAnimation<NumericType>& node, const Range& range)
+		{
+			if (auto parallel = ExactNode<AnimationParallel<NumericType>>(node))
+			{
+				std::vector<IAnimation<NumericType>*> children;
+				for (auto child : parallel->Animations)
+				{
+					IAnimation<NumericType>* rebuilt = Rebuild(*child, range);
+					if (!rebuilt) continue;
+					if (auto nested = ExactNode<AnimationParallel<NumericType>>(*rebuilt))
+					{
+						children.insert(children.end(), nested->Animations.begin(), nested->Animations.end());
+						Stats.Flattened++;
+					}
+					else children.push_back(rebuilt);
+				}
+				if (children.empty()) return nullptr;
+				if (children.size() == 1) return children[0];
+				if (std::equal(children.begin(), children.end(), parallel->Animations.begin(), parallel->Animations.end())) return parallel;
+				auto result = Make<AnimationParallel<NumericType>>();
+				result->Animations.assign(children.begin(), children.end());
+				return result;
+			}
+			// the child of a loop or transform sees any time
+			if (auto loop = ExactNode<AnimationLoop<NumericType>>(node))
+			{
+				IAnimation<NumericType>* child = Rebuild(loop->Animation, Range());
+				if (!child) return nullptr;
+				if (child == &loop->Animation) return loop;
+				return Make<AnimationLoop<NumericType>>(loop->Period, loop->Count, loop->PingPong, *child);
+			}
+			if (auto transform = ExactNode<AnimationTimeTransform<NumericType>>(node))
+			{
+				IAnimation<NumericType>* child = Rebuild(transform->Animation, Range());
+				if (!child) return nullptr;
+				if (child == &transform->Animation) return transform;
+				return Make<AnimationTimeTransform<NumericType>>(transform->Transform, *child);
+			}
+			return &node;
+		}
+
+	public:
+		bool FoldRounding = false; // also fold floating point shifts and scales, local time may then differ by rounding
+		OptimizerStats Stats;
+
+		AnimationOptimizer(Container<NumericType>& container) : container(container) { }
+
+		// The optimized graph, made in the container. A root that can never play becomes an empty parallel.
+		IAnimation<NumericType>* Optimize(IAnimation<NumericType>& root)
+		{
+			Stats = OptimizerStats();
+			Stats.Before = MeasureGraph(root);
+			built.clear();
+			chains.clear();
+			IAnimation<NumericType>* result = Rebuild(root, Range());
+			if (!result) result = container.template Make<AnimationParallel<NumericType>>();
+			Stats.After = MeasureGraph(*result);
+			return result;
+		}
+
+		IAnimation<NumericType>* Optimize(IAnimation<NumericType>* root) { return Optimize(*root); }
+	};
+}
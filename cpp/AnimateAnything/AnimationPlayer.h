@@ -0,0 +1,177 @@
+// AnimatAnything in C++
+// player, plays animations against a monotonic clock and sleeps until one of them has something to do
+
+#pragma once
+
+#include "AnimateAnything.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace AnimateAnything
+{
+	// Plays root animations from the moment they are added, each root is played only when its NextActivity is due.
+	// Roots that are continuously active are played every FrameInterval, roots that have finished are retired.
+	// Step and Run play on the calling thread, Play, Remove and Stop can be called from any thread, animations included.
+	// The first frame of a root is played from just before local time 0, so events at 0 fire.
+	template<typename NumericType> class AnimationPlayer
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+	private:
+
+		struct Root
+		{
+			IAnimation<NumericType>* Animation;
+			Clock::time_point Start;
+			NumericType Last; // local time of the previous frame, just before 0 at first
+			Clock::time_point Deadline;
+		};
+
+		std::vector<Root> roots; // only used by the thread that steps
+
+		// requests from other threads, guarded by lock
+		std::mutex lock;
+		std::condition_variable wake;
+		std::vector<Root> pending;
+		std::vector<IAnimation<NumericType>*> removed;
+		bool stopping = false;
+		std::size_t added = 0; // roots added so far, wakes Run up
+
+		std::atomic<std::size_t> active;
+		std::atomic<std::size_t> frames;
+
+		NumericType LocalTime(const Root& root, Clock::time_point now) const
+		{
+			return NumericType(std::chrono::duration<double>(now - root.Start).count() * UnitsPerSecond);
+		}
+
+		Clock::time_point ToClock(const Root& root, NumericType local) const
+		{
+			return root.Start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(double(local) / UnitsPerSecond));
+		}
+
+		// play a root and schedule its next frame, false if it has finished
+		bool PlayRoot(Root& root, Clock::time_point now)
+		{
+			NumericType t = LocalTime(root, now);
+			root.Animation->Play(t, root.Last);
+			root.Last = t;
+			frames++;
+			NumericType next = root.Animation->NextActivity(t);
+			if (next == IAnimation<NumericType>::Never()) return false;
+			Clock::time_point frame = now + std::chrono::duration_cast<Clock::duration>(FrameInterval);
+			// the clock may land a little before the moment, schedule at least one frame later
+			root.Deadline = t < next ? ToClock(root, next) : frame;
+			if (root.Deadline < frame) root.Deadline = frame;
+			return true;
+		}
+
+	public:
+		double UnitsPerSecond; // time units of the animations per second
+		std::chrono::duration<double> FrameInterval; // time between frames of active animations
+
+		std::function<Clock::time_point()> Now; // the time Play and Step read, set before playing. Run sleeps on Clock, other times are for calling Step by hand
+
+		AnimationPlayer(double unitsPerSecond = 1.0, std::chrono::duration<double> frameInterval = std::chrono::duration<double>(1.0 / 60)) :
+			active(0), frames(0), UnitsPerSecond(unitsPerSecond), FrameInterval(frameInterval), Now(&Clock::now) { }
+
+		AnimationPlayer(const AnimationPlayer&) = delete;
+		AnimationPlayer& operator=(const AnimationPlayer&) = delete;
+
+		// Start playing an animation now, local time 0 is played on the next step
+		void Play(IAnimation<NumericType>& animation)
+		{
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				Clock::time_point now = Now();
+				pending.push_back(Root{ &animation, now, LoopCycles<NumericType>::Below(NumericType(0), std::is_integral<NumericType>()), now });
+				added++;
+			}
+			wake.notify_all();
+		}
+
+		// Stop playing an animation before it finishes
+		void Remove(IAnimation<NumericType>& animation)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			removed.push_back(&animation);
+		}
+
+		// Make Run return
+		void Stop()
+		{
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				stopping = true;
+			}
+			wake.notify_all();
+		}
+
+		// Number of roots that have not finished
+		std::size_t Count()
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			return active + pending.size();
+		}
+
+		// Number of root plays so far
+		std::size_t Frames() const { return frames; }
+
+		// Play the roots that are due, returns the time of the next deadline or time_point::max when nothing is left
+		Clock::time_point Step()
+		{
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				roots.insert(roots.end(), pending.begin(), pending.end());
+				pending.clear();
+				for (auto animation : removed)
+				{
+					roots.erase(std::remove_if(roots.begin(), roots.end(), [&](const Root& root) { return root.Animation == animation; }), roots.end());
+				}
+				removed.clear();
+			}
+			Clock::time_point now = Now();
+			Clock::time_point next = Clock::time_point::max();
+			for (std::size_t i = 0; i < roots.size(); i++)
+			{
+				Root& root = roots[i];
+				if (root.Deadline <= now && !PlayRoot(root, now))
+				{
+					roots.erase(roots.begin() + i--);
+					continue;
+				}
+				if (root.Deadline < next) next = root.Deadline;
+			}
+			active = roots.size();
+			return next;
+		}
+
+		// Play until every root has finished or Stop is called, sleeps between deadlines
+		void Run()
+		{
+			for (;;)
+			{
+				Clock::time_point next = Step();
+				std::unique_lock<std::mutex> guard(lock);
+				if (stopping || (roots.empty() && pending.empty()))
+				{
+					stopping = false;
+					return;
+				}
+				// roots added since the step are due at once, roots added while sleeping wake it up
+				if (!pending.empty()) continue;
+				std::size_t seen = added;
+				wake.wait_until(guard, next, [&] { return stopping || added != seen; });
+			}
+		}
+	};
+}
@@ -0,0 +1,205 @@
+// AnimatAnything in C++
+// profile report, shows where the time of a graph goes when it is built with ANIMATEANYTHING_PROFILE defined
+
+#pragma once
+
+#include "AnimateAnything.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+namespace AnimateAnything
+{
+	// Snapshot of the profile counters of a graph, in depth first order from the root.
+	// A node reachable from several parents appears under each of them, the flat view counts it once.
+	// Without ANIMATEANYTHING_PROFILE the report only shows the structure, all counters are 0.
+	template<typename NumericType> class ProfileReport
+	{
+	public:
+		struct Node
+		{
+			IAnimation<NumericType>* Animation;
+			std::string Label; // the label given with Label, or empty
+			std::string Type; // class name of the node
+			std::size_t Depth;
+			std::size_t Parent; // index of the parent, None for the root
+			std::uint64_t Plays;
+			std::uint64_t Hits;
+			std::uint64_t Nanoseconds; // time in actions of this node
+			std::uint64_t TotalNanoseconds; // time in actions of the whole subtree
+		};
+
+		static const std::size_t None = std::size_t(-1);
+
+		static constexpr bool Enabled()
+		{
+#ifdef ANIMATEANYTHING_PROFILE
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		std::vector<Node> Nodes;
+
+	private:
+
+		static std::string TypeName(const IAnimation<NumericType>& animation)
+		{
+			std::string name = typeid(animation).name();
+#if defined(__GNUG__)
+			int status = 0;
+			std::unique_ptr<char, void(*)(void*)> demangled(abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status), std::free);
+			if (status == 0 && demangled) name = demangled.get();
+#endif
+			// AnimateAnything::AnimationBetween<double> is shown as AnimationBetween
+			std::size_t arguments = name.find('<');
+			std::size_t scope = name.rfind("::", arguments);
+			if (arguments != std::string::npos) name.erase(arguments);
+			if (scope != std::string::npos) name.erase(0, scope + 2);
+			std::size_t space = name.rfind(' ');
+			if (space != std::string::npos) name.erase(0, space + 1);
+			return name;
+		}
+
+		void Walk(IAnimation<NumericType>& animation, std::size_t depth, std::size_t parent, std::vector<const IAnimation<NumericType>*>& path)
+		{
+			// a graph is a DAG, but a cycle through Enter or Exit would never end
+			if (std::find(path.begin(), path.end(), &animation) != path.end()) return;
+			std::size_t index = Nodes.size();
+			Node node{ &animation, std::string(), TypeName(animation), depth, parent, 0, 0, 0, 0 };
+#ifdef ANIMATEANYTHING_PROFILE
+			node.Label = animation.Profile.Label;
+			node.Plays = animation.Profile.Plays;
+			node.Hits = animation.Profile.Hits;
+			node.Nanoseconds = animation.Profile.Nanoseconds;
+#endif
+			node.TotalNanoseconds = node.Nanoseconds;
+			Nodes.push_back(node);
+			path.push_back(&animation);
+			animation.ForEachChild([&](IAnimation<NumericType>& child)
+			{
+				std::size_t first = Nodes.size();
+				Walk(child, depth + 1, index, path);
+				if (first < Nodes.size()) Nodes[index].TotalNanoseconds += Nodes[first].TotalNanoseconds;
+			});
+			path.pop_back();
+		}
+
+		static std::string Name(const Node& node)
+		{
+			return node.Label.empty() ? node.Type : node.Label + " (" + node.Type + ")";
+		}
+
+		static std::string Milliseconds(std::uint64_t nanoseconds)
+		{
+			char text[32];
+			std::snprintf(text, sizeof(text), "%.3f", double(nanoseconds) / 1e6);
+			return text;
+		}
+
+		static std::string Escape(const std::string& text)
+		{
+			std::string escaped;
+			for (char c : text)
+			{
+				if (c == '"' || c == '\\') escaped += '\\';
+				if (static_cast<unsigned char>(c) < 0x20) escaped += ' ';
+				else escaped += c;
+			}
+			return escaped;
+		}
+
+		void Json(std::string& out, std::size_t index, std::size_t& next, std::size_t indent) const
+		{
+			const Node& node = Nodes[index];
+			std::string pad(indent, ' ');
+			out += pad + "{ \"label\": \"" + Escape(node.Label) + "\", \"type\": \"" + Escape(node.Type) + "\"";
+			out += ", \"plays\": " + std::to_string(node.Plays) + ", \"hits\": " + std::to_string(node.Hits);
+			out += ", \"ns\": " + std::to_string(node.Nanoseconds) + ", \"total_ns\": " + std::to_string(node.TotalNanoseconds);
+			out += ", \"children\": [";
+			bool first = true;
+			for (next = index + 1; next < Nodes.size() && Nodes[next].Depth > node.Depth; )
+			{
+				out += first ? "\n" : ",\n";
+				first = false;
+				Json(out, next, next, indent + 2);
+			}
+			out += first ? "] }" : "\n" + pad + "] }";
+		}
+
+	public:
+
+		// Collect the counters of every node under root
+		ProfileReport(IAnimation<NumericType>& root)
+		{
+			std::vector<const IAnimation<NumericType>*> path;
+			Walk(root, 0, None, path);
+		}
+
+		// The count nodes with the most action time, then the most plays, shared nodes are listed once
+		std::string Top(std::size_t count) const
+		{
+			std::vector<const Node*> flat;
+			for (auto& node : Nodes)
+			{
+				bool seen = std::any_of(flat.begin(), flat.end(), [&](const Node* other) { return other->Animation == node.Animation; });
+				if (!seen) flat.push_back(&node);
+			}
+			std::stable_sort(flat.begin(), flat.end(), [](const Node* a, const Node* b)
+			{
+				return a->Nanoseconds != b->Nanoseconds ? a->Nanoseconds > b->Nanoseconds : a->Plays > b->Plays;
+			});
+			if (flat.size() > count) flat.resize(count);
+			std::string out = "      ms      plays       hits  node\n";
+			for (auto node : flat)
+			{
+				char line[64];
+				std::snprintf(line, sizeof(line), "%8s %10llu %10llu  ", Milliseconds(node->Nanoseconds).c_str(), (unsigned long long)node->Plays, (unsigned long long)node->Hits);
+				out += line + Name(*node) + "\n";
+			}
+			return out;
+		}
+
+		// The graph indented by depth, with the action time of every subtree
+		std::string Tree() const
+		{
+			std::string out = "total ms      plays       hits  node\n";
+			for (auto& node : Nodes)
+			{
+				char line[64];
+				std::snprintf(line, sizeof(line), "%8s %10llu %10llu  ", Milliseconds(node.TotalNanoseconds).c_str(), (unsigned long long)node.Plays, (unsigned long long)node.Hits);
+				out += line + std::string(node.Depth * 2, ' ') + Name(node) + "\n";
+			}
+			return out;
+		}
+
+		// The tree as nested JSON objects
+		std::string Json() const
+		{
+			std::string out;
+			std::size_t next = 0;
+			if (!Nodes.empty()) Json(out, 0, next, 0);
+			return out + "\n";
+		}
+
+		// Clear the counters of every node under root, labels are kept
+		static void Reset(IAnimation<NumericType>& root)
+		{
+#ifdef ANIMATEANYTHING_PROFILE
+			ProfileReport report(root);
+			for (auto& node : report.Nodes) node.Animation->Profile.Reset();
+#endif
+		}
+	};
+}
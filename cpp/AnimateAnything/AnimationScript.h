@@ -0,0 +1,364 @@
+// AnimatAnything in C++
+// coroutine scripts, sequences written as code that waits for time, signals and tweens, needs C++20 coroutines
+
+#pragma once
+
+#include "AnimateAnything.h"
+
+// <coroutine> stops the build with an error when the compiler has coroutines switched off, as GCC before C++20
+// without -fcoroutines, so it is only included once the language feature is on. Otherwise the header is empty.
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#endif
+#endif
+
+#if defined(__cpp_lib_coroutine) && defined(__cpp_impl_coroutine)
+#define ANIMATEANYTHING_COROUTINES 1
+#endif
+
+#ifdef ANIMATEANYTHING_COROUTINES
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace AnimateAnything
+{
+	// Memory for coroutine frames, freed frames are kept per thread in lists by size and reused by the next script
+	class ScriptFramePool
+	{
+	private:
+		static const std::size_t Granularity = 64;
+		static const std::size_t Classes = 32; // frames up to 2 KB are pooled
+
+		struct FreeFrame
+		{
+			FreeFrame* Next;
+		};
+
+		FreeFrame* frames[Classes] = {};
+
+		static ScriptFramePool& Local()
+		{
+			thread_local ScriptFramePool pool;
+			return pool;
+		}
+
+		static std::size_t Class(std::size_t size) { return (size + Granularity - 1) / Granularity; }
+
+	public:
+		static void* Allocate(std::size_t size)
+		{
+			std::size_t sizeClass = Class(size);
+			if (sizeClass >= Classes) return ::operator new(size);
+			ScriptFramePool& pool = Local();
+			if (FreeFrame* frame = pool.frames[sizeClass])
+			{
+				pool.frames[sizeClass] = frame->Next;
+				return frame;
+			}
+			return ::operator new(sizeClass * Granularity);
+		}
+
+		static void Release(void* memory, std::size_t size)
+		{
+			std::size_t sizeClass = Class(size);
+			if (sizeClass >= Classes)
+			{
+				::operator delete(memory);
+				return;
+			}
+			ScriptFramePool& pool = Local();
+			FreeFrame* frame = static_cast<FreeFrame*>(memory);
+			frame->Next = pool.frames[sizeClass];
+			pool.frames[sizeClass] = frame;
+		}
+
+		~ScriptFramePool()
+		{
+			for (auto& list : frames)
+			{
+				while (list)
+				{
+					FreeFrame* next = list->Next;
+					::operator delete(list);
+					list = next;
+				}
+			}
+		}
+	};
+
+	template<typename NumericType> class ScriptRunner;
+
+	// Raised by game code, scripts waiting for it with Until continue on the next play
+	class ScriptSignal
+	{
+	public:
+		std::size_t Raised = 0; // number of times raised
+		void Raise() { Raised++; }
+	};
+
+	// Return type of a script coroutine. A script awaits Wait, Until, Tween or another script, which runs to its end first.
+	template<typename NumericType> class Script
+	{
+	public:
+		struct promise_type
+		{
+			ScriptRunner<NumericType>* Runner = nullptr;
+			std::exception_ptr Exception;
+
+			Script get_return_object() { return Script(std::coroutine_handle<promise_type>::from_promise(*this)); }
+			std::suspend_always initial_suspend() noexcept { return {}; }
+			std::suspend_always final_suspend() noexcept { return {}; }
+			void return_void() { }
+			void unhandled_exception() { Exception = std::current_exception(); }
+
+			static void* operator new(std::size_t size) { return ScriptFramePool::Allocate(size); }
+			static void operator delete(void* memory, std::size_t size) { ScriptFramePool::Release(memory, size); }
+		};
+
+		using Handle = std::coroutine_handle<promise_type>;
+
+		Script(Script&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+		Script(const Script&) = delete;
+		Script& operator=(const Script&) = delete;
+		~Script() { if (handle) handle.destroy(); }
+
+		// the caller takes over the coroutine
+		Handle Release()
+		{
+			Handle released = handle;
+			handle = nullptr;
+			return released;
+		}
+
+		// awaiting a script runs it like a subroutine
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(Handle caller) { caller.promise().Runner->Call(Release()); }
+		void await_resume() const noexcept { }
+
+	private:
+		Handle handle;
+		explicit Script(Handle handle) : handle(handle) { }
+	};
+
+	// Steps a script and its called scripts, the deadline of what the script waits for decides when it continues
+	template<typename NumericType> class ScriptRunner
+	{
+	private:
+		using Handle = typename Script<NumericType>::Handle;
+
+		enum class Waiting { Nothing, Time, Signal, Tween };
+
+		std::vector<Handle> stack; // the script and the scripts it called, innermost last
+		Waiting waiting = Waiting::Nothing;
+		NumericType deadline = 0;
+		const ScriptSignal* signal = nullptr;
+		std::size_t raised = 0;
+		NumericType tweenStart = 0;
+		void* tween = nullptr; // the awaiter in the coroutine frame
+		void(*tweenPlay)(void*, NumericType) = nullptr;
+
+	public:
+		NumericType Now = 0; // script time, the moment the awaited thing happened rather than the time of the frame
+
+		ScriptRunner() { }
+		ScriptRunner(const ScriptRunner&) = delete;
+		ScriptRunner& operator=(const ScriptRunner&) = delete;
+
+		// Destroy the scripts
+		void Stop()
+		{
+			for (auto handle : stack) handle.destroy();
+			stack.clear();
+			waiting = Waiting::Nothing;
+		}
+
+		void Start(Script<NumericType> script, NumericType now)
+		{
+			Stop();
+			Now = now;
+			Call(script.Release());
+		}
+
+		void Call(Handle handle)
+		{
+			handle.promise().Runner = this;
+			stack.push_back(handle);
+		}
+
+		void WaitTime(NumericType duration)
+		{
+			waiting = Waiting::Time;
+			deadline = Now + duration;
+		}
+
+		void WaitSignal(const ScriptSignal& target)
+		{
+			waiting = Waiting::Signal;
+			signal = &target;
+			raised = target.Raised;
+		}
+
+		void WaitTween(NumericType duration, void* awaiter, void(*play)(void*, NumericType))
+		{
+			waiting = Waiting::Tween;
+			tweenStart = Now;
+			deadline = Now + duration;
+			tween = awaiter;
+			tweenPlay = play;
+		}
+
+		bool Done() const { return stack.empty(); }
+
+		// Continue the scripts up to t, nothing runs while t is before what the script waits for
+		void Advance(NumericType t)
+		{
+			while (!stack.empty())
+			{
+				switch (waiting)
+				{
+				case Waiting::Time:
+					if (t < deadline) return;
+					Now = deadline;
+					break;
+				case Waiting::Signal:
+					if (signal->Raised == raised) return;
+					if (Now < t) Now = t;
+					break;
+				case Waiting::Tween:
+					if (t < deadline)
+					{
+						tweenPlay(tween, t - tweenStart);
+						return;
+					}
+					tweenPlay(tween, deadline - tweenStart);
+					Now = deadline;
+					break;
+				case Waiting::Nothing:
+					break;
+				}
+				waiting = Waiting::Nothing;
+				Handle top = stack.back();
+				top.resume();
+				if (!top.done()) continue;
+				// a finished script returns to the one that called it
+				std::exception_ptr exception = top.promise().Exception;
+				top.destroy();
+				stack.pop_back();
+				if (exception)
+				{
+					Stop();
+					std::rethrow_exception(exception);
+				}
+			}
+		}
+
+		// earliest moment the script may do something, t while it waits for a signal
+		NumericType NextActivity(NumericType t) const
+		{
+			if (stack.empty()) return IAnimation<NumericType>::Never();
+			if (waiting == Waiting::Time && t < deadline) return deadline;
+			return t;
+		}
+
+		~ScriptRunner() { Stop(); }
+	};
+
+	// co_await Wait(duration) continues the script duration after the moment it was continued last
+	template<typename Duration> struct ScriptWait
+	{
+		Duration Length;
+		bool await_ready() const noexcept { return false; }
+		template<typename Promise> void await_suspend(std::coroutine_handle<Promise> caller) { caller.promise().Runner->WaitTime(Length); }
+		void await_resume() const noexcept { }
+	};
+
+	template<typename Duration> ScriptWait<Duration> Wait(Duration duration) { return ScriptWait<Duration>{ duration }; }
+
+	// co_await Until(signal) continues on the first play after the signal is raised
+	struct ScriptUntil
+	{
+		const ScriptSignal& Signal;
+		bool await_ready() const noexcept { return false; }
+		template<typename Promise> void await_suspend(std::coroutine_handle<Promise> caller) { caller.promise().Runner->WaitSignal(Signal); }
+		void await_resume() const noexcept { }
+	};
+
+	inline ScriptUntil Until(const ScriptSignal& signal) { return ScriptUntil{ signal }; }
+
+	// co_await Tween(duration, action) calls action with the time since the tween started on every play,
+	// and with duration when it ends, then the script continues
+	template<typename Duration, typename Action> struct ScriptTween
+	{
+		Duration Length;
+		Action Play;
+
+		template<typename NumericType> static void PlayTween(void* awaiter, NumericType local) { static_cast<ScriptTween*>(awaiter)->Play(local); }
+
+		bool await_ready() const noexcept { return false; }
+		template<typename Promise> void await_suspend(std::coroutine_handle<Promise> caller)
+		{
+			auto runner = caller.promise().Runner;
+			using NumericType = typename std::remove_reference<decltype(runner->Now)>::type;
+			runner->WaitTween(NumericType(Length), this, &PlayTween<NumericType>);
+		}
+		void await_resume() const noexcept { }
+	};
+
+	template<typename Duration, typename Action> ScriptTween<Duration, typename std::decay<Action>::type> Tween(Duration duration, Action&& action)
+	{
+		return ScriptTween<Duration, typename std::decay<Action>::type>{ duration, std::forward<Action>(action) };
+	}
+
+	// Runs a script from local time 0, it is started again whenever (t0, t) crosses 0 going forward, like an event.
+	// Scripts only move forward, playing backward does nothing until the start is crossed again. A script that waits
+	// is not resumed before its deadline, a frame costs one comparison.
+	template<typename NumericType> class AnimationScript : public IAnimation<NumericType>
+	{
+	private:
+		ScriptRunner<NumericType> runner;
+		bool started = false;
+
+	public:
+		std::function<Script<NumericType>()> Make; // creates the coroutine, called on every start
+
+		AnimationScript(std::function<Script<NumericType>()> make) : Make(std::move(make)) { }
+
+		bool Done() const { return started && runner.Done(); }
+
+		// Drop the running script, the next play from 0 on starts it again
+		void Restart()
+		{
+			runner.Stop();
+			started = false;
+		}
+
+		void Play(NumericType t, NumericType t0) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(1);
+			if (t < 0) return;
+			if (!started || t0 < 0)
+			{
+				runner.Start(Make(), 0);
+				started = true;
+			}
+			ANIMATEANYTHING_PROFILE_TIME();
+			runner.Advance(t);
+		}
+
+		NumericType NextActivity(NumericType t) override
+		{
+			if (!started || t < 0) return t < 0 ? NumericType(0) : t;
+			return runner.NextActivity(t);
+		}
+
+		~AnimationScript() { }
+	};
+}
+
+#endif
@@ -0,0 +1,238 @@
+// AnimatAnything in C++
+// static animation graphs, the structure is known at compile time so the whole tree can be inlined
+
+#pragma once
+
+#include "AnimateAnything.h"
+
+#include <cstddef>
+#include <initializer_list>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace AnimateAnything
+{
+	// Base of all static nodes, static nodes have a non virtual Play and own their children by value
+	struct StaticNode { };
+
+	// Calls a lambda, with the time if the lambda takes it
+	template<typename NumericType, typename Function, bool TakesTime> class StaticAction : public StaticNode
+	{
+	public:
+		Function Action;
+		void Play(NumericType t, NumericType t0) { Action(t); }
+		StaticAction(Function action) : Action(std::move(action)) { }
+	};
+
+	template<typename NumericType, typename Function> class StaticAction<NumericType, Function, false> : public StaticNode
+	{
+	public:
+		Function Action;
+		void Play(NumericType t, NumericType t0) { Action(); }
+		StaticAction(Function action) : Action(std::move(action)) { }
+	};
+
+	// Plays a dynamic node from a static tree
+	template<typename NumericType> class StaticDynamic : public StaticNode
+	{
+	public:
+		IAnimation<NumericType>& Animation;
+		void Play(NumericType t, NumericType t0) { Animation.Play(t, t0); }
+		StaticDynamic(IAnimation<NumericType>& animation) : Animation(animation) { }
+	};
+
+	template<typename NumericType, typename Child> class StaticAfter : public StaticNode
+	{
+	public:
+		NumericType Start;
+		Child Animation;
+		void Play(NumericType t, NumericType t0) { if (Start <= t) Animation.Play(t - Start, t0 - Start); }
+		StaticAfter(NumericType start, Child animation) : Start(start), Animation(std::move(animation)) { }
+	};
+
+	template<typename NumericType, typename Child> class StaticBefore : public StaticNode
+	{
+	public:
+		NumericType Finish;
+		Child Animation;
+		void Play(NumericType t, NumericType t0) { if (t < Finish) Animation.Play(t - Finish, t0 - Finish); }
+		StaticBefore(NumericType finish, Child animation) : Finish(finish), Animation(std::move(animation)) { }
+	};
+
+	template<typename NumericType, typename Child> class StaticBetween : public StaticNode
+	{
+	public:
+		NumericType Start;
+		NumericType Finish;
+		Child Animation;
+		void Play(NumericType t, NumericType t0) { if (Start <= t && t < Finish) Animation.Play(t - Start, t0 - Start); }
+		StaticBetween(NumericType start, NumericType finish, Child animation) : Start(start), Finish(finish), Animation(std::move(animation)) { }
+	};
+
+	template<typename NumericType, typename Child> class StaticSeek : public StaticNode
+	{
+	public:
+		NumericType Skip;
+		Child Animation;
+		void Play(NumericType t, NumericType t0) { Animation.Play(t + Skip, t0 + Skip); }
+		StaticSeek(NumericType skip, Child animation) : Skip(skip), Animation(std::move(animation)) { }
+	};
+
+	template<typename NumericType, typename Child> class StaticEvent : public StaticNode
+	{
+	public:
+		NumericType Moment;
+		Child Animation;
+		void Play(NumericType t, NumericType t0) { if ((Moment <= t && t0 < Moment) || (t <= Moment && Moment < t0)) Animation.Play(t, t0); }
+		StaticEvent(NumericType moment, Child animation) : Moment(moment), Animation(std::move(animation)) { }
+	};
+
+	template<typename NumericType, typename Child> class StaticStretch : public StaticNode
+	{
+	public:
+		NumericType Scale;
+		Child Animation;
+		void Play(NumericType t, NumericType t0) { Animation.Play(t*Scale, t0*Scale); }
+		StaticStretch(NumericType scale, Child animation) : Scale(scale), Animation(std::move(animation)) { }
+	};
+
+	template<typename NumericType, typename Transform, typename Child> class StaticTimeTransform : public StaticNode
+	{
+	public:
+		Transform Function;
+		Child Animation;
+		void Play(NumericType t, NumericType t0) { Animation.Play(Function(t), Function(t0)); }
+		StaticTimeTransform(Transform transform, Child animation) : Function(std::move(transform)), Animation(std::move(animation)) { }
+	};
+
+	// Children are played in order, the loop is unrolled at compile time
+	template<typename NumericType, typename ...Children> class StaticParallel : public StaticNode
+	{
+	private:
+		template<std::size_t ...Index> void PlayAll(NumericType t, NumericType t0, std::index_sequence<Index...>)
+		{
+			(void)std::initializer_list<int>{ (std::get<Index>(Animations).Play(t, t0), 0)... };
+		}
+
+	public:
+		std::tuple<Children...> Animations;
+		void Play(NumericType t, NumericType t0) { PlayAll(t, t0, std::index_sequence_for<Children...>()); }
+		StaticParallel(Children... animations) : Animations(std::move(animations)...) { }
+	};
+
+	// Wraps a static tree so it can be used from dynamic nodes and containers
+	template<typename NumericType, typename Tree> class AnimationStatic : public IAnimation<NumericType>
+	{
+	public:
+		Tree Animation;
+		void Play(NumericType t, NumericType t0) override { ANIMATEANYTHING_PROFILE_PLAY(1); ANIMATEANYTHING_PROFILE_TIME(); Animation.Play(t, t0); }
+		AnimationStatic(Tree animation) : Animation(std::move(animation)) { }
+		~AnimationStatic() { }
+	};
+
+	// Builds static trees with the same calls as Container, the result is a value that owns the whole tree. Like in
+	// Container the finish of After, Before, Event, Stretch, Seek and TimeTransform is not used.
+	template<typename NumericType> class Static
+	{
+	private:
+
+		template<typename F, typename = void> struct TakesTime : std::false_type { };
+		template<typename F> struct TakesTime<F, decltype(void(std::declval<F&>()(std::declval<NumericType>())))> : std::true_type { };
+
+		template<typename Type> using Decay = typename std::decay<Type>::type;
+
+		template<typename Type> using IsDynamic = std::integral_constant<bool,
+			std::is_convertible<Type, IAnimation<NumericType>*>::value || std::is_base_of<IAnimation<NumericType>, Decay<Type>>::value>;
+
+		template<typename Type> using IsStatic = std::is_base_of<StaticNode, Decay<Type>>;
+
+		// static nodes are used as they are
+		template<typename Type> static Decay<Type> Node(Type&& node, std::true_type)
+		{
+			return std::forward<Type>(node);
+		}
+
+		// lambdas become actions
+		template<typename Type> static StaticAction<NumericType, Decay<Type>, TakesTime<Decay<Type>>::value> Node(Type&& action, std::false_type)
+		{
+			return StaticAction<NumericType, Decay<Type>, TakesTime<Decay<Type>>::value>(std::forward<Type>(action));
+		}
+
+	public:
+
+		// Parallel with 1 parameter, degenerate case, the node itself or an action for a lambda
+		template<typename Type, typename = typename std::enable_if<!IsDynamic<Type>::value>::type>
+		auto Parallel(Type&& node) -> decltype(Node(std::forward<Type>(node), IsStatic<Type>()))
+		{
+			return Node(std::forward<Type>(node), IsStatic<Type>());
+		}
+
+		// Dynamic nodes are played through their virtual Play
+		StaticDynamic<NumericType> Parallel(IAnimation<NumericType>* node) { return StaticDynamic<NumericType>(*node); }
+		StaticDynamic<NumericType> Parallel(IAnimation<NumericType>& node) { return StaticDynamic<NumericType>(node); }
+
+		// Parallel with 2 or more parameters
+		template<typename H1, typename H2, typename ...Tail> auto Parallel(H1&& first, H2&& second, Tail&&... rest)
+			-> StaticParallel<NumericType, decltype(Parallel(std::forward<H1>(first))), decltype(Parallel(std::forward<H2>(second))), decltype(Parallel(std::forward<Tail>(rest)))...>
+		{
+			using Result = StaticParallel<NumericType, decltype(Parallel(std::forward<H1>(first))), decltype(Parallel(std::forward<H2>(second))), decltype(Parallel(std::forward<Tail>(rest)))...>;
+			return Result(Parallel(std::forward<H1>(first)), Parallel(std::forward<H2>(second)), Parallel(std::forward<Tail>(rest))...);
+		}
+
+		// Animation between 2 points in time
+		template<typename ...Args> auto Between(NumericType start, NumericType finish, Args&&... args)
+			-> StaticBetween<NumericType, decltype(Parallel(std::forward<Args>(args)...))>
+		{
+			return { start, finish, Parallel(std::forward<Args>(args)...) };
+		}
+
+		// Animation after a specific point in time
+		template<typename ...Args> auto After(NumericType start, NumericType finish, Args&&... args)
+			-> StaticAfter<NumericType, decltype(Parallel(std::forward<Args>(args)...))>
+		{
+			return { start, Parallel(std::forward<Args>(args)...) };
+		}
+
+		// Animation before a specific point in time
+		template<typename ...Args> auto Before(NumericType moment, NumericType finish, Args&&... args)
+			-> StaticBefore<NumericType, decltype(Parallel(std::forward<Args>(args)...))>
+		{
+			return { moment, Parallel(std::forward<Args>(args)...) };
+		}
+
+		// Triggered once when the moment is crossed
+		template<typename ...Args> auto Event(NumericType moment, NumericType finish, Args&&... args)
+			-> StaticEvent<NumericType, decltype(Parallel(std::forward<Args>(args)...))>
+		{
+			return { moment, Parallel(std::forward<Args>(args)...) };
+		}
+
+		// Stretch
+		template<typename ...Args> auto Stretch(NumericType scale, NumericType finish, Args&&... args)
+			-> StaticStretch<NumericType, decltype(Parallel(std::forward<Args>(args)...))>
+		{
+			return { scale, Parallel(std::forward<Args>(args)...) };
+		}
+
+		// Skip part of animation
+		template<typename ...Args> auto Seek(NumericType skip, NumericType finish, Args&&... args)
+			-> StaticSeek<NumericType, decltype(Parallel(std::forward<Args>(args)...))>
+		{
+			return { skip, Parallel(std::forward<Args>(args)...) };
+		}
+
+		// Custom time transform, the transform is inlined as well
+		template<typename Transform, typename ...Args> auto TimeTransform(Transform transform, NumericType finish, Args&&... args)
+			-> StaticTimeTransform<NumericType, Transform, decltype(Parallel(std::forward<Args>(args)...))>
+		{
+			return { std::move(transform), Parallel(std::forward<Args>(args)...) };
+		}
+
+		// Wrap a static tree as an IAnimation
+		template<typename Tree> AnimationStatic<NumericType, Decay<Tree>> Wrap(Tree&& tree)
+		{
+			return AnimationStatic<NumericType, Decay<Tree>>(std::forward<Tree>(tree));
+		}
+	};
+}
@@ -0,0 +1,261 @@
+// AnimatAnything in C++
+// multithreaded playback, a work stealing thread pool and a parallel node that spreads its children over it
+
+#pragma once
+
+#include "AnimateAnything.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace AnimateAnything
+{
+	// Thread pool where every worker has its own queue and idle workers steal from the others
+	class AnimationThreadPool
+	{
+	private:
+
+		// what the tasks of one ParallelFor call share, the first exception a body throws is kept for the caller
+		struct Call
+		{
+			std::atomic<std::size_t> Remaining;
+			std::atomic<bool> Failed;
+			std::exception_ptr Error;
+		};
+
+		// a range of iterations of one ParallelFor call
+		struct Task
+		{
+			void(*Invoke)(void* body, std::size_t begin, std::size_t end);
+			void* Body;
+			std::size_t Begin;
+			std::size_t End;
+			Call* Owner;
+		};
+
+		struct Queue
+		{
+			std::mutex Lock;
+			std::deque<Task> Tasks;
+		};
+
+		std::vector<std::unique_ptr<Queue>> queues;
+		std::vector<std::thread> workers;
+		std::atomic<std::size_t> queued;
+		std::atomic<std::size_t> next; // round robin for distributing tasks
+		std::mutex sleepLock;
+		std::condition_variable wake;
+		bool stopping = false;
+
+		template<typename Body> static void InvokeBody(void* body, std::size_t begin, std::size_t end)
+		{
+			(*static_cast<Body*>(body))(begin, end);
+		}
+
+		// owner takes from the back of its queue, thieves from the front
+		bool TryPop(std::size_t queue, bool steal, Task& task)
+		{
+			Queue& q = *queues[queue];
+			std::unique_lock<std::mutex> lock(q.Lock, std::defer_lock);
+			if (steal) { if (!lock.try_lock()) return false; }
+			else lock.lock();
+			if (q.Tasks.empty()) return false;
+			if (steal) { task = q.Tasks.front(); q.Tasks.pop_front(); }
+			else { task = q.Tasks.back(); q.Tasks.pop_back(); }
+			queued--;
+			return true;
+		}
+
+		// own queue first, then the others starting from the neighbour
+		bool TryTake(std::size_t home, Task& task)
+		{
+			if (home < queues.size() && TryPop(home, false, task)) return true;
+			for (std::size_t i = 1; i <= queues.size(); i++)
+			{
+				if (TryPop((home + i) % queues.size(), true, task)) return true;
+			}
+			return false;
+		}
+
+		// a task is always counted as done, a throwing body must not leave its caller waiting
+		static void Run(const Task& task)
+		{
+			try
+			{
+				task.Invoke(task.Body, task.Begin, task.End);
+			}
+			catch (...)
+			{
+				if (!task.Owner->Failed.exchange(true)) task.Owner->Error = std::current_exception();
+			}
+			task.Owner->Remaining.fetch_sub(1, std::memory_order_acq_rel);
+		}
+
+		void Work(std::size_t index)
+		{
+			Task task;
+			for (;;)
+			{
+				if (TryTake(index, task))
+				{
+					Run(task);
+					continue;
+				}
+				std::unique_lock<std::mutex> lock(sleepLock);
+				wake.wait(lock, [this] { return stopping || queued.load() != 0; });
+				if (stopping && queued.load() == 0) return;
+			}
+		}
+
+	public:
+
+		// Start the workers, the thread calling ParallelFor helps as well
+		AnimationThreadPool(std::size_t threads = std::thread::hardware_concurrency()) : queued(0), next(0)
+		{
+			if (threads == 0) threads = 1;
+			for (std::size_t i = 0; i < threads; i++) queues.emplace_back(new Queue());
+			for (std::size_t i = 0; i < threads; i++) workers.emplace_back([this, i] { Work(i); });
+		}
+
+		AnimationThreadPool(const AnimationThreadPool&) = delete;
+		AnimationThreadPool& operator=(const AnimationThreadPool&) = delete;
+
+		std::size_t ThreadCount() const { return workers.size(); }
+
+		// Call body(begin, end) for chunks of at most grain iterations covering [0, count), returns when all are done.
+		// If a chunk throws, the other chunks still run and the first exception is rethrown here.
+		template<typename Body> void ParallelFor(std::size_t count, std::size_t grain, Body body)
+		{
+			if (grain == 0) grain = 1;
+			if (count <= grain)
+			{
+				if (count) body(0, count);
+				return;
+			}
+			Call call;
+			call.Remaining = (count + grain - 1) / grain;
+			call.Failed = false;
+			std::size_t queue = next++ % queues.size();
+			for (std::size_t begin = 0; begin < count; begin += grain)
+			{
+				Task task{ &InvokeBody<Body>, &body, begin, std::min(count, begin + grain), &call };
+				Queue& q = *queues[queue];
+				{
+					std::lock_guard<std::mutex> lock(q.Lock);
+					queued++;
+					q.Tasks.push_back(task);
+				}
+				queue = (queue + 1) % queues.size();
+			}
+			{
+				std::lock_guard<std::mutex> lock(sleepLock);
+			}
+			wake.notify_all();
+
+			// help until our tasks are done, this also keeps nested calls from deadlocking
+			Task task;
+			while (call.Remaining.load(std::memory_order_acquire) != 0)
+			{
+				if (TryTake(queues.size(), task)) Run(task);
+				else std::this_thread::yield();
+			}
+			if (call.Error) std::rethrow_exception(call.Error);
+		}
+
+		~AnimationThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(sleepLock);
+				stopping = true;
+			}
+			wake.notify_all();
+			for (auto& worker : workers) worker.join();
+		}
+	};
+
+	// Parallel node that plays its children on a thread pool, children must not share state unless it is thread safe.
+	// Fan-outs below two grains stay on the calling thread. A child added with AddOrdered runs on the calling thread at
+	// its position: the children added before it have finished and the ones added after it have not started.
+	template<typename NumericType> class AnimationParallelConcurrent : public AnimationParallel<NumericType>
+	{
+	private:
+		std::vector<std::size_t> ordered; // indices in Animations of the order sensitive children, ascending
+
+		// children [begin, end) on the pool, or here when there are too few
+		template<typename Here, typename Pooled> void Spread(std::size_t begin, std::size_t end, Here& here, Pooled& pooled)
+		{
+			if (end - begin < Grain * 2)
+			{
+				here(begin, end);
+				return;
+			}
+			Pool.ParallelFor(end - begin, Grain, [&](std::size_t first, std::size_t last) { pooled(begin + first, begin + last); });
+		}
+
+		// the runs of children between ordered ones spread over the pool, the ordered ones play here in between
+		template<typename Here, typename Pooled> void PlayChildren(Here here, Pooled pooled)
+		{
+			std::size_t count = this->Animations.size(), begin = 0;
+			for (std::size_t index : ordered)
+			{
+				if (index >= count) break;
+				Spread(begin, index, here, pooled);
+				here(index, index + 1);
+				begin = index + 1;
+			}
+			Spread(begin, count, here, pooled);
+		}
+
+	public:
+		AnimationThreadPool& Pool;
+		std::size_t Grain; // children per task
+
+		void Play(NumericType t, NumericType t0) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(1);
+			auto& animations = this->Animations;
+			auto play = [&](std::size_t begin, std::size_t end)
+			{
+				for (std::size_t i = begin; i < end; i++) animations[i]->Play(t, t0);
+			};
+			PlayChildren(play, play);
+		}
+
+		void PlayBatch(const TimeSamples<NumericType>& samples) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(samples.Count);
+			auto& animations = this->Animations;
+			PlayChildren([&](std::size_t begin, std::size_t end)
+			{
+				for (std::size_t i = begin; i < end; i++) animations[i]->PlayBatch(samples);
+			}, [&](std::size_t begin, std::size_t end)
+			{
+				// scratch memory is per thread, the caller's scratch may be in use on another thread
+				static thread_local BatchScratch<NumericType> scratch;
+				TimeSamples<NumericType> local = samples;
+				local.Scratch = &scratch;
+				for (std::size_t i = begin; i < end; i++) animations[i]->PlayBatch(local);
+			});
+		}
+
+		// Add a child that plays on the calling thread, in order with the children around it
+		void AddOrdered(IAnimation<NumericType>& item)
+		{
+			ordered.push_back(this->Animations.size());
+			this->Add(item);
+		}
+
+		void AddOrdered(IAnimation<NumericType>* item) { AddOrdered(*item); }
+
+		AnimationParallelConcurrent(AnimationThreadPool& pool, std::size_t grain = 64) : Pool(pool), Grain(grain ? grain : 1) { }
+		~AnimationParallelConcurrent() { }
+	};
+}
@@ -0,0 +1,70 @@
+// AnimatAnything in C++
+// tick time, graphs played with a 64 bit count of ticks at a fixed rate instead of seconds in a double
+
+#pragma once
+
+#include "AnimateAnything.h"
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+namespace AnimateAnything
+{
+	// Time as a whole number of ticks. Every node takes it as NumericType, Container<Ticks> builds graphs of it:
+	// ranges and events compare integers, Seek adds exactly and StretchRatio scales by fractions without rounding drift.
+	using Ticks = std::int64_t;
+
+	// Ticks per second of a tick time base
+	struct TickRate
+	{
+		Ticks PerSecond;
+
+		// 705600000 per second divides evenly into frames at 24, 25, 30, 48, 50, 60, 90, 100 and 120 fps, the 1000 / 1001
+		// rates and 8 to 192 kHz audio samples. Ticks last 414 years at this rate.
+		static TickRate Flicks() { return TickRate{ 705600000 }; }
+		static TickRate Milliseconds() { return TickRate{ 1000 }; }
+		static TickRate Microseconds() { return TickRate{ 1000000 }; }
+
+		// nearest tick of a time in seconds
+		Ticks FromSeconds(double seconds) const { return Ticks(std::llround(seconds * double(PerSecond))); }
+
+		double Seconds(Ticks ticks) const { return double(ticks / PerSecond) + double(ticks % PerSecond) / double(PerSecond); }
+
+		// first tick of a frame at numerator / denominator frames per second, 60000 / 1001 for 59.94 fps
+		Ticks Frame(std::int64_t frame, std::int64_t numerator, std::int64_t denominator = 1) const
+		{
+			return MultiplyRatio<Ticks>(frame, PerSecond * denominator, numerator);
+		}
+	};
+
+	// Frame times at a fixed frame rate in ticks. Every time is computed from the frame number, so there is no
+	// sum of frame durations that drifts: frame 60000 at 59.94 fps is 1001 seconds, exactly, after a week as well.
+	class FrameClock
+	{
+	public:
+		TickRate Rate;
+		std::int64_t Numerator; // frames per second as a fraction
+		std::int64_t Denominator;
+		std::int64_t Frame = 0;
+
+		FrameClock(TickRate rate, std::int64_t numerator, std::int64_t denominator = 1) : Rate(rate), Numerator(numerator), Denominator(denominator) { }
+
+		Ticks Time() const { return Rate.Frame(Frame, Numerator, Denominator); }
+
+		// Go to the frame that contains ticks
+		void Seek(Ticks ticks)
+		{
+			Frame = MultiplyRatio<Ticks>(ticks, Numerator, Rate.PerSecond * Denominator);
+			if (Rate.Frame(Frame + 1, Numerator, Denominator) <= ticks) Frame++; // frame times are rounded down
+		}
+
+		// Advance by frames and play animation from the previous frame time to the new one
+		void Play(IAnimation<Ticks>& animation, std::int64_t frames = 1)
+		{
+			Ticks t0 = Time();
+			Frame += frames;
+			animation.Play(Time(), t0);
+		}
+	};
+}
@@ -0,0 +1,360 @@
+// AnimatAnything in C++
+// compiled timeline, flattens a finished animation graph into segments indexed by absolute time
+
+#pragma once
+
+#include "AnimateAnything.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+namespace AnimateAnything
+{
+	// One step on the path from the root to a segment target, replayed exactly like the node it came from
+	template<typename NumericType> struct TimelineStep
+	{
+		enum StepKind : unsigned char
+		{
+			AtLeast, // Value <= t, from Between and After
+			Below, // t < Value, from Between and Before
+			Subtract, // t - Value, from Between, After and Before
+			Add, // t + Value, from Seek
+			Multiply, // t * Value, from Stretch
+			Crossing, // t0 -> t crosses Value, from Event
+		};
+
+		StepKind Kind;
+		NumericType Value;
+
+		// Apply the step to the local times, returns false if the original node would not play its child
+		bool Apply(NumericType& t, NumericType& t0) const
+		{
+			switch (Kind)
+			{
+			case AtLeast: return Value <= t;
+			case Below: return t < Value;
+			case Subtract: t = t - Value; t0 = t0 - Value; return true;
+			case Add: t = t + Value; t0 = t0 + Value; return true;
+			case Multiply: t = t*Value; t0 = t0*Value; return true;
+			case Crossing: return (Value <= t && t0 < Value) || (t <= Value && Value < t0);
+			}
+			return false;
+		}
+	};
+
+	// node as Type when it is exactly that class, nullptr otherwise. Subclasses may play differently or keep children
+	// elsewhere, tools that look into nodes keep them as they are.
+	template<typename Type, typename NumericType> Type* ExactNode(IAnimation<NumericType>& node)
+	{
+		return typeid(node) == typeid(Type) ? static_cast<Type*>(&node) : nullptr;
+	}
+
+	// Append the steps of a node that only checks and transforms time and return its child, nullptr for other nodes.
+	// Ranges with enter, exit or change suppression depend on the previous play and are not steps.
+	template<typename NumericType> IAnimation<NumericType>* AppendSteps(IAnimation<NumericType>& node, std::vector<TimelineStep<NumericType>>& path)
+	{
+		using Step = TimelineStep<NumericType>;
+		auto range = dynamic_cast<AnimationRange<NumericType>*>(&node);
+		if (range && range->HasOptions()) return nullptr;
+		if (auto between = ExactNode<AnimationBetween<NumericType>>(node))
+		{
+			path.push_back(Step{ Step::AtLeast, between->Start });
+			path.push_back(Step{ Step::Below, between->Finish });
+			path.push_back(Step{ Step::Subtract, between->Start });
+			return &between->Animation;
+		}
+		if (auto after = ExactNode<AnimationAfter<NumericType>>(node))
+		{
+			path.push_back(Step{ Step::AtLeast, after->Start });
+			path.push_back(Step{ Step::Subtract, after->Start });
+			return &after->Animation;
+		}
+		if (auto before = ExactNode<AnimationBefore<NumericType>>(node))
+		{
+			path.push_back(Step{ Step::Below, before->Finish });
+			path.push_back(Step{ Step::Subtract, before->Finish });
+			return &before->Animation;
+		}
+		if (auto seek = ExactNode<AnimationSeek<NumericType>>(node))
+		{
+			path.push_back(Step{ Step::Add, seek->Skip });
+			return &seek->Animation;
+		}
+		if (auto stretch = ExactNode<AnimationStretch<NumericType>>(node))
+		{
+			path.push_back(Step{ Step::Multiply, stretch->Scale });
+			return &stretch->Animation;
+		}
+		if (auto event = ExactNode<AnimationEvent<NumericType>>(node))
+		{
+			path.push_back(Step{ Step::Crossing, event->Moment });
+			return &event->Animation;
+		}
+		return nullptr;
+	}
+
+	// A leaf of the compiled timeline: the node to play and the absolute range where it can be active
+	template<typename NumericType> struct TimelineSegment
+	{
+		NumericType Start; // conservative lower bound of absolute t
+		NumericType Finish; // conservative upper bound of absolute t, inclusive
+		std::size_t FirstStep; // steps replayed before playing the target
+		std::size_t StepCount;
+		IAnimation<NumericType>* Target; // action or opaque subtree
+		bool IsEvent; // Start and Finish bound the event moment, the segment plays when (t0, t) covers it
+	};
+
+	// Flat form of an animation graph, Play only visits the segments whose interval is stabbed by t.
+	// The source graph must outlive the timeline, its leaves and opaque nodes are played in place.
+	template<typename NumericType> class AnimationTimeline : public IAnimation<NumericType>
+	{
+	private:
+
+		using Step = TimelineStep<NumericType>;
+		using Segment = TimelineSegment<NumericType>;
+		using Bound = long double;
+
+		// augmented interval tree stored implicitly over an array sorted by Start
+		struct IntervalIndex
+		{
+			std::vector<NumericType> Starts;
+			std::vector<NumericType> Finishes;
+			std::vector<NumericType> MaxFinish; // max Finish in the subtree rooted at this element
+			std::vector<std::size_t> Segments;
+
+			void Build(const std::vector<Segment>& segments, const std::vector<std::size_t>& items)
+			{
+				Segments = items;
+				std::stable_sort(Segments.begin(), Segments.end(), [&](std::size_t a, std::size_t b) { return segments[a].Start < segments[b].Start; });
+				Starts.resize(Segments.size());
+				Finishes.resize(Segments.size());
+				MaxFinish.resize(Segments.size());
+				for (std::size_t i = 0; i < Segments.size(); i++)
+				{
+					Starts[i] = segments[Segments[i]].Start;
+					Finishes[i] = segments[Segments[i]].Finish;
+				}
+				if (!Segments.empty()) Augment(0, Segments.size());
+			}
+
+			NumericType Augment(std::size_t begin, std::size_t end)
+			{
+				std::size_t mid = begin + (end - begin) / 2;
+				NumericType result = Finishes[mid];
+				if (begin < mid) result = std::max(result, Augment(begin, mid));
+				if (mid + 1 < end) result = std::max(result, Augment(mid + 1, end));
+				MaxFinish[mid] = result;
+				return result;
+			}
+
+			// report every interval that overlaps [from, to]
+			void Query(NumericType from, NumericType to, std::vector<std::size_t>& out) const
+			{
+				if (!Segments.empty()) Query(0, Segments.size(), from, to, out);
+			}
+
+			void Query(std::size_t begin, std::size_t end, NumericType from, NumericType to, std::vector<std::size_t>& out) const
+			{
+				std::size_t mid = begin + (end - begin) / 2;
+				if (MaxFinish[mid] < from) return;
+				if (begin < mid) Query(begin, mid, from, to, out);
+				if (to < Starts[mid]) return;
+				if (from <= Finishes[mid]) out.push_back(Segments[mid]);
+				if (mid + 1 < end) Query(mid + 1, end, from, to, out);
+			}
+		};
+
+		// affine map from absolute time to the local time at the current depth of the walk
+		struct Affine
+		{
+			Bound Scale;
+			Bound Offset;
+			Bound Magnitude; // largest constant seen so far, in absolute units, used for rounding margins
+			Bound Lo;
+			Bound Hi;
+			Bound EventLo;
+			Bound EventHi;
+			bool IsEvent;
+		};
+
+		std::vector<Step> steps;
+		std::vector<Segment> segments;
+		std::vector<std::size_t> always; // segments that are candidates at any time
+		IntervalIndex ranges;
+		IntervalIndex events;
+		std::vector<std::size_t> active; // scratch, reused between Play calls
+		IAnimation<NumericType>& root;
+
+		static Bound Infinity() { return std::numeric_limits<Bound>::infinity(); }
+
+		static NumericType ToNumeric(Bound value)
+		{
+			const Bound lowest = static_cast<Bound>(std::numeric_limits<NumericType>::lowest());
+			const Bound highest = static_cast<Bound>(std::numeric_limits<NumericType>::max());
+			if (std::numeric_limits<NumericType>::has_infinity)
+			{
+				if (value < lowest) return -std::numeric_limits<NumericType>::infinity();
+				if (value > highest) return std::numeric_limits<NumericType>::infinity();
+			}
+			if (value < lowest) return std::numeric_limits<NumericType>::lowest();
+			if (value > highest) return std::numeric_limits<NumericType>::max();
+			return static_cast<NumericType>(value);
+		}
+
+		// rounding margin for a bound derived from the steps so far
+		Bound Margin(const Affine& map, Bound value, std::size_t depth) const
+		{
+			Bound epsilon = std::is_floating_point<NumericType>::value ? static_cast<Bound>(std::numeric_limits<NumericType>::epsilon()) : 0;
+			return (std::fabs(value) + map.Magnitude) * epsilon * 16 * (depth + 1) + (std::is_integral<NumericType>::value ? 1 : 0);
+		}
+
+		// absolute time where local time reaches value, false if the map is not invertible
+		bool Invert(const Affine& map, Bound value, Bound& result) const
+		{
+			if (map.Scale == 0 || !std::isfinite(map.Scale) || !std::isfinite(map.Offset)) return false;
+			result = (value - map.Offset) / map.Scale;
+			return !std::isnan(result);
+		}
+
+		void Constrain(Affine& map, const Step& step, std::size_t depth)
+		{
+			Bound value = static_cast<Bound>(step.Value);
+			Bound moment;
+			switch (step.Kind)
+			{
+			case Step::AtLeast:
+			case Step::Below:
+				if (!Invert(map, value, moment)) break;
+				// Below on a reversed map is a lower bound and AtLeast an upper bound
+				if ((step.Kind == Step::AtLeast) == (map.Scale > 0)) map.Lo = std::max(map.Lo, moment - Margin(map, moment, depth));
+				else map.Hi = std::min(map.Hi, moment + Margin(map, moment, depth));
+				break;
+			case Step::Subtract:
+				map.Offset -= value;
+				break;
+			case Step::Add:
+				map.Offset += value;
+				break;
+			case Step::Multiply:
+				map.Scale *= value;
+				map.Offset *= value;
+				break;
+			case Step::Crossing:
+				if (map.IsEvent) break; // nested events, the outer window is already a necessary condition
+				map.IsEvent = true;
+				if (!Invert(map, value, moment)) break;
+				map.EventLo = moment - Margin(map, moment, depth);
+				map.EventHi = moment + Margin(map, moment, depth);
+				break;
+			}
+			if (map.Scale != 0 && std::isfinite(map.Scale))
+			{
+				map.Magnitude = std::max(map.Magnitude, (std::fabs(value) + std::fabs(map.Offset)) / std::fabs(map.Scale));
+			}
+		}
+
+		void Walk(IAnimation<NumericType>& node, std::vector<Step>& path)
+		{
+			std::size_t mark = path.size();
+			if (auto parallel = ExactNode<AnimationParallel<NumericType>>(node))
+			{
+				for (auto child : parallel->Animations) Walk(*child, path);
+				return;
+			}
+			if (IAnimation<NumericType>* child = AppendSteps(node, path))
+			{
+				Walk(*child, path);
+				path.resize(mark);
+			}
+			else
+			{
+				AddSegment(node, path);
+			}
+		}
+
+		void AddSegment(IAnimation<NumericType>& target, const std::vector<Step>& path)
+		{
+			Affine map{ 1, 0, 0, -Infinity(), Infinity(), -Infinity(), Infinity(), false };
+			for (std::size_t i = 0; i < path.size(); i++) Constrain(map, path[i], i);
+			if (map.Hi < map.Lo) return; // the range checks on the path exclude each other
+
+			Segment segment;
+			segment.FirstStep = steps.size();
+			segment.StepCount = path.size();
+			segment.Target = &target;
+			segment.IsEvent = map.IsEvent;
+			segment.Start = ToNumeric(map.IsEvent ? map.EventLo : map.Lo);
+			segment.Finish = ToNumeric(map.IsEvent ? map.EventHi : map.Hi);
+			steps.insert(steps.end(), path.begin(), path.end());
+			segments.push_back(segment);
+		}
+
+		// replay the steps of a candidate segment exactly like the tree walk would
+		void PlaySegment(const Segment& segment, NumericType t, NumericType t0) const
+		{
+			const Step* step = steps.data() + segment.FirstStep;
+			for (std::size_t i = 0; i < segment.StepCount; i++)
+			{
+				if (!step[i].Apply(t, t0)) return;
+			}
+			segment.Target->Play(t, t0);
+		}
+
+	public:
+
+		// Compile the graph under root, the graph should not change while the timeline is used
+		AnimationTimeline(IAnimation<NumericType>& root) : root(root)
+		{
+			std::vector<Step> path;
+			Walk(root, path);
+			std::vector<std::size_t> ranged, timed;
+			for (std::size_t i = 0; i < segments.size(); i++)
+			{
+				const Segment& segment = segments[i];
+				bool unbounded = !(std::numeric_limits<NumericType>::lowest() < segment.Start) && !(segment.Finish < std::numeric_limits<NumericType>::max());
+				if (unbounded) always.push_back(i);
+				else if (segment.IsEvent) timed.push_back(i);
+				else ranged.push_back(i);
+			}
+			ranges.Build(segments, ranged);
+			events.Build(segments, timed);
+		}
+
+		// Collect the segments that may play for moment t with previous moment t0, in graph order
+		void Query(NumericType t, NumericType t0, std::vector<std::size_t>& out) const
+		{
+			out.clear();
+			out.insert(out.end(), always.begin(), always.end());
+			ranges.Query(t, t, out);
+			events.Query(std::min(t, t0), std::max(t, t0), out);
+			std::sort(out.begin(), out.end());
+		}
+
+		void Play(NumericType t, NumericType t0) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(1);
+			Query(t, t0, active);
+			for (auto index : active) PlaySegment(segments[index], t, t0);
+		}
+
+		NumericType NextActivity(NumericType t) override { return root.NextActivity(t); }
+
+		// the source graph, its leaves are the nodes the timeline plays
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override { visit(root); }
+
+		// Play a single segment, its target plays only if the original graph would play it for (t, t0)
+		void PlaySegment(std::size_t index, NumericType t, NumericType t0) const { PlaySegment(segments[index], t, t0); }
+
+		const std::vector<TimelineSegment<NumericType>>& Segments() const { return segments; }
+
+		// the steps of all segments, a segment replays StepCount of them from FirstStep
+		const std::vector<TimelineStep<NumericType>>& Steps() const { return steps; }
+
+		~AnimationTimeline() { }
+	};
+}
@@ -0,0 +1,468 @@
+// AnimatAnything in C++
+// tick traces, the Play calls a root received are recorded into a compact binary trace and replayed under timing
+
+#pragma once
+
+#include "AnimateAnything.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace AnimateAnything
+{
+	// One Play of the recorded root. A batch is stored as its samples, the first of them holds the sample count.
+	template<typename NumericType> struct TraceTick
+	{
+		NumericType T;
+		NumericType T0;
+		std::uint32_t Batch; // samples of the batch starting here, 0 for a single Play and the rest of a batch
+		std::uint32_t Calls; // invocations recorded while it played, a batch records them all on its first sample
+	};
+
+	// What a recorder captures besides the ticks. Invocations are only seen in builds with ANIMATEANYTHING_PROFILE.
+	enum class TraceLevel { Ticks, Leaves, Nodes };
+
+	// Start of a binary trace, the leaf flags and the ticks follow. Times are stored in the byte order and NumericType
+	// of the machine that recorded them, like binary timelines.
+	struct TraceHeader
+	{
+		char Magic[4]; // "AATR"
+		std::uint32_t Version;
+		std::uint32_t ByteOrder; // 0x01020304 as written
+		std::uint32_t NumericSize; // sizeof(NumericType)
+		std::uint32_t NumericKind; // 0 signed integer, 1 unsigned integer, 2 floating point
+		std::uint32_t NodeCount;
+		std::uint64_t TickCount;
+		std::uint64_t CallCount;
+	};
+
+	// Ticks and invocations of a recording. Nodes are numbered by the recorder, leaves are the nodes without children.
+	// In the binary form every tick is a flag byte and its time, T0 is left out when it is the previous T and the
+	// counts and node numbers are variable length, a frame by frame session takes about 10 bytes per tick.
+	template<typename NumericType> class AnimationTrace
+	{
+	private:
+		enum Flags : std::uint8_t { HasT0 = 1, HasBatch = 2, HasCalls = 4 };
+
+		static std::uint32_t Kind() { return std::is_floating_point<NumericType>::value ? 2 : (std::is_signed<NumericType>::value ? 0 : 1); }
+
+		static void PutVarint(std::vector<char>& out, std::uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				out.push_back(char((value & 0x7f) | 0x80));
+				value >>= 7;
+			}
+			out.push_back(char(value));
+		}
+
+		static bool GetVarint(const char*& data, const char* end, std::uint64_t& value)
+		{
+			value = 0;
+			for (unsigned shift = 0; data < end && shift < 64; shift += 7)
+			{
+				std::uint8_t byte = std::uint8_t(*data++);
+				value |= std::uint64_t(byte & 0x7f) << shift;
+				if (!(byte & 0x80)) return true;
+			}
+			return false;
+		}
+
+		static void PutTime(std::vector<char>& out, NumericType t)
+		{
+			const char* bytes = reinterpret_cast<const char*>(&t);
+			out.insert(out.end(), bytes, bytes + sizeof(NumericType));
+		}
+
+		bool Fail(const std::string& message)
+		{
+			Error = message;
+			Clear();
+			return false;
+		}
+
+	public:
+		std::vector<TraceTick<NumericType>> Ticks;
+		std::vector<std::uint32_t> Calls; // node numbers in the order they played, tick after tick
+		std::vector<std::uint8_t> Leaves; // 1 for the numbers of nodes without children
+		std::string Error; // why the last Read, Load or Save failed
+
+		void Clear()
+		{
+			Ticks.clear();
+			Calls.clear();
+			Leaves.clear();
+		}
+
+		// Numbers of the leaves that played, in order, the actions a graph ran
+		std::vector<std::uint32_t> LeafCalls() const
+		{
+			std::vector<std::uint32_t> leaves;
+			for (auto call : Calls) if (call < Leaves.size() && Leaves[call]) leaves.push_back(call);
+			return leaves;
+		}
+
+		// Serialize into out
+		void Write(std::vector<char>& out) const
+		{
+			TraceHeader header;
+			std::memcpy(header.Magic, "AATR", 4);
+			header.Version = 1;
+			header.ByteOrder = 0x01020304;
+			header.NumericSize = sizeof(NumericType);
+			header.NumericKind = Kind();
+			header.NodeCount = std::uint32_t(Leaves.size());
+			header.TickCount = Ticks.size();
+			header.CallCount = Calls.size();
+			out.assign(reinterpret_cast<const char*>(&header), reinterpret_cast<const char*>(&header) + sizeof(header));
+			out.insert(out.end(), Leaves.begin(), Leaves.end());
+
+			std::size_t call = 0;
+			NumericType previous = NumericType();
+			for (const auto& tick : Ticks)
+			{
+				bool hasT0 = !(tick.T0 == previous && std::signbit(tick.T0) == std::signbit(previous)); // exact, -0 is kept
+				out.push_back(char((hasT0 ? HasT0 : 0) | (tick.Batch ? HasBatch : 0) | (tick.Calls ? HasCalls : 0)));
+				PutTime(out, tick.T);
+				if (hasT0) PutTime(out, tick.T0);
+				if (tick.Batch) PutVarint(out, tick.Batch);
+				if (tick.Calls)
+				{
+					PutVarint(out, tick.Calls);
+					for (std::uint32_t i = 0; i < tick.Calls; i++) PutVarint(out, Calls[call++]);
+				}
+				previous = tick.T;
+			}
+		}
+
+		// Read what Write produced, false with Error and an empty trace if it is not a valid trace
+		bool Read(const char* data, std::size_t size)
+		{
+			Clear();
+			Error.clear();
+			TraceHeader header;
+			if (!data || size < sizeof(header)) return Fail("no trace");
+			std::memcpy(&header, data, sizeof(header));
+			if (std::memcmp(header.Magic, "AATR", 4) != 0) return Fail("not a trace");
+			if (header.Version != 1) return Fail("unknown version");
+			if (header.ByteOrder != 0x01020304 || header.NumericSize != sizeof(NumericType) || header.NumericKind != Kind()) return Fail("recorded with another NumericType or byte order");
+			const char* end = data + size;
+			data += sizeof(header);
+			if (std::size_t(end - data) < header.NodeCount) return Fail("truncated");
+			Leaves.assign(data, data + header.NodeCount);
+			data += header.NodeCount;
+
+			// every tick takes at least a flag and a time, every call at least a byte
+			std::size_t left = std::size_t(end - data);
+			if (header.TickCount > left / (1 + sizeof(NumericType)) || header.CallCount > left) return Fail("truncated");
+			Ticks.reserve(std::size_t(header.TickCount));
+			Calls.reserve(std::size_t(header.CallCount));
+			NumericType previous = NumericType();
+			for (std::uint64_t i = 0; i < header.TickCount; i++)
+			{
+				if (end - data < std::ptrdiff_t(1 + sizeof(NumericType))) return Fail("truncated");
+				std::uint8_t flags = std::uint8_t(*data++);
+				TraceTick<NumericType> tick = { NumericType(), previous, 0, 0 };
+				std::memcpy(&tick.T, data, sizeof(NumericType));
+				data += sizeof(NumericType);
+				if (flags & HasT0)
+				{
+					if (end - data < std::ptrdiff_t(sizeof(NumericType))) return Fail("truncated");
+					std::memcpy(&tick.T0, data, sizeof(NumericType));
+					data += sizeof(NumericType);
+				}
+				std::uint64_t value = 0;
+				if (flags & HasBatch)
+				{
+					if (!GetVarint(data, end, value) || value > 0xffffffffu) return Fail("bad batch");
+					tick.Batch = std::uint32_t(value);
+				}
+				if (flags & HasCalls)
+				{
+					if (!GetVarint(data, end, value) || value > header.CallCount - Calls.size()) return Fail("bad calls");
+					tick.Calls = std::uint32_t(value);
+					for (std::uint32_t c = 0; c < tick.Calls; c++)
+					{
+						if (!GetVarint(data, end, value) || value >= header.NodeCount) return Fail("bad node");
+						Calls.push_back(std::uint32_t(value));
+					}
+				}
+				Ticks.push_back(tick);
+				previous = tick.T;
+			}
+			if (Calls.size() != header.CallCount) return Fail("bad calls");
+			return true;
+		}
+
+		bool Save(const std::string& path)
+		{
+			std::vector<char> data;
+			Write(data);
+			FILE* file = std::fopen(path.c_str(), "wb");
+			if (!file)
+			{
+				Error = "cannot open " + path;
+				return false;
+			}
+			bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+			ok = std::fclose(file) == 0 && ok;
+			if (!ok) Error = "cannot write " + path;
+			return ok;
+		}
+
+		bool Load(const std::string& path)
+		{
+			FILE* file = std::fopen(path.c_str(), "rb");
+			if (!file) return Fail("cannot open " + path);
+			std::vector<char> data;
+			char block[4096];
+			std::size_t read;
+			while ((read = std::fread(block, 1, sizeof(block), file)) > 0) data.insert(data.end(), block, block + read);
+			std::fclose(file);
+			return Read(data.data(), data.size());
+		}
+	};
+
+	// Wraps a root and records every Play and PlayBatch it receives into Trace, then plays the root as usual.
+	// With a Level above Ticks, in builds with ANIMATEANYTHING_PROFILE, the nodes that play on the calling thread are
+	// recorded too. Children that AnimationParallelConcurrent hands to its workers are not seen, the ones it plays
+	// on the calling thread are. Nodes are numbered depth first from the root, nodes found while playing are numbered
+	// when they first play. Give a reference graph to number its nodes first, so a rebuilt or optimized graph that
+	// shares actions with it records the same numbers for them and the leaf calls of the two traces can be compared.
+	template<typename NumericType> class AnimationRecorder : public IAnimation<NumericType>
+	{
+	private:
+		std::unordered_map<const IAnimation<NumericType>*, std::uint32_t> numbers;
+
+#ifdef ANIMATEANYTHING_PROFILE
+		struct Sink : TraceSink<NumericType>
+		{
+			AnimationRecorder& Recorder;
+			Sink(AnimationRecorder& recorder) : Recorder(recorder) { }
+			void Played(IAnimation<NumericType>& node) override { Recorder.Called(node); }
+		};
+		Sink sink;
+#endif
+
+		std::uint32_t Number(IAnimation<NumericType>& node)
+		{
+			auto found = numbers.find(&node);
+			if (found != numbers.end()) return found->second;
+			std::uint32_t number = std::uint32_t(Trace.Leaves.size());
+			numbers.emplace(&node, number);
+			bool leaf = true;
+			node.ForEachChild([&leaf](IAnimation<NumericType>&) { leaf = false; });
+			Trace.Leaves.push_back(leaf ? 1 : 0);
+			return number;
+		}
+
+		void NumberAll(IAnimation<NumericType>& node)
+		{
+			if (numbers.count(&node)) return;
+			Number(node);
+			node.ForEachChild([this](IAnimation<NumericType>& child) { NumberAll(child); });
+		}
+
+		void Called(IAnimation<NumericType>& node)
+		{
+			std::uint32_t number = Number(node);
+			if (Level == TraceLevel::Nodes || Trace.Leaves[number]) Trace.Calls.push_back(number);
+		}
+
+		template<typename Body> std::uint32_t Capture(const Body& body)
+		{
+			std::size_t calls = Trace.Calls.size();
+#ifdef ANIMATEANYTHING_PROFILE
+			if (Level != TraceLevel::Ticks)
+			{
+				auto& current = TraceSink<NumericType>::Current();
+				auto outer = current;
+				current = &sink;
+				body();
+				current = outer;
+				return std::uint32_t(Trace.Calls.size() - calls);
+			}
+#endif
+			body();
+			return std::uint32_t(Trace.Calls.size() - calls);
+		}
+
+	public:
+		IAnimation<NumericType>& Animation;
+		AnimationTrace<NumericType> Trace;
+		TraceLevel Level = TraceLevel::Ticks;
+		bool Recording = true; // false plays through without recording
+
+		AnimationRecorder(IAnimation<NumericType>& animation) :
+#ifdef ANIMATEANYTHING_PROFILE
+			sink(*this),
+#endif
+			Animation(animation) { Restart(); }
+		AnimationRecorder(IAnimation<NumericType>* animation) : AnimationRecorder(*animation) { }
+		AnimationRecorder(IAnimation<NumericType>& animation, IAnimation<NumericType>& reference) : AnimationRecorder(animation) { Restart(&reference); }
+		AnimationRecorder(IAnimation<NumericType>* animation, IAnimation<NumericType>* reference) : AnimationRecorder(*animation) { Restart(reference); }
+
+		// Drop the recording and number the nodes again, those of reference first
+		void Restart(IAnimation<NumericType>* reference = nullptr)
+		{
+			Trace.Clear();
+			numbers.clear();
+			if (reference) NumberAll(*reference);
+			NumberAll(Animation);
+		}
+
+		void Play(NumericType t, NumericType t0) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(1);
+			if (!Recording)
+			{
+				Animation.Play(t, t0);
+				return;
+			}
+			std::uint32_t calls = Capture([&]() { Animation.Play(t, t0); });
+			Trace.Ticks.push_back(TraceTick<NumericType>{ t, t0, 0, calls });
+		}
+
+		void PlayBatch(const TimeSamples<NumericType>& samples) override
+		{
+			ANIMATEANYTHING_PROFILE_PLAY(samples.Count);
+			if (!Recording || samples.Count == 0)
+			{
+				Animation.PlayBatch(samples);
+				return;
+			}
+			std::uint32_t calls = Capture([&]() { Animation.PlayBatch(samples); });
+			Trace.Ticks.push_back(TraceTick<NumericType>{ samples.T[0], samples.T0[0], std::uint32_t(samples.Count), calls });
+			for (std::size_t i = 1; i < samples.Count; i++) Trace.Ticks.push_back(TraceTick<NumericType>{ samples.T[i], samples.T0[i], 0, 0 });
+		}
+
+		NumericType NextActivity(NumericType t) override { return Animation.NextActivity(t); }
+		void ForEachChild(const std::function<void(IAnimation<NumericType>&)>& visit) override { visit(Animation); }
+		~AnimationRecorder() { }
+	};
+
+	// Timing of one replay, the worst tick is only known when ticks are timed one by one
+	struct ReplayStats
+	{
+		std::size_t Ticks = 0; // Play and PlayBatch calls made
+		std::uint64_t Nanoseconds = 0;
+		std::uint64_t WorstNanoseconds = 0;
+		std::size_t WorstTick = 0; // index into the trace ticks
+	};
+
+	// Feeds the ticks of a trace to a root the way they were recorded, batches as batches
+	template<typename NumericType> class TraceReplay
+	{
+	private:
+		TimeBatch<NumericType> batch;
+
+	public:
+		bool TimeTicks = false; // time every tick into TickNanoseconds, this adds two clock reads per tick
+		std::vector<std::uint64_t> TickNanoseconds; // per Play or batch, in the order they were replayed
+
+		ReplayStats Play(IAnimation<NumericType>& root, const AnimationTrace<NumericType>& trace)
+		{
+			using Clock = std::chrono::steady_clock;
+			ReplayStats stats;
+			TickNanoseconds.clear();
+			const auto* ticks = trace.Ticks.data();
+			std::size_t count = trace.Ticks.size();
+			auto start = Clock::now();
+			auto previous = start;
+			for (std::size_t i = 0; i < count; )
+			{
+				std::size_t first = i;
+				std::size_t samples = ticks[i].Batch;
+				if (samples == 0)
+				{
+					root.Play(ticks[i].T, ticks[i].T0);
+					i++;
+				}
+				else
+				{
+					if (samples > count - i) samples = count - i;
+					batch.T.resize(samples);
+					batch.T0.resize(samples);
+					for (std::size_t s = 0; s < samples; s++)
+					{
+						batch.T[s] = ticks[i + s].T;
+						batch.T0[s] = ticks[i + s].T0;
+					}
+					batch.Play(root);
+					i += samples;
+				}
+				stats.Ticks++;
+				if (TimeTicks)
+				{
+					auto now = Clock::now();
+					std::uint64_t elapsed = std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now - previous).count());
+					TickNanoseconds.push_back(elapsed);
+					if (elapsed > stats.WorstNanoseconds)
+					{
+						stats.WorstNanoseconds = elapsed;
+						stats.WorstTick = first;
+					}
+					previous = now;
+				}
+			}
+			stats.Nanoseconds = std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+			return stats;
+		}
+	};
+
+	// Replaces the callables of the action nodes under a root with ones that do nothing and puts them back when it
+	// is destroyed. Replaying with stubs times the graph alone, without what the actions do.
+	template<typename NumericType> class ActionStubs
+	{
+	private:
+		std::vector<std::pair<AnimationActionVoid<NumericType>*, InlineFunction<void(void)>>> voids;
+		std::vector<std::pair<AnimationActionTime<NumericType>*, InlineFunction<void(NumericType)>>> times;
+		std::vector<std::pair<AnimationActionBatch<NumericType>*, InlineFunction<void(const NumericType*, const std::size_t*, std::size_t)>>> batches;
+		std::vector<std::pair<AnimationActionInstance<NumericType>*, InlineFunction<void(std::size_t, NumericType)>>> instances;
+		std::unordered_map<const IAnimation<NumericType>*, bool> seen;
+
+		template<typename Node, typename Saved, typename Nothing> static bool Stub(IAnimation<NumericType>& node, Saved& saved, Nothing nothing)
+		{
+			auto action = dynamic_cast<Node*>(&node);
+			if (!action) return false;
+			saved.emplace_back(action, std::move(action->Action));
+			action->Action = nothing;
+			return true;
+		}
+
+		void Walk(IAnimation<NumericType>& node)
+		{
+			if (!seen.emplace(&node, true).second) return;
+			Stub<AnimationActionVoid<NumericType>>(node, voids, []() {}) ||
+				Stub<AnimationActionTime<NumericType>>(node, times, [](NumericType) {}) ||
+				Stub<AnimationActionBatch<NumericType>>(node, batches, [](const NumericType*, const std::size_t*, std::size_t) {}) ||
+				Stub<AnimationActionInstance<NumericType>>(node, instances, [](std::size_t, NumericType) {});
+			node.ForEachChild([this](IAnimation<NumericType>& child) { Walk(child); });
+		}
+
+	public:
+		ActionStubs(IAnimation<NumericType>& root) { Walk(root); }
+		ActionStubs(const ActionStubs&) = delete;
+		ActionStubs& operator=(const ActionStubs&) = delete;
+
+		std::size_t Count() const { return voids.size() + times.size() + batches.size() + instances.size(); }
+
+		~ActionStubs()
+		{
+			for (auto& saved : voids) saved.first->Action = std::move(saved.second);
+			for (auto& saved : times) saved.first->Action = std::move(saved.second);
+			for (auto& saved : batches) saved.first->Action = std::move(saved.second);
+			for (auto& saved : instances) saved.first->Action = std::move(saved.second);
+		}
+	};
+}
@@ -0,0 +1,241 @@
+// AnimatAnything in C++
+// keyframe tracks, key times and values are kept in separate arrays and sampled with a cached cursor
+
+#pragma once
+
+#include "AnimateAnything.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+
+namespace AnimateAnything
+{
+	enum class TrackInterpolation { Step, Linear, Cubic };
+
+	// Interpolation kernels over n values, plain loops over contiguous arrays so the compiler can vectorize them
+	template<typename ValueType> struct TrackKernels
+	{
+		static void Step(const ValueType* a, ValueType* out, std::size_t n)
+		{
+			for (std::size_t i = 0; i < n; i++) out[i] = a[i];
+		}
+
+		static void Linear(const ValueType* a, const ValueType* b, ValueType u, ValueType* out, std::size_t n)
+		{
+			for (std::size_t i = 0; i < n; i++) out[i] = a[i] + (b[i] - a[i]) * u;
+		}
+
+		// cubic hermite between b and c, the tangents come from the neighbours a and d like a Catmull-Rom spline,
+		// wa and wd weight the neighbours for uneven key spacing
+		static void Cubic(const ValueType* a, const ValueType* b, const ValueType* c, const ValueType* d, ValueType u, ValueType wa, ValueType wd, ValueType* out, std::size_t n)
+		{
+			ValueType u2 = u * u, u3 = u2 * u;
+			ValueType h00 = 2 * u3 - 3 * u2 + 1, h10 = u3 - 2 * u2 + u, h01 = -2 * u3 + 3 * u2, h11 = u3 - u2;
+			for (std::size_t i = 0; i < n; i++)
+			{
+				ValueType m1 = (c[i] - a[i]) * wa;
+				ValueType m2 = (d[i] - b[i]) * wd;
+				out[i] = h00 * b[i] + h10 * m1 + h01 * c[i] + h11 * m2;
+			}
+		}
+	};
+
+	// Keys sorted by time with a cursor on the current segment, monotonic playback moves the cursor by at most a key
+	template<typename NumericType> class TrackCursor
+	{
+	public:
+		std::size_t Key = 0; // Times[Key] <= t < Times[Key + 1] after Find, clamped to the first and last key
+
+		// returns the segment of t and the position in it, u is 0 before the first and 1 after the last key
+		template<typename ValueType> std::size_t Find(const std::vector<NumericType>& times, NumericType t, ValueType& u)
+		{
+			std::size_t count = times.size();
+			if (count < 2 || !(times[0] < t))
+			{
+				u = 0;
+				return Key = 0;
+			}
+			if (!(t < times[count - 1]))
+			{
+				u = 1;
+				return Key = count - 2;
+			}
+			if (Key + 1 >= count || t < times[Key] || !(t < times[Key + 1]))
+			{
+				if (Key + 2 < count && times[Key + 1] <= t && t < times[Key + 2]) Key++;
+				else Key = std::size_t(std::upper_bound(times.begin(), times.end(), t) - times.begin()) - 1;
+			}
+			u = ValueType(t - times[Key]) / ValueType(times[Key + 1] - times[Key]); // integral times divide as values
+			return Key;
+		}
+	};
+
+	// Keyframe track of Components values per key, quaternion tracks keep the shortest path and stay normalized.
+	// Play writes the value at local time t to Target, or to Value when there is no target.
+	template<typename NumericType, std::size_t Components, bool Rotation = false, typename ValueType = float> class AnimationTrack : public IAnimation<NumericType>
+	{
+	private:
+
+		TrackCursor<NumericType> cursor;
+
+		// neighbour key for the tangents, quaternions are flipped to the same hemisphere as reference
+		const ValueType* Neighbour(std::size_t key, const ValueType* reference, ValueType* flipped) const
+		{
+			const ValueType* value = &Values[key * Components];
+			if (!Rotation) return value;
+			ValueType dot = 0;
+			for (std::size_t i = 0; i < Components; i++) dot += value[i] * reference[i];
+			if (dot >= 0) return value;
+			for (std::size_t i = 0; i < Components; i++) flipped[i] = -value[i];
+			return flipped;
+		}
+
+		static void Normalize(ValueType* value)
+		{
+			ValueType length = 0;
+			for (std::size_t i = 0; i < Components; i++) length += value[i] * value[i];
+			if (!(length > 0)) return;
+			length = ValueType(1) / std::sqrt(length);
+			for (std::size_t i = 0; i < Components; i++) value[i] *= length;
+		}
+
+	public:
+		std::vector<NumericType> Times;
+		std::vector<ValueType> Values; // Components values per key
+		TrackInterpolation Interpolation;
+		ValueType* Target;
+		ValueType Value[Components];
+
+		// Append a key, keys must be added in time order
+		void AddKey(NumericType time, std::initializer_list<ValueType> value)
+		{
+			AddKey(time, value.begin());
+		}
+
+		void AddKey(NumericType time, const ValueType* value)
+		{
+			Times.push_back(time);
+			Values.insert(Values.end(), value, value + Components);
+		}
+
+		std::size_t KeyCount() const { return Times.size(); }
+
+		// Value of the track at time t
+		void Sample(NumericType t, ValueType* out)
+		{
+			if (Times.empty()) return;
+			ValueType u;
+			std::size_t key = cursor.Find(Times, t, u);
+			const ValueType* a = &Values[key * Components];
+			if (Times.size() < 2 || Interpolation == TrackInterpolation::Step)
+			{
+				TrackKernels<ValueType>::Step(u < 1 ? a : a + Components, out, Components);
+				return;
+			}
+			ValueType flipped[3][Components];
+			const ValueType* b = Neighbour(key + 1, a, flipped[0]);
+			if (Interpolation == TrackInterpolation::Linear)
+			{
+				TrackKernels<ValueType>::Linear(a, b, u, out, Components);
+			}
+			else
+			{
+				std::size_t first = key > 0 ? key - 1 : key, last = key + 2 < Times.size() ? key + 2 : key + 1;
+				const ValueType* before = first == key ? a : Neighbour(first, a, flipped[1]);
+				const ValueType* after = last == key + 1 ? b : Neighbour(last, b, flipped[2]);
+				ValueType span = ValueType(Times[key + 1] - Times[key]);
+				ValueType wa = span / ValueType(Times[key + 1] - Times[first]);
+				ValueType wd = span / ValueType(Times[last] - Times[key]);
+				TrackKernels<ValueType>::Cubic(before, a, b, after, u, wa, wd, out, Components);
+			}
+			if (Rotation) Normalize(out);
+		}
+
+		void Play(NumericType t, NumericType t0) override { ANIMATEANYTHING_PROFILE_PLAY(1); ANIMATEANYTHING_PROFILE_TIME(); Sample(t, Target ? Target : Value); }
+
+		// the value is constant before the first and after the last key
+		NumericType NextActivity(NumericType t) override
+		{
+			if (Times.empty() || !(t < Times.back())) return this->Never();
+			return t < Times.front() ? Times.front() : t;
+		}
+
+		AnimationTrack(TrackInterpolation interpolation = TrackInterpolation::Linear, ValueType* target = nullptr) : Interpolation(interpolation), Target(target)
+		{
+			std::fill(Value, Value + Components, ValueType(0));
+		}
+		~AnimationTrack() { }
+	};
+
+	template<typename NumericType> using AnimationTrackFloat = AnimationTrack<NumericType, 1>;
+	template<typename NumericType> using AnimationTrackVec2 = AnimationTrack<NumericType, 2>;
+	template<typename NumericType> using AnimationTrackVec3 = AnimationTrack<NumericType, 3>;
+	template<typename NumericType> using AnimationTrackVec4 = AnimationTrack<NumericType, 4>;
+	template<typename NumericType> using AnimationTrackQuaternion = AnimationTrack<NumericType, 4, true>;
+
+	// Many scalar tracks sharing their key times, one key search per frame and the kernels run across all channels.
+	// Values are stored key by key, Channels values per key, Play writes Channels contiguous values to Target or Output.
+	template<typename NumericType, typename ValueType = float> class AnimationTrackGroup : public IAnimation<NumericType>
+	{
+	private:
+		TrackCursor<NumericType> cursor;
+
+	public:
+		std::size_t Channels;
+		std::vector<NumericType> Times;
+		std::vector<ValueType> Values; // Channels values per key
+		TrackInterpolation Interpolation;
+		ValueType* Target;
+		std::vector<ValueType> Output;
+
+		// Append a key with a value for every channel, keys must be added in time order
+		void AddKey(NumericType time, const ValueType* values)
+		{
+			Times.push_back(time);
+			Values.insert(Values.end(), values, values + Channels);
+		}
+
+		void AddKey(NumericType time, std::initializer_list<ValueType> values) { AddKey(time, values.begin()); }
+
+		std::size_t KeyCount() const { return Times.size(); }
+
+		void Sample(NumericType t, ValueType* out)
+		{
+			if (Times.empty()) return;
+			ValueType u;
+			std::size_t key = cursor.Find(Times, t, u);
+			const ValueType* a = &Values[key * Channels];
+			if (Times.size() < 2 || Interpolation == TrackInterpolation::Step)
+			{
+				TrackKernels<ValueType>::Step(u < 1 ? a : a + Channels, out, Channels);
+				return;
+			}
+			const ValueType* b = a + Channels;
+			if (Interpolation == TrackInterpolation::Linear)
+			{
+				TrackKernels<ValueType>::Linear(a, b, u, out, Channels);
+				return;
+			}
+			std::size_t first = key > 0 ? key - 1 : key, last = key + 2 < Times.size() ? key + 2 : key + 1;
+			ValueType span = ValueType(Times[key + 1] - Times[key]);
+			ValueType wa = span / ValueType(Times[key + 1] - Times[first]);
+			ValueType wd = span / ValueType(Times[last] - Times[key]);
+			TrackKernels<ValueType>::Cubic(&Values[first * Channels], a, b, &Values[last * Channels], u, wa, wd, out, Channels);
+		}
+
+		void Play(NumericType t, NumericType t0) override { ANIMATEANYTHING_PROFILE_PLAY(1); ANIMATEANYTHING_PROFILE_TIME(); Sample(t, Target ? Target : Output.data()); }
+
+		NumericType NextActivity(NumericType t) override
+		{
+			if (Times.empty() || !(t < Times.back())) return this->Never();
+			return t < Times.front() ? Times.front() : t;
+		}
+
+		AnimationTrackGroup(std::size_t channels, TrackInterpolation interpolation = TrackInterpolation::Linear, ValueType* target = nullptr) :
+			Channels(channels), Interpolation(interpolation), Target(target), Output(channels) { }
+		~AnimationTrackGroup() { }
+	};
+}
@@ -0,0 +1,638 @@
+// Benchmarks for the hot paths of the node graph
+// usage: BenchmarkAnimateAnything [--quick] [--filter text] [--json path]
+// every case reports the median time per operation over a few repeats, --json writes the results for tracking regressions
+
+#include "../AnimateAnything/AnimateAnything.h"
+#include "../AnimateAnything/AnimationBake.h"
+#include "../AnimateAnything/AnimationBinary.h"
+#include "../AnimateAnything/AnimationChannels.h"
+#include "../AnimateAnything/AnimationCheckpoints.h"
+#include "../AnimateAnything/AnimationHandoff.h"
+#include "../AnimateAnything/AnimationOptimizer.h"
+#include "../AnimateAnything/AnimationEventQueue.h"
+#include "../AnimateAnything/AnimationStatic.h"
+#include "../AnimateAnything/AnimationThreads.h"
+#include "../AnimateAnything/AnimationTicks.h"
+#include "../AnimateAnything/AnimationTimeline.h"
+#include "../AnimateAnything/AnimationTrace.h"
+#include "../AnimateAnything/AnimationTracks.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace AnimateAnything;
+
+namespace
+{
+	struct Result
+	{
+		std::string Name;
+		double NanosecondsPerOperation;
+		std::size_t Operations; // operations per measured run
+		std::size_t Iterations;
+	};
+
+	struct Options
+	{
+		bool Quick = false;
+		std::string Filter;
+		std::string Json;
+	};
+
+	Options options;
+	std::vector<Result> results;
+
+	// results of the benchmarked code go here so the compiler cannot drop it
+	volatile double sink = 0;
+
+	using Clock = std::chrono::steady_clock;
+
+	bool Selected(const std::string& name)
+	{
+		return options.Filter.empty() || name.find(options.Filter) != std::string::npos;
+	}
+
+	// Time body, which performs operations operations per call. The call count grows until a run takes long enough,
+	// the median of the repeats is reported.
+	template<typename Body> void Measure(const std::string& name, std::size_t operations, Body body)
+	{
+		if (!Selected(name)) return;
+		double minimum = options.Quick ? 1e-3 : 50e-3;
+		int repeats = options.Quick ? 1 : 5;
+		std::size_t iterations = 1;
+		auto run = [&](std::size_t count)
+		{
+			Clock::time_point start = Clock::now();
+			for (std::size_t i = 0; i < count; i++) body();
+			return std::chrono::duration<double>(Clock::now() - start).count();
+		};
+		for (double elapsed = run(iterations); elapsed < minimum; elapsed = run(iterations))
+		{
+			iterations = elapsed > 0 ? std::max(iterations * 2, std::size_t(iterations * minimum * 1.2 / elapsed)) : iterations * 10;
+		}
+		std::vector<double> samples;
+		for (int i = 0; i < repeats; i++) samples.push_back(run(iterations));
+		std::sort(samples.begin(), samples.end());
+		double median = samples[samples.size() / 2];
+		double ns = median * 1e9 / (double(iterations) * operations);
+		results.push_back(Result{ name, ns, operations, iterations });
+		std::printf("%-48s %12.2f ns/op %10zu iterations\n", name.c_str(), ns, iterations);
+		std::fflush(stdout);
+	}
+
+	// Deep chains of Between, Seek and Stretch over one action
+	void BenchmarkChains()
+	{
+		for (std::size_t depth : { 8, 64 })
+		{
+			Container<double> aa;
+			IAnimation<double>* node = aa.Parallel([](double t) { sink = t; });
+			for (std::size_t i = 0; i < depth; i++)
+			{
+				switch (i % 3)
+				{
+				case 0: node = aa.Between(0, 1e12, node); break;
+				case 1: node = aa.Seek(0.5, 0, node); break;
+				default: node = aa.Stretch(1.0, 0, node); break;
+				}
+			}
+			double t = 0;
+			Measure("chain/depth" + std::to_string(depth), 1, [&] { node->Play(t + 0.01, t); t += 0.01; });
+
+			// folded by the optimizer, the repeated ranges always pass and the stretches do nothing
+			Container<double> folded;
+			AnimationOptimizer<double> optimizer(folded);
+			auto chain = optimizer.Optimize(node);
+			Measure("chain/depth" + std::to_string(depth) + "/optimized", 1, [&] { chain->Play(t + 0.01, t); t += 0.01; });
+
+			// the same chain played as one batch of samples
+			TimeBatch<double> batch(256);
+			for (std::size_t i = 0; i < 256; i++) batch.T[i] = batch.T0[i] = i * 0.01;
+			Measure("chain/depth" + std::to_string(depth) + "/batch", 256, [&] { batch.Play(*node); });
+		}
+	}
+
+	// Parallel with many children, a quarter of them active at any moment
+	void BenchmarkFanOut()
+	{
+		for (std::size_t width : { 16, 1024 })
+		{
+			Container<double> aa;
+			auto root = aa.Make<AnimationParallel<double>>();
+			for (std::size_t i = 0; i < width; i++)
+			{
+				double start = double(i % 4);
+				root->Add(aa.Between(start, start + 1, [](double t) { sink = t; }));
+			}
+			double t = 0;
+			Measure("fanout/width" + std::to_string(width), width, [&] { root->Play(std::fmod(t, 4.0), t); t += 0.01; });
+		}
+	}
+
+	// Many events, few fire per frame: the plain tree visits every node, the timeline and the queue only the due ones
+	void BenchmarkEvents()
+	{
+		const std::size_t count = 4096;
+		Container<double> aa;
+		auto root = aa.Make<AnimationParallel<double>>();
+		for (std::size_t i = 0; i < count; i++)
+		{
+			root->Add(aa.Event(double(i), 0, [](double t) { sink = t; }));
+		}
+		AnimationTimeline<double> timeline(*root);
+		AnimationEventQueue<double> queue(*root);
+
+		auto frames = [&](IAnimation<double>& animation)
+		{
+			double t = 0;
+			return [&animation, t]() mutable
+			{
+				double t1 = t + 0.25;
+				if (t1 > 4096) t1 = 0;
+				animation.Play(t1, t);
+				t = t1;
+			};
+		};
+		Measure("events/4096/tree", 1, frames(*root));
+		Measure("events/4096/timeline", 1, frames(timeline));
+		Measure("events/4096/queue", 1, frames(queue));
+	}
+
+	// Building and destroying a graph of a thousand nodes
+	void BenchmarkContainer()
+	{
+		auto build = [](ContainerStorage storage)
+		{
+			return [storage]()
+			{
+				Container<double> aa(storage);
+				auto root = aa.Make<AnimationParallel<double>>();
+				for (int i = 0; i < 250; i++)
+				{
+					root->Add(aa.Between(i, i + 1, aa.Seek(0.5, 0, aa.Stretch(2.0, 0, [](double t) { sink = t; }))));
+				}
+				sink = double(aa.Stats().Nodes);
+			};
+		};
+		Measure("container/build1000/heap", 1000, build(ContainerStorage::Heap));
+		Measure("container/build1000/arena", 1000, build(ContainerStorage::Arena));
+
+		// reusing one arena keeps its blocks
+		Container<double> reused(ContainerStorage::Arena);
+		Measure("container/build1000/arena-reset", 1000, [&]
+		{
+			reused.Reset();
+			auto root = reused.Make<AnimationParallel<double>>();
+			for (int i = 0; i < 250; i++)
+			{
+				root->Add(reused.Between(i, i + 1, reused.Seek(0.5, 0, reused.Stretch(2.0, 0, [](double t) { sink = t; }))));
+			}
+		});
+
+		// per request graphs: lambdas with a few captures and builder parallels, nothing reaches the heap
+		Measure("container/build1000/captures", 1000, [&]
+		{
+			reused.Reset();
+			auto root = reused.Make<AnimationParallel<double>>();
+			for (int i = 0; i < 200; i++)
+			{
+				double from = i, to = i + 1, scale = 0.5;
+				root->Add(reused.Between(from, to,
+					[from, to, scale](double t) { sink = from + (to - from) * t * scale; },
+					reused.Seek(0.5, 0, [from, scale](double t) { sink = t * scale + from; }, [scale]() { sink = scale; })));
+			}
+		});
+	}
+
+	// Cost of calling the action: std::function behind a virtual node, a static tree and a direct call
+	void BenchmarkActions()
+	{
+		Container<double> aa;
+		auto dynamic = aa.Between(0, 1e9, [](double t) { sink = t; });
+		Static<double> st;
+		auto fixed = st.Between(0.0, 1e9, [](double t) { sink = t; });
+		auto direct = [](double t) { sink = t; };
+		double t = 0;
+		Measure("action/function", 1, [&] { dynamic->Play(t, t); t += 1; });
+		Measure("action/static", 1, [&] { fixed.Play(t, t); t += 1; });
+		Measure("action/direct", 1, [&] { if (0 <= t && t < 1e9) direct(t); t += 1; });
+	}
+
+	// One graph for many instances, evaluated as one batch
+	void BenchmarkInstances()
+	{
+		const std::size_t count = 1024;
+		Container<double> aa;
+		auto node = aa.Parallel(
+			aa.Between(0, 5, aa.Seek(1, 0, [](std::size_t instance, double t) { sink = t; })),
+			aa.After(5, 0, aa.Stretch(0.5, 0, [](std::size_t instance, double t) { sink = t; }))
+		);
+		AnimationInstances<double> instances;
+		for (std::size_t i = 0; i < count; i++) instances.Add(i * 0.01, 1 + (i % 3) * 0.5);
+		double t = 0;
+		Measure("instances/1024", count, [&] { instances.Play(*node, t + 0.01, t); t += 0.01; });
+	}
+
+	// Wide fan-out played on 1, 2 and 4 threads, every child does a little work
+	void BenchmarkThreads()
+	{
+		const std::size_t width = 4096;
+		for (std::size_t threads : { 1, 2, 4 })
+		{
+			AnimationThreadPool pool(threads);
+			Container<double> aa;
+			auto root = aa.Make<AnimationParallelConcurrent<double>>(pool, 64);
+			std::vector<double> values(width);
+			for (std::size_t i = 0; i < width; i++)
+			{
+				double* value = &values[i];
+				root->Add(aa.Parallel([value](double t) { double v = t; for (int k = 0; k < 16; k++) v = std::sin(v) + t; *value = v; }));
+			}
+			double t = 0;
+			Measure("threads/4096/" + std::to_string(threads), width, [&] { root->Play(t + 0.01, t); t += 0.01; });
+		}
+	}
+
+	// Built-in easing against the same curve as a std::function transform and a baked table
+	void BenchmarkEasing()
+	{
+		Container<double> aa;
+		auto eased = aa.Ease<EaseCubic>(1.0, [](double t) { sink = t; });
+		auto cubic = [](double t) { t = t < 0 ? 0 : t > 1 ? 1 : t; return t * t * t; };
+		auto transformed = aa.TimeTransform(cubic, 0, [](double t) { sink = t; });
+		auto baked = aa.TimeTable(cubic, 0, 1, 64, 1e-4, [](double t) { sink = t; });
+		double t = 0;
+		Measure("ease/curve", 1, [&] { eased->Play(t, t); t = t < 1 ? t + 1e-3 : 0; });
+		Measure("ease/function", 1, [&] { transformed->Play(t, t); t = t < 1 ? t + 1e-3 : 0; });
+		Measure("ease/table", 1, [&] { baked->Play(t, t); t = t < 1 ? t + 1e-3 : 0; });
+	}
+
+	// 64 scalar channels as separate tracks and as one group sharing key times
+	void BenchmarkTracks()
+	{
+		const std::size_t channels = 64, keys = 32;
+		std::vector<std::unique_ptr<AnimationTrackFloat<double>>> tracks;
+		AnimationParallel<double> separate;
+		AnimationTrackGroup<double> group(channels, TrackInterpolation::Cubic);
+		std::vector<float> values(channels);
+		for (std::size_t c = 0; c < channels; c++)
+		{
+			tracks.emplace_back(new AnimationTrackFloat<double>(TrackInterpolation::Cubic));
+			separate.Add(*tracks.back());
+		}
+		for (std::size_t k = 0; k < keys; k++)
+		{
+			for (std::size_t c = 0; c < channels; c++)
+			{
+				values[c] = float((k * 7 + c * 3) % 11);
+				tracks[c]->AddKey(double(k), { values[c] });
+			}
+			group.AddKey(double(k), values.data());
+		}
+		double t = 0;
+		Measure("tracks/64/separate", channels, [&] { separate.Play(t, t); t = t < keys ? t + 0.01 : 0; });
+		Measure("tracks/64/group", channels, [&] { group.Play(t, t); t = t < keys ? t + 0.01 : 0; });
+	}
+
+	// Looping child with an event, every frame plays the wrap logic
+	void BenchmarkLoop()
+	{
+		Container<double> aa;
+		auto loop = aa.Loop(1.0, 0, aa.Parallel(
+			aa.Event(0.5, 0, []() { sink = sink + 1; }),
+			aa.Parallel([](double t) { sink = t; })
+		));
+		double t = 0;
+		Measure("loop", 1, [&] { loop->Play(t + 0.1, t); t += 0.1; });
+	}
+
+	// Leaves writing to scattered heap values through lambdas against writing into a channel buffer and resolving it
+	void BenchmarkChannels()
+	{
+		const std::size_t count = 4096;
+		Container<double> aa;
+		std::vector<std::unique_ptr<float>> scattered;
+		auto lambdas = aa.Make<AnimationParallel<double>>();
+		for (std::size_t i = 0; i < count; i++)
+		{
+			scattered.emplace_back(new float(0));
+			float* target = scattered.back().get();
+			lambdas->Add(aa.Parallel([target](double t) { *target = float(t); }));
+		}
+		ChannelBuffer<float> buffer(count);
+		auto channels = aa.Make<AnimationParallel<double>>();
+		for (std::size_t i = 0; i < count; i++) channels->Add(aa.Make<AnimationChannel<double>>(buffer, i));
+		double t = 0;
+		Measure("channels/4096/lambda", count, [&] { lambdas->Play(t, t); t += 0.01; });
+		Measure("channels/4096/buffer", count, [&] { buffer.Clear(); channels->Play(t, t); buffer.Resolve(); t += 0.01; });
+		Measure("channels/4096/resolve", count, [&] { buffer.Resolve(); });
+	}
+
+	// Random seeks in a ten minute show played at 60 frames per second: replaying from the start against checkpoints
+	void BenchmarkCheckpoints()
+	{
+		const double length = 600, step = 1.0 / 64;
+		Container<double> aa;
+		int beats = 0;
+		auto show = aa.Parallel(aa.Loop(1, 0, aa.Event(0.5, 0, [&]() { beats++; })), aa.Between(0, length, [](double t) { sink = t; }));
+		double target = 0;
+		auto next = [&] { target = std::fmod(target + 377.25, length); };
+		Measure("checkpoints/seek/replay", 1, [&]
+		{
+			beats = 0;
+			double t0 = 0;
+			for (double t = step; t < target; t += step)
+			{
+				show->Play(t, t0);
+				t0 = t;
+			}
+			show->Play(target, t0);
+			next();
+		});
+		AnimationCheckpoints<double> checkpoints(10, 0, show);
+		checkpoints.Track(beats);
+		checkpoints.Preroll(length, step);
+		Measure("checkpoints/seek/10s", 1, [&] { checkpoints.Seek(target, step); next(); });
+		sink = double(beats);
+	}
+
+	// A deep subtree of transforms over 64 channels played live against its baked samples
+	void BenchmarkBake()
+	{
+		const std::size_t count = 64, depth = 8;
+		ChannelBuffer<float> buffer(count);
+		Container<double> aa;
+		auto subtree = aa.Make<AnimationParallel<double>>();
+		for (std::size_t i = 0; i < count; i++)
+		{
+			IAnimation<double>* node = aa.Make<AnimationChannel<double>>(buffer, i);
+			for (std::size_t level = 0; level < depth; level++) node = aa.Stretch(1.01, 0.01, aa.Ease<EaseInOut<EaseCubic>>(100, node));
+			subtree->Add(node);
+		}
+		AnimationBake<double> bake(buffer, 0, count, subtree);
+		double t = 0;
+		auto frame = [&] { buffer.Clear(); bake.Play(t, t); buffer.Resolve(); t = t < 90 ? t + 0.01 : 0; };
+		Measure("bake/64x8/live", count, frame);
+		bake.Bake(0, 100, 60);
+		Measure("bake/64x8/baked", count, frame);
+		bake.Bake(0, 100, 60, 1e-4f);
+		Measure("bake/64x8/reduced", count, frame);
+		sink = buffer.Value(0);
+	}
+
+	// Acts of shots as an editor exports them, ranges around shifted and stretched clips
+	IAnimation<double>* Show(Container<double>& aa, std::size_t acts, std::size_t shots)
+	{
+		auto show = aa.Make<AnimationParallel<double>>();
+		for (std::size_t act = 0; act < acts; act++)
+		{
+			auto scene = aa.Make<AnimationParallel<double>>();
+			for (std::size_t shot = 0; shot < shots; shot++)
+			{
+				double start = double(shot);
+				scene->Add(aa.Between(start, start + 2, aa.Seek(0.5, 0, aa.Stretch(1.0, 0, aa.Parallel(
+					aa.After(0.25, 0, [](double t) { sink = t; }),
+					aa.Between(3, 4, [](double t) { sink = t; }), // past the end of the shot
+					aa.Event(1, 0, []() { sink = 1; }))))));
+			}
+			show->Add(aa.Between(act * 10.0, act * 10.0 + 10, aa.Parallel(scene, aa.Between(0, 10, [](double t) { sink = t; }))));
+		}
+		return show;
+	}
+
+	// The show played as built and after the optimizer
+	void BenchmarkOptimizer()
+	{
+		const std::size_t acts = 10, shots = 16;
+		Container<double> aa;
+		auto show = Show(aa, acts, shots);
+		Container<double> optimized;
+		AnimationOptimizer<double> optimizer(optimized);
+		auto root = optimizer.Optimize(show);
+		if (Selected("optimize/"))
+		{
+			const OptimizerStats& stats = optimizer.Stats;
+			std::printf("optimize/show: %zu nodes, depth %zu -> %zu nodes, depth %zu\n", stats.Before.Nodes, stats.Before.Depth, stats.After.Nodes, stats.After.Depth);
+		}
+		double t = 0;
+		Measure("optimize/show/built", 1, [&] { show->Play(t + 0.01, t); t = t < acts * 10.0 ? t + 0.01 : 0; });
+		Measure("optimize/show/optimized", 1, [&] { root->Play(t + 0.01, t); t = t < acts * 10.0 ? t + 0.01 : 0; });
+	}
+
+	// Cost of playing through a published snapshot and of handing a frame of channels to another thread
+	void BenchmarkHandoff()
+	{
+		AnimationPublisher<double> publisher;
+		std::unique_ptr<AnimationSnapshot<double>> snapshot(new AnimationSnapshot<double>());
+		auto root = snapshot->Root = snapshot->Nodes.Between(0, 1e12, [](double t) { sink = t; });
+		publisher.Publish(std::move(snapshot));
+		double t = 0;
+		Measure("handoff/direct", 1, [&] { root->Play(t, t); t += 0.01; });
+		Measure("handoff/snapshot", 1, [&] { publisher.Play(t, t); t += 0.01; });
+
+		const std::size_t count = 4096;
+		ChannelBuffer<float> buffer(count);
+		TripleBuffer<std::vector<float>> frames{ std::vector<float>(count) };
+		Measure("handoff/frame/4096", count, [&]
+		{
+			auto& back = frames.Back();
+			std::copy(buffer.Values(), buffer.Values() + count, back.begin());
+			frames.Publish();
+			frames.Update();
+			sink = frames.Front()[0];
+		});
+		SpscQueue<double> queue(1024);
+		Measure("handoff/queue", 1, [&] { double value = 0; queue.TryPush(t); queue.TryPop(value); sink = value; });
+	}
+
+	// A recorded session of the show replayed tick for tick: frames with hitches and scrubs back, the graph with real
+	// and with stubbed actions, optimized, and the cost of recording
+	void BenchmarkTrace()
+	{
+		Container<double> aa;
+		auto show = Show(aa, 10, 16);
+		AnimationRecorder<double> recorder(show);
+		double t = 0;
+		for (std::size_t frame = 1; frame <= 6000; frame++)
+		{
+			double next = frame % 1500 == 0 ? t - 20 : frame % 500 == 0 ? t + 0.5 : t + 1 / 60.0;
+			recorder.Play(next, t);
+			t = next;
+		}
+		AnimationTrace<double> trace = recorder.Trace;
+		if (Selected("trace/"))
+		{
+			std::vector<char> data;
+			trace.Write(data);
+			std::printf("trace/session: %zu ticks, %zu bytes\n", trace.Ticks.size(), data.size());
+		}
+		std::size_t ticks = trace.Ticks.size();
+		TraceReplay<double> replay;
+		Measure("trace/replay/real", ticks, [&] { replay.Play(*show, trace); });
+		{
+			ActionStubs<double> stubs(*show);
+			Measure("trace/replay/stubs", ticks, [&] { replay.Play(*show, trace); });
+		}
+		Container<double> optimized;
+		AnimationOptimizer<double> optimizer(optimized);
+		auto root = optimizer.Optimize(show);
+		Measure("trace/replay/optimized", ticks, [&] { replay.Play(*root, trace); });
+		Measure("trace/record", ticks, [&] { recorder.Trace.Ticks.clear(); replay.Play(recorder, trace); });
+	}
+
+	// Cues of a show with times in seconds of Time, ranges with an event in each and stretched clips
+	template<typename Time> IAnimation<Time>* Cues(Container<Time>& aa, Time second, std::size_t count)
+	{
+		auto root = aa.template Make<AnimationParallel<Time>>();
+		for (std::size_t i = 0; i < count; i++)
+		{
+			Time start = Time(i) * second;
+			root->Add(aa.Between(start, start + second, aa.Seek(second / 2, 0, aa.Parallel(
+				aa.Event(second, 0, []() { sink = sink + 1; }),
+				aa.Parallel([](Time t) { sink = double(t); })))));
+		}
+		return root;
+	}
+
+	// The same cues played in double seconds and in integer ticks, stretching by a fraction, and how far a double
+	// clock that adds frame durations drifts in a week
+	void BenchmarkTicks()
+	{
+		const std::size_t count = 256;
+		Container<double> seconds;
+		auto cues = Cues<double>(seconds, 1.0, count);
+		double t = 0;
+		Measure("ticks/cues/double", 1, [&] { double t1 = t < count ? t + 1 / 60.0 : 0; cues->Play(t1, t); t = t1; });
+
+		TickRate rate = TickRate::Flicks();
+		Container<Ticks> ticks;
+		auto tickCues = Cues<Ticks>(ticks, rate.PerSecond, count);
+		FrameClock clock(rate, 60);
+		Measure("ticks/cues/int64", 1, [&] { if (clock.Frame >= std::int64_t(count) * 60) clock.Frame = 0; clock.Play(*tickCues); });
+
+		auto stretch = seconds.Stretch(1000 / 1001.0, 0, [](double t) { sink = t; });
+		Measure("ticks/stretch/double", 1, [&] { stretch->Play(t, t); t += 1 / 60.0; });
+		auto ratio = ticks.StretchRatio(1000, 1001, [](Ticks t) { sink = double(t); });
+		Ticks at = 0;
+		Measure("ticks/stretch/ratio", 1, [&] { ratio->Play(at, at); at += 11771760; });
+
+		if (Selected("ticks/drift"))
+		{
+			const std::int64_t frames = 7 * 24 * 3600 * 60000ll / 1001; // a week at 59.94 fps
+			double summed = 0;
+			for (std::int64_t frame = 0; frame < frames; frame++) summed += 1001 / 60000.0;
+			double exact = double(frames) * 1001 / 60000;
+			FrameClock week(rate, 60000, 1001);
+			week.Frame = frames;
+			std::printf("ticks/drift: a week at 59.94 fps, summed double seconds are off by %.3f ms, ticks by %.3f ms\n",
+				(summed - exact) * 1e3, (rate.Seconds(week.Time()) - exact) * 1e3);
+		}
+	}
+
+	// Cold start of a large choreography: building it with a Container against loading its binary form
+	void BenchmarkBinary()
+	{
+		const std::size_t groups = options.Quick ? 12500 : 125000;
+		const std::size_t nodes = groups * 4 + 1;
+		std::string name = "binary/" + std::to_string(nodes / 1000) + "k";
+		AnimationRegistry<double> registry;
+		for (int i = 0; i < 16; i++) registry.Action("action" + std::to_string(i), [](double t) { sink = t; });
+		auto build = [&](Container<double>& aa)
+		{
+			auto root = aa.Make<AnimationParallel<double>>();
+			root->Animations.reserve(groups);
+			for (std::size_t i = 0; i < groups; i++)
+			{
+				double start = double(i);
+				root->Add(aa.Between(start, start + 2, aa.Seek(0.5, 0, aa.Stretch(2.0, 0, aa.Event(1, 0, registry.Find("action" + std::to_string(i % 16)))))));
+			}
+			return root;
+		};
+		Measure(name + "/build", nodes, [&]
+		{
+			Container<double> aa(ContainerStorage::Arena);
+			sink = double(build(aa)->Animations.size());
+		});
+
+		Container<double> aa(ContainerStorage::Arena);
+		std::string path = "BenchmarkAnimateAnything.aatl";
+		BinaryWriter<double> writer(registry);
+		if (!writer.Save(*build(aa), path))
+		{
+			std::fprintf(stderr, "%s\n", writer.Error.c_str());
+			return;
+		}
+		Measure(name + "/load", nodes, [&]
+		{
+			AnimationBinary<double> binary(path, registry);
+			sink = double(binary.NodeCount());
+		});
+		AnimationBinary<double> binary(path, registry);
+		double t = 0;
+		Measure(name + "/play", 1, [&] { binary.Play(t + 0.25, t); t = t < groups ? t + 0.25 : 0; });
+		std::remove(path.c_str());
+	}
+
+	bool WriteJson(const std::string& path)
+	{
+		FILE* file = std::fopen(path.c_str(), "w");
+		if (!file) return false;
+		std::fprintf(file, "{\n  \"benchmarks\": [\n");
+		for (std::size_t i = 0; i < results.size(); i++)
+		{
+			const Result& result = results[i];
+			std::fprintf(file, "    { \"name\": \"%s\", \"ns_per_op\": %.4f, \"operations\": %zu, \"iterations\": %zu }%s\n",
+				result.Name.c_str(), result.NanosecondsPerOperation, result.Operations, result.Iterations, i + 1 < results.size() ? "," : "");
+		}
+		std::fprintf(file, "  ]\n}\n");
+		return std::fclose(file) == 0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (!std::strcmp(argv[i], "--quick")) options.Quick = true;
+		else if (!std::strcmp(argv[i], "--filter") && i + 1 < argc) options.Filter = argv[++i];
+		else if (!std::strcmp(argv[i], "--json") && i + 1 < argc) options.Json = argv[++i];
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--quick] [--filter text] [--json path]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	BenchmarkChains();
+	BenchmarkFanOut();
+	BenchmarkEvents();
+	BenchmarkContainer();
+	BenchmarkActions();
+	BenchmarkInstances();
+	BenchmarkThreads();
+	BenchmarkEasing();
+	BenchmarkTracks();
+	BenchmarkLoop();
+	BenchmarkChannels();
+	BenchmarkCheckpoints();
+	BenchmarkBake();
+	BenchmarkOptimizer();
+	BenchmarkHandoff();
+	BenchmarkBinary();
+	BenchmarkTrace();
+	BenchmarkTicks();
+
+	if (!options.Json.empty() && !WriteJson(options.Json))
+	{
+		std::fprintf(stderr, "cannot write %s\n", options.Json.c_str());
+		return 1;
+	}
+	return 0;
+}
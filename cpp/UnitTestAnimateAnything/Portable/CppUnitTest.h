@@ -0,0 +1,142 @@
+// Portable stand-in for the Visual Studio CppUnitTest framework, used by the CMake build.
+// Supports the parts the tests use: TEST_CLASS, TEST_METHOD and the Assert class. Needs C++17.
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Microsoft { namespace VisualStudio { namespace CppUnitTestFramework
+{
+	// Thrown by a failed assertion
+	struct AssertFailure
+	{
+		std::string Message;
+	};
+
+	// All test methods in registration order
+	class TestRegistry
+	{
+	public:
+		struct Test
+		{
+			const char* Class;
+			const char* Method;
+			void(*Run)();
+		};
+
+		static std::vector<Test>& Tests()
+		{
+			static std::vector<Test> tests;
+			return tests;
+		}
+
+		static int Add(const char* testClass, const char* method, void(*run)())
+		{
+			Tests().push_back(Test{ testClass, method, run });
+			return 0;
+		}
+	};
+
+	class Assert
+	{
+	private:
+
+		template<typename T, typename = void> struct Printable : std::false_type { };
+		template<typename T> struct Printable<T, decltype(void(std::declval<std::ostream&>() << std::declval<const T&>()))> : std::true_type { };
+
+		template<typename T> static std::string ToString(const T& value, std::true_type)
+		{
+			std::ostringstream text;
+			text.precision(17);
+			text << value;
+			return text.str();
+		}
+
+		template<typename T> static std::string ToString(const T&, std::false_type) { return "<value>"; }
+
+		template<typename T> static std::string ToString(const T& value) { return ToString(value, Printable<T>()); }
+
+		static std::string ToString(const wchar_t* message)
+		{
+			std::string text;
+			for (; message && *message; message++) text += *message < 128 ? char(*message) : '?';
+			return text;
+		}
+
+		static void Fail(const std::string& text, const wchar_t* message)
+		{
+			throw AssertFailure{ message ? text + " - " + ToString(message) : text };
+		}
+
+	public:
+
+		template<typename T> static void AreEqual(const T& expected, const T& actual, const wchar_t* message = nullptr)
+		{
+			if (!(expected == actual)) Fail("Expected <" + ToString(expected) + "> Actual <" + ToString(actual) + ">", message);
+		}
+
+		static void AreEqual(double expected, double actual, double tolerance, const wchar_t* message = nullptr)
+		{
+			if (!(std::fabs(expected - actual) <= tolerance)) Fail("Expected <" + ToString(expected) + "> Actual <" + ToString(actual) + ">", message);
+		}
+
+		static void AreEqual(float expected, float actual, float tolerance, const wchar_t* message = nullptr)
+		{
+			if (!(std::fabs(expected - actual) <= tolerance)) Fail("Expected <" + ToString(expected) + "> Actual <" + ToString(actual) + ">", message);
+		}
+
+		template<typename T> static void AreNotEqual(const T& notExpected, const T& actual, const wchar_t* message = nullptr)
+		{
+			if (notExpected == actual) Fail("Not expected <" + ToString(notExpected) + ">", message);
+		}
+
+		static void AreNotEqual(double notExpected, double actual, double tolerance, const wchar_t* message = nullptr)
+		{
+			if (std::fabs(notExpected - actual) <= tolerance) Fail("Not expected <" + ToString(notExpected) + "> Actual <" + ToString(actual) + ">", message);
+		}
+
+		static void AreNotEqual(float notExpected, float actual, float tolerance, const wchar_t* message = nullptr)
+		{
+			if (std::fabs(notExpected - actual) <= tolerance) Fail("Not expected <" + ToString(notExpected) + "> Actual <" + ToString(actual) + ">", message);
+		}
+
+		static void IsTrue(bool condition, const wchar_t* message = nullptr) { if (!condition) Fail("IsTrue failed", message); }
+		static void IsFalse(bool condition, const wchar_t* message = nullptr) { if (condition) Fail("IsFalse failed", message); }
+		static void IsNull(const void* pointer, const wchar_t* message = nullptr) { if (pointer) Fail("IsNull failed", message); }
+		static void IsNotNull(const void* pointer, const wchar_t* message = nullptr) { if (!pointer) Fail("IsNotNull failed", message); }
+		static void Fail(const wchar_t* message = nullptr) { Fail("Fail", message); }
+
+		template<typename Exception, typename Function> static void ExpectException(Function function, const wchar_t* message = nullptr)
+		{
+			try { function(); }
+			catch (const Exception&) { return; }
+			Fail("ExpectException failed", message);
+		}
+	};
+}}}
+
+// every test method registers itself through an inline static member, the test class is constructed for each method
+#define TEST_CLASS(className) \
+	struct className##_Name { static const char* Get() { return #className; } }; \
+	class className : public ::Microsoft::VisualStudio::CppUnitTestFramework::TestClassBase<className, className##_Name>
+
+#define TEST_METHOD(methodName) \
+	static void methodName##_Run() { Self test; test.methodName(); } \
+	inline static const int methodName##_Registered = ::Microsoft::VisualStudio::CppUnitTestFramework::TestRegistry::Add(Name::Get(), #methodName, &methodName##_Run); \
+	void methodName()
+
+namespace Microsoft { namespace VisualStudio { namespace CppUnitTestFramework
+{
+	template<typename Test, typename TestName> class TestClassBase
+	{
+	protected:
+		using Self = Test;
+		using Name = TestName;
+	};
+}}}
@@ -0,0 +1,42 @@
+// Test runner for the portable CppUnitTest stand-in.
+// usage: UnitTestAnimateAnything [filter...], a filter selects the tests whose "Class::Method" name starts with it
+
+#include "CppUnitTest.h"
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+int main(int argc, char** argv)
+{
+	int run = 0, failed = 0;
+	for (auto& test : TestRegistry::Tests())
+	{
+		std::string name = std::string(test.Class) + "::" + test.Method;
+		bool selected = argc < 2;
+		for (int i = 1; i < argc; i++) selected = selected || name.compare(0, std::strlen(argv[i]), argv[i]) == 0;
+		if (!selected) continue;
+
+		run++;
+		try
+		{
+			test.Run();
+			std::printf("[ PASS ] %s\n", name.c_str());
+		}
+		catch (const AssertFailure& failure)
+		{
+			failed++;
+			std::printf("[ FAIL ] %s: %s\n", name.c_str(), failure.Message.c_str());
+		}
+		catch (const std::exception& exception)
+		{
+			failed++;
+			std::printf("[ FAIL ] %s: exception %s\n", name.c_str(), exception.what());
+		}
+	}
+	std::printf("%d tests, %d failed\n", run, failed);
+	return failed || !run ? 1 : 0;
+}
@@ -0,0 +1,118 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../AnimateAnything/AnimationBake.h"
+
+#include <cmath>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestAnimateAnything
+{
+	TEST_CLASS(UnitTestAnimationBake)
+	{
+	public:
+
+		// a few channels behind time transforms, stretches and eases, all pure functions of time
+		static AnimateAnything::IAnimation<double>* Subtree(AnimateAnything::Container<double>& aa, AnimateAnything::ChannelBuffer<float>& buffer)
+		{
+			using namespace AnimateAnything;
+			return aa.Parallel(
+				aa.TimeTransform([](double t) { return t * t / 10; }, 0, aa.Make<AnimationChannel<double>>(buffer, 1)),
+				aa.Stretch(0.5, 0, aa.Ease<EaseInOut<EaseCubic>>(10, aa.Make<AnimationChannel<double>>(buffer, 2))),
+				aa.Between(0, 10, [&buffer](double t) { buffer.Write(3, float(std::sin(t))); })
+			);
+		}
+
+		TEST_METHOD(TestBakeMatchesLive)
+		{
+			using namespace AnimateAnything;
+			ChannelBuffer<float> buffer(5);
+			Container<double> aa;
+			AnimationBake<double> bake(buffer, 1, 3, Subtree(aa, buffer));
+			std::vector<float> live;
+			for (double t = 0.013; t < 9.99; t += 0.37)
+			{
+				buffer.Clear();
+				bake.Play(t, t);
+				buffer.Resolve();
+				live.push_back(buffer.Value(1));
+				live.push_back(buffer.Value(2));
+				live.push_back(buffer.Value(3));
+			}
+
+			bake.Bake(0, 10, 200);
+			Assert::IsTrue(bake.IsBaked());
+			Assert::AreEqual(std::size_t(2001), bake.Baked.KeyCount());
+			std::size_t i = 0;
+			for (double t = 0.013; t < 9.99; t += 0.37)
+			{
+				buffer.Clear();
+				bake.Play(t, t);
+				buffer.Resolve();
+				Assert::AreEqual(live[i++], buffer.Value(1), 1e-3f);
+				Assert::AreEqual(live[i++], buffer.Value(2), 1e-3f);
+				Assert::AreEqual(live[i++], buffer.Value(3), 1e-3f);
+				Assert::AreEqual(0.0f, buffer.Value(0), L"Channels outside the baked range are not written.");
+			}
+
+			buffer.Clear();
+			bake.Play(11, 10);
+			buffer.Resolve();
+			Assert::AreEqual(0.0f, buffer.Value(2), L"Nothing is written after the baked range.");
+			Assert::AreEqual(IAnimation<double>::Never(), bake.NextActivity(11));
+
+			bake.Unbake();
+			buffer.Clear();
+			bake.Play(5, 5);
+			buffer.Resolve();
+			Assert::AreEqual(2.5f, buffer.Value(1), 1e-5f, L"The live subtree plays again.");
+		}
+
+		TEST_METHOD(TestBakeReduction)
+		{
+			using namespace AnimateAnything;
+			ChannelBuffer<float> buffer(2);
+			Container<double> aa;
+			// a ramp, a hold and a curve
+			auto ramp = aa.Parallel([&buffer](double t) { buffer.Write(0, float(t < 4 ? t : 4)); }, [&buffer](double t) { buffer.Write(1, float(std::cos(t))); });
+			AnimationBake<double> bake(buffer, 0, 2, ramp);
+			bake.Bake(0, 8, 100, 1e-3f);
+			Assert::IsTrue(bake.Baked.KeyCount() < 801 / 4, L"Samples on lines are dropped.");
+			Assert::IsTrue(bake.Baked.KeyCount() > 2);
+			for (double t = 0; t <= 8; t += 0.01)
+			{
+				buffer.Clear();
+				bake.Play(t, t);
+				buffer.Resolve();
+				Assert::AreEqual(float(t < 4 ? t : 4), buffer.Value(0), 1e-3f + 4.0f / 65535);
+				Assert::AreEqual(float(std::cos(t)), buffer.Value(1), 2e-3f);
+			}
+			Assert::IsTrue(bake.Baked.Bytes() < 801 * 2 * sizeof(float) / 4, L"The baked data is compact.");
+		}
+		// integral steps that do not divide the range keep their key times, the last step is longer than the others
+		TEST_METHOD(TestBakeIntegerTime)
+		{
+			using namespace AnimateAnything;
+			ChannelBuffer<float> buffer(1);
+			Container<long long> aa;
+			auto ramp = aa.Parallel([&buffer](long long t) { buffer.Write(0, float(t)); });
+			auto baked = BakeChannels<long long, float>(*ramp, buffer, 0, 1, 0, 10, 0.35);
+			Assert::AreEqual(std::size_t(5), baked.KeyCount(), L"Samples at 0, 2, 4, 6 and 10.");
+			Assert::AreEqual(std::size_t(5), baked.Times.size());
+			TrackCursor<long long> cursor;
+			for (long long t = 0; t <= 10; t++)
+			{
+				float value = -1;
+				baked.Sample(t, &value, cursor);
+				Assert::AreEqual(float(t), value, 1e-3f);
+			}
+
+			auto even = BakeChannels<long long, float>(*ramp, buffer, 0, 1, 0, 12, 0.25);
+			Assert::AreEqual(std::size_t(4), even.KeyCount());
+			Assert::IsTrue(even.Times.empty(), L"Even steps need no times.");
+			float value = -1;
+			even.Sample(7, &value, cursor);
+			Assert::AreEqual(7.0f, value, 1e-3f);
+		}
+	};
+}
@@ -0,0 +1,110 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../AnimateAnything/AnimateAnything.h"
+
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestAnimateAnything
+{
+	TEST_CLASS(UnitTestAnimationBatch)
+	{
+	public:
+
+		// every sample of the batch should end up with the value the scalar Play computes
+		TEST_METHOD(TestBatchMatchesPlay)
+		{
+			using namespace AnimateAnything;
+			const std::size_t count = 64;
+			std::vector<double> batched(count, -1.0), scalar(count, -1.0);
+			std::size_t current = 0;
+
+			Container<double> aa;
+			auto scalarAnim = aa.Between(0, 8,
+				aa.Between(0, 2, [&](double t) { scalar[current] = t; }),
+				aa.Between(2, 4, aa.Seek(0.5, 0, [&](double t) { scalar[current] = t * 10; })),
+				aa.After(4, 0, aa.Stretch(0.25, 0, [&](double t) { scalar[current] = t + 100; }))
+			);
+			auto batchAnim = aa.Between(0, 8,
+				aa.Between(0, 2, [&](const double* t, const std::size_t* index, std::size_t n) { for (std::size_t i = 0; i < n; i++) batched[index[i]] = t[i]; }),
+				aa.Between(2, 4, aa.Seek(0.5, 0, [&](const double* t, const std::size_t* index, std::size_t n) { for (std::size_t i = 0; i < n; i++) batched[index[i]] = t[i] * 10; })),
+				aa.After(4, 0, aa.Stretch(0.25, 0, [&](const double* t, const std::size_t* index, std::size_t n) { for (std::size_t i = 0; i < n; i++) batched[index[i]] = t[i] + 100; }))
+			);
+
+			TimeBatch<double> batch(count);
+			for (std::size_t i = 0; i < count; i++)
+			{
+				batch.T[i] = batch.T0[i] = -1.0 + i * 0.15;
+				current = i;
+				scalarAnim->PlaySimple(batch.T[i]);
+			}
+			batch.Play(*batchAnim);
+
+			for (std::size_t i = 0; i < count; i++)
+			{
+				Assert::AreEqual(scalar[i], batched[i], 1e-12, L"Batch should match scalar playback.");
+			}
+		}
+
+		TEST_METHOD(TestBatchEvents)
+		{
+			using namespace AnimateAnything;
+			std::vector<int> fired(4, 0);
+			Container<double> aa;
+			auto anim = aa.Event(1.0, 0, [&](const double* t, const std::size_t* index, std::size_t n) { for (std::size_t i = 0; i < n; i++) fired[index[i]]++; });
+			double t[] = { 1.5, 0.5, 0.5, 2.0 };
+			double t0[] = { 0.5, 1.5, 0.75, 1.5 };
+			TimeBatch<double> batch;
+			batch.Play(*anim, t, t0, 4);
+			Assert::AreEqual(1, fired[0], L"Forward crossing fires.");
+			Assert::AreEqual(1, fired[1], L"Backward crossing fires.");
+			Assert::AreEqual(0, fired[2]);
+			Assert::AreEqual(0, fired[3]);
+		}
+
+		// nodes without a batch implementation fall back to Play for every sample
+		TEST_METHOD(TestBatchFallsBackToPlay)
+		{
+			using namespace AnimateAnything;
+			float sum = 0;
+			Container<float> aa;
+			auto anim = aa.Parallel(aa.TimeTransform([](float t) { return t * 2; }, 0, [&](float t) { sum += t; }), [&]() { sum += 1; });
+			TimeBatch<float> batch(3);
+			batch.T = batch.T0 = { 1, 2, 3 };
+			batch.Play(*anim);
+			Assert::AreEqual(15.0f, sum, 0.001f);
+		}
+
+		// one graph, many instances with their own start and speed
+		TEST_METHOD(TestInstancesShareOneGraph)
+		{
+			using namespace AnimateAnything;
+			std::vector<double> value(3, -1.0);
+			std::vector<int> events(3, 0);
+			Container<double> aa;
+			auto anim = aa.Parallel(
+				aa.Between(0, 10, [&](std::size_t instance, double t) { value[instance] = t; }),
+				aa.Event(5, 0, [&](std::size_t instance, double t) { events[instance]++; })
+			);
+
+			AnimationInstances<double> crowd;
+			crowd.Add(0.0);
+			crowd.Add(2.0);
+			crowd.Add(1.0, 2.0);
+			Assert::AreEqual(std::size_t(3), crowd.Count());
+
+			crowd.Play(*anim, 3.0, 3.0);
+			Assert::AreEqual(3.0, value[0], 1e-12);
+			Assert::AreEqual(1.0, value[1], 1e-12);
+			Assert::AreEqual(4.0, value[2], 1e-12);
+
+			crowd.Play(*anim, 6.0, 3.0);
+			Assert::AreEqual(1, events[0], L"Local time went 3 to 6.");
+			Assert::AreEqual(0, events[1], L"Local time went 1 to 4.");
+			Assert::AreEqual(1, events[2], L"Local time went 4 to 10.");
+			Assert::AreEqual(4.0, value[2], 1e-12, L"Instance 2 left the range.");
+		}
+
+	};
+}
\ No newline at end of file
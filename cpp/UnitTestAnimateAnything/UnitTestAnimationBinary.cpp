@@ -0,0 +1,243 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../AnimateAnything/AnimationBinary.h"
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestAnimateAnything
+{
+	TEST_CLASS(UnitTestAnimationBinary)
+	{
+	public:
+
+		using Log = std::vector<std::pair<int, double>>;
+
+		// Register leaves that log their id and local time, leaf i is registered as "leaf<i>"
+		static void Register(AnimateAnything::AnimationRegistry<double>& registry, Log& log)
+		{
+			for (int id = 1; id <= 12; id++)
+			{
+				registry.Action("leaf" + std::to_string(id), [&log, id](double t) { log.push_back(std::make_pair(id, t)); });
+			}
+		}
+
+		// Every node kind of the binary format, built from registry actions
+		static AnimateAnything::IAnimation<double>* BuildGraph(AnimateAnything::Container<double>& aa, AnimateAnything::AnimationRegistry<double>& registry)
+		{
+			using namespace AnimateAnything;
+			auto leaf = [&](int id) { return registry.Find("leaf" + std::to_string(id)); };
+			auto held = aa.Between(3, 5, aa.Stretch(0, 0, leaf(11)));
+			held->Exit = leaf(12);
+			held->ChangedOnly = true;
+			auto shared = aa.Seek(0.5, 0, leaf(2));
+			return aa.Parallel(
+				aa.Between(0, 10,
+					aa.Between(0, 2, leaf(1)),
+					aa.Between(2, 4, shared),
+					aa.Between(4, 6, aa.Stretch(-2.0, 0, leaf(3)))
+				),
+				aa.After(8, 0, aa.Stretch(0.25, 0, leaf(4))),
+				aa.Before(1, 0, leaf(5)),
+				aa.Event(3, 0, leaf(6)),
+				aa.Loop(1.5, 3, aa.Event(1, 0, leaf(7))),
+				aa.PingPong(2, 0, aa.Ease<EaseOut<EaseCubic>>(2, leaf(8))),
+				aa.Ease<EaseInOut<EaseBounce>>(4, leaf(9)),
+				aa.Seek(1.0, 0, held),
+				aa.After(6, 0, shared),
+				leaf(10)
+			);
+		}
+
+		static void PlayFrames(AnimateAnything::IAnimation<double>& animation)
+		{
+			double t0 = -1;
+			for (double t = -1; t <= 12; t += 0.3)
+			{
+				animation.Play(t, t0);
+				t0 = t;
+			}
+			// backward and a jump over several loop cycles
+			animation.Play(2.2, t0);
+			animation.Play(11.0, 2.2);
+		}
+
+		static void AssertSameLog(const Log& expected, const Log& actual)
+		{
+			Assert::IsTrue(expected.size() > 100, L"The graph should be exercised.");
+			Assert::AreEqual(expected.size(), actual.size());
+			for (std::size_t i = 0; i < expected.size(); i++)
+			{
+				Assert::AreEqual(expected[i].first, actual[i].first, L"Leaves should play in graph order.");
+				Assert::AreEqual(expected[i].second, actual[i].second, L"Local times should be identical.");
+			}
+		}
+
+		TEST_METHOD(TestBinaryMatchesGraph)
+		{
+			using namespace AnimateAnything;
+			Log log;
+			AnimationRegistry<double> registry;
+			Register(registry, log);
+			Container<double> aa;
+			auto graph = BuildGraph(aa, registry);
+
+			BinaryWriter<double> writer(registry);
+			std::vector<char> data;
+			Assert::IsTrue(writer.Write(*graph, data), L"Every node has a binary form.");
+
+			PlayFrames(*graph);
+			Log expected;
+			std::swap(expected, log);
+
+			// play from a copy so the bytes are all the timeline uses
+			std::vector<double> aligned(data.size() / sizeof(double) + 1);
+			std::memcpy(aligned.data(), data.data(), data.size());
+			AnimationBinary<double> binary(aligned.data(), data.size(), registry);
+			Assert::IsTrue(binary.Valid());
+			Assert::AreEqual(std::size_t(33), binary.NodeCount(), L"The shared node is saved once.");
+			PlayFrames(binary);
+			AssertSameLog(expected, log);
+		}
+
+		TEST_METHOD(TestBinaryFileMapping)
+		{
+			using namespace AnimateAnything;
+			Log log;
+			AnimationRegistry<double> registry;
+			Register(registry, log);
+			Container<double> aa;
+			auto graph = BuildGraph(aa, registry);
+			PlayFrames(*graph);
+			Log expected;
+			std::swap(expected, log);
+
+			std::string path = "UnitTestAnimationBinary.aatl";
+			BinaryWriter<double> writer(registry);
+			Assert::IsTrue(writer.Save(*graph, path));
+			{
+				AnimationBinary<double> binary(path, registry);
+				Assert::IsTrue(binary.Valid());
+				PlayFrames(binary);
+			}
+			std::remove(path.c_str());
+			AssertSameLog(expected, log);
+
+			AnimationBinary<double> missing(path, registry);
+			Assert::IsFalse(missing.Valid());
+			Assert::IsFalse(missing.Error.empty());
+			missing.Play(1, 0);
+		}
+
+		// a parallel subclass that plays one more child kept outside Animations
+		class ParallelWithExtra : public AnimateAnything::AnimationParallel<double>
+		{
+		public:
+			AnimateAnything::IAnimation<double>* Extra = nullptr;
+			void Play(double t, double t0) override { AnimationParallel<double>::Play(t, t0); Extra->Play(t, t0); }
+		};
+
+		TEST_METHOD(TestBinaryRejectsBadInput)
+		{
+			using namespace AnimateAnything;
+			AnimationRegistry<double> registry;
+			int x = 0;
+			auto fade = registry.Action("fade", [&](double t) { x = int(t); });
+			Container<double> aa;
+
+			BinaryWriter<double> writer(registry);
+			std::vector<char> data;
+			Assert::IsFalse(writer.Write(*aa.Between(0, 1, [&](double t) { x = 1; }), data), L"Lambdas have no name.");
+			Assert::IsFalse(writer.Error.empty());
+			ParallelWithExtra extra;
+			extra.Extra = fade;
+			Assert::IsFalse(writer.Write(extra, data), L"Subclasses may play differently.");
+			AnimationThreadPool pool(2);
+			AnimationParallelConcurrent<double> concurrent(pool);
+			concurrent.Add(fade);
+			Assert::IsTrue(writer.Write(concurrent, data), L"A concurrent parallel is saved as a parallel.");
+			Assert::IsTrue(writer.Write(*aa.Between(0, 10, fade), data));
+
+			std::vector<double> aligned(data.size() / sizeof(double) + 1);
+			std::memcpy(aligned.data(), data.data(), data.size());
+			AnimationBinary<double> valid(aligned.data(), data.size(), registry);
+			valid.Play(5, 4);
+			Assert::AreEqual(5, x);
+
+			AnimationRegistry<double> empty;
+			AnimationBinary<double> unregistered(aligned.data(), data.size(), empty);
+			Assert::IsFalse(unregistered.Valid(), L"Actions must be registered.");
+
+			AnimationBinary<double> truncated(aligned.data(), data.size() - 1, registry);
+			Assert::IsFalse(truncated.Valid());
+
+			AnimationRegistry<float> floats;
+			floats.Action("fade", [&](float t) { });
+			AnimationBinary<float> otherType(aligned.data(), data.size(), floats);
+			Assert::IsFalse(otherType.Valid(), L"The NumericType must match.");
+
+			// a child index that points forward would allow cycles
+			BinaryHeader header;
+			std::memcpy(&header, aligned.data(), sizeof(header));
+			auto nodes = reinterpret_cast<BinaryNode<double>*>(reinterpret_cast<char*>(aligned.data()) + header.NodeOffset);
+			nodes[header.Root].Child = header.Root;
+			AnimationBinary<double> cyclic(aligned.data(), data.size(), registry);
+			Assert::IsFalse(cyclic.Valid());
+			nodes[header.Root].Child = 0;
+
+			// counts and slots large enough to wrap a sum
+			auto patched = [&](std::function<void(BinaryHeader&, BinaryNode<double>&)> patch)
+			{
+				std::vector<double> copy(aligned);
+				BinaryHeader changed = header;
+				auto root = reinterpret_cast<BinaryNode<double>*>(reinterpret_cast<char*>(copy.data()) + header.NodeOffset) + header.Root;
+				patch(changed, *root);
+				std::memcpy(copy.data(), &changed, sizeof(changed));
+				AnimationBinary<double> binary(copy.data(), data.size(), registry);
+				return binary.Valid();
+			};
+			Assert::IsTrue(patched([](BinaryHeader&, BinaryNode<double>&) { }));
+			Assert::IsFalse(patched([](BinaryHeader& h, BinaryNode<double>&) { h.NodeOffset = ~std::uint64_t(0) - 15; }), L"An offset near the top wraps.");
+			Assert::IsFalse(patched([](BinaryHeader& h, BinaryNode<double>&) { h.StringOffset = ~std::uint64_t(0); h.StringBytes = 2; }));
+			Assert::IsFalse(patched([](BinaryHeader& h, BinaryNode<double>&) { h.ChildOffset = std::uint64_t(1) << 62; h.ChildCount = 4; }), L"Count times size wraps.");
+			Assert::IsFalse(patched([](BinaryHeader&, BinaryNode<double>& root) { root.Flags |= BinaryNode<double>::ChangedOnly; root.Count = 0xffffffffu; }), L"A slot past the nodes.");
+			Assert::IsFalse(patched([](BinaryHeader&, BinaryNode<double>& root) { root.Flags |= BinaryNode<double>::ChangedOnly; root.Count = 100000000; }));
+			Assert::IsTrue(patched([](BinaryHeader&, BinaryNode<double>& root) { root.Flags |= BinaryNode<double>::ChangedOnly; root.Count = 1; }));
+		}
+
+		// writing and playing walk the graph with their own stack, a chain far deeper than the call stack allows works
+		TEST_METHOD(TestBinaryDeepGraph)
+		{
+			using namespace AnimateAnything;
+			AnimationRegistry<double> registry;
+			std::vector<double> seen;
+			IAnimation<double>* node = registry.Action("leaf", [&seen](double t) { seen.push_back(t); });
+			Container<double> aa;
+			const int depth = 200000;
+			for (int i = 0; i < depth; i++) node = i % 2 ? aa.Seek(1.0, 0, node) : aa.After(0, 0, node);
+			node = aa.Loop(depth, 2, node);
+
+			BinaryWriter<double> writer(registry);
+			std::vector<char> data;
+			Assert::IsTrue(writer.Write(*node, data), std::wstring(writer.Error.begin(), writer.Error.end()).c_str());
+			std::vector<double> aligned(data.size() / sizeof(double) + 1);
+			std::memcpy(aligned.data(), data.data(), data.size());
+			AnimationBinary<double> binary(aligned.data(), data.size(), registry);
+			Assert::IsTrue(binary.Valid());
+			Assert::AreEqual(std::size_t(depth + 2), binary.NodeCount());
+			binary.Play(1, 0);
+			Assert::AreEqual(std::size_t(1), seen.size());
+			Assert::AreEqual(1.0 + depth / 2, seen[0]);
+			seen.clear();
+			binary.Play(depth + 1.0, depth - 1.0);
+			Assert::AreEqual(std::size_t(2), seen.size(), L"Both cycles of the wrap play, in order.");
+			Assert::IsTrue(seen[0] > seen[1]);
+		}
+	};
+}
@@ -0,0 +1,82 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../AnimateAnything/AnimationChannels.h"
+#include "../AnimateAnything/AnimationTracks.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestAnimateAnything
+{
+	TEST_CLASS(UnitTestAnimationChannels)
+	{
+	public:
+
+		TEST_METHOD(TestChannelBlending)
+		{
+			using namespace AnimateAnything;
+			ChannelBuffer<float> buffer(4, 1.0f);
+			buffer.Clear();
+			buffer.Write(0, 10.0f);
+			buffer.Write(1, 10.0f, 0.25f);
+			buffer.Write(2, 10.0f, 1.0f);
+			buffer.Write(2, 20.0f, 3.0f);
+			buffer.Resolve();
+			Assert::AreEqual(10.0f, buffer.Value(0), 1e-5f, L"Full weight replaces the base.");
+			Assert::AreEqual(0.25f * 10 + 0.75f * 1, buffer.Value(1), 1e-5f, L"Partial weight mixes with the base.");
+			Assert::AreEqual(17.5f, buffer.Value(2), 1e-5f, L"Weights above 1 are normalized.");
+			Assert::AreEqual(1.0f, buffer.Value(3), 1e-5f, L"Unwritten channels keep the base.");
+
+			auto layer = buffer.PushLayer(0.5f, ChannelMode::Additive);
+			buffer.Write(0, 4.0f);
+			buffer.PopLayer(layer);
+			buffer.Resolve();
+			Assert::AreEqual(12.0f, buffer.Value(0), 1e-5f, L"Additive writes go on top.");
+
+			buffer.Clear();
+			buffer.Resolve();
+			Assert::AreEqual(1.0f, buffer.Value(0), 1e-5f, L"Clear forgets the frame.");
+		}
+
+		// two timelines drive the same channel, a crossfade weights them instead of the last one winning
+		TEST_METHOD(TestChannelLayers)
+		{
+			using namespace AnimateAnything;
+			ChannelBuffer<float> buffer(2);
+			Container<double> aa;
+			auto walk = aa.Make<AnimationChannelLayer<double>>(buffer, 0.75f, ChannelMode::Blend, aa.Make<AnimationChannel<double>>(buffer, 0));
+			auto run = aa.Make<AnimationChannelLayer<double>>(buffer, 0.25f, ChannelMode::Blend, aa.Seek(100, 0, aa.Make<AnimationChannel<double>>(buffer, 0)));
+			auto breathe = aa.Make<AnimationChannelLayer<double>>(buffer, 1.0f, ChannelMode::Additive, aa.Stretch(0.5, 0, aa.Make<AnimationChannel<double>>(buffer, 0)));
+			auto root = aa.Parallel(walk, run, breathe);
+
+			buffer.Clear();
+			root->Play(2, 1);
+			buffer.Resolve();
+			Assert::AreEqual(0.75f * 2 + 0.25f * 102 + 1, buffer.Value(0), 1e-4f);
+			Assert::AreEqual(0.0f, buffer.Value(1));
+
+			walk->Weight = 0;
+			run->Weight = 1;
+			buffer.Clear();
+			root->Play(2, 1);
+			buffer.Resolve();
+			Assert::AreEqual(103.0f, buffer.Value(0), 1e-4f, L"Layer weights can change between frames.");
+		}
+
+		TEST_METHOD(TestChannelSource)
+		{
+			using namespace AnimateAnything;
+			ChannelBuffer<float> buffer(5);
+			AnimationTrackVec3<double> track;
+			track.AddKey(0, { 0, 0, 0 });
+			track.AddKey(1, { 1, 2, 3 });
+			AnimationChannelSource<double> source(buffer, 2, 3, track.Value, 1.0f, track);
+			buffer.Clear();
+			source.Play(0.5, 0.5);
+			buffer.Resolve();
+			Assert::AreEqual(0.0f, buffer.Value(1));
+			Assert::AreEqual(0.5f, buffer.Value(2), 1e-5f);
+			Assert::AreEqual(1.0f, buffer.Value(3), 1e-5f);
+			Assert::AreEqual(1.5f, buffer.Value(4), 1e-5f);
+		}
+	};
+}
@@ -0,0 +1,122 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../AnimateAnything/AnimationCheckpoints.h"
+
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestAnimateAnything
+{
+	TEST_CLASS(UnitTestAnimationCheckpoints)
+	{
+	public:
+
+		// State a show leaves behind: events counted, a range entered and left, a value held by change suppression
+		struct Show
+		{
+			int Beats = 0;
+			int Enters = 0;
+			int Exits = 0;
+			int Holds = 0;
+			int Frames = 0;
+
+			AnimateAnything::IAnimation<double>* Build(AnimateAnything::Container<double>& aa)
+			{
+				using namespace AnimateAnything;
+				auto chorus = aa.Between(20, 30, [this](double t) { Holds++; });
+				chorus->Enter = aa.Parallel([this]() { Enters++; });
+				chorus->Exit = aa.Parallel([this]() { Exits++; });
+				auto held = aa.Between(40, 50, aa.Stretch(0, 0, [this](double t) { Holds++; }));
+				held->ChangedOnly = true;
+				return aa.Parallel(
+					aa.Loop(1, 0, aa.Event(0.5, 0, [this]() { Beats++; })),
+					chorus,
+					held,
+					[this](double t) { Frames++; }
+				);
+			}
+		};
+
+		// play a fresh show frame by frame up to t
+		static Show Reference(double t, double step)
+		{
+			AnimateAnything::Container<double> aa;
+			Show show;
+			auto root = show.Build(aa);
+			double t0 = 0;
+			root->Play(0, 0);
+			for (double time = step; time < t; time += step)
+			{
+				root->Play(time, t0);
+				t0 = time;
+			}
+			root->Play(t, t0);
+			return show;
+		}
+
+		TEST_METHOD(TestCheckpointSeekMatchesPlayback)
+		{
+			using namespace AnimateAnything;
+			Container<double> aa;
+			Show show;
+			AnimationCheckpoints<double> checkpoints(10, 0, show.Build(aa));
+			checkpoints.Track(show.Beats);
+			checkpoints.Track(show.Enters);
+			checkpoints.Track(show.Exits);
+			checkpoints.Track(show.Holds);
+			checkpoints.Preroll(100, 0.25);
+			Assert::AreEqual(std::size_t(11), checkpoints.Count(), L"One checkpoint every 10 and the initial state.");
+
+			for (double target : { 37.3, 5.1, 99.0, 20.5, 64.25, 0.2, 45.0, 44.0 })
+			{
+				Show expected = Reference(target, 0.25);
+				show.Frames = 0;
+				checkpoints.Seek(target, 0.25);
+				Assert::AreEqual(expected.Beats, show.Beats);
+				Assert::AreEqual(expected.Enters, show.Enters);
+				Assert::AreEqual(expected.Exits, show.Exits);
+				Assert::AreEqual(expected.Holds, show.Holds);
+				Assert::IsTrue(show.Frames <= 10 / 0.25 + 1, L"A seek replays at most one interval.");
+			}
+
+			// playing on after a seek continues from the restored state
+			checkpoints.Seek(29.5, 0.25);
+			checkpoints.Play(31, 29.5);
+			Show expected = Reference(31, 0.25);
+			Assert::AreEqual(expected.Beats, show.Beats);
+			Assert::AreEqual(1, show.Exits);
+		}
+
+		// a node with its own state saves it
+		class Counter : public AnimateAnything::IAnimation<double>
+		{
+		public:
+			int Plays = 0;
+			void Play(double t, double t0) override { Plays++; }
+			void SaveState(std::vector<char>& state) const override { AnimateAnything::SaveValue(state, Plays); }
+			const char* RestoreState(const char* state) override { return AnimateAnything::RestoreValue(state, Plays); }
+		};
+
+		TEST_METHOD(TestCheckpointNodeState)
+		{
+			using namespace AnimateAnything;
+			Container<double> aa;
+			auto counter = aa.Make<Counter>();
+			AnimationCheckpoints<double> checkpoints(5, 0, aa.Parallel(aa.After(0, 0, counter), aa.Before(100, 0, counter)));
+			for (int frame = 1; frame <= 20; frame++) checkpoints.Play(frame, frame - 1);
+			Assert::AreEqual(40, counter->Plays, L"The shared node plays twice a frame.");
+			Assert::AreEqual(std::size_t(5), checkpoints.Count());
+
+			checkpoints.Seek(12, 1);
+			Assert::AreEqual(24, counter->Plays);
+			checkpoints.Seek(3);
+			Assert::AreEqual(2, counter->Plays, L"The initial state is restored and one jump played.");
+
+			checkpoints.Clear();
+			Assert::AreEqual(std::size_t(1), checkpoints.Count());
+			checkpoints.Seek(12);
+			Assert::AreEqual(2, counter->Plays);
+		}
+	};
+}
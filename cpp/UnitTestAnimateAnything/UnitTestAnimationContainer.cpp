@@ -2,12 +2,55 @@
 #include "CppUnitTest.h"
 #include "../AnimateAnything/AnimateAnything.h"
 
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
+// Count the allocations of the test thread while countAllocations is set, so building can be checked for them.
+// The replacements forward to malloc and free in pairs and count nothing outside of such a check. GCC inlines them
+// into new expressions and then warns that free is called on memory from new.
+static thread_local bool countAllocations = false;
+static thread_local std::size_t allocationCount = 0;
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size)
+{
+	if (countAllocations) allocationCount++;
+	void* memory = std::malloc(size ? size : 1);
+	if (memory == nullptr) throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	if (countAllocations) allocationCount++;
+	return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
 namespace UnitTestAnimateAnything
 {
-	TEST_CLASS(UnitTestAnimationNodes)
+	TEST_CLASS(UnitTestAnimationContainer)
 	{
 	public:
 
@@ -102,5 +145,177 @@ namespace UnitTestAnimateAnything
 			Assert::AreEqual(-11, x);
 		}
 
+		// Arena storage places nodes back to back and can be reset for the next scene
+		TEST_METHOD(TestContainerArenaStorage)
+		{
+			using namespace AnimateAnything;
+			auto probe = std::make_shared<int>(0);
+			Container<double> aa(ContainerStorage::Arena, 4096);
+			int x = 0;
+			auto first = aa.Between(0, 1, [&x, probe]() { x = 1; });
+			auto second = aa.Between(1, 2, [&x, probe]() { x = 2; });
+			auto anim = aa.Parallel(first, second);
+			anim->PlaySimple(1.5);
+			Assert::AreEqual(2, x);
+			Assert::IsTrue(reinterpret_cast<char*>(first) < reinterpret_cast<char*>(second), L"Nodes should be in build order.");
+			Assert::IsTrue(reinterpret_cast<char*>(second) - reinterpret_cast<char*>(first) < 512, L"Nodes should be close together.");
+
+			ContainerStats stats = aa.Stats();
+			Assert::AreEqual(std::size_t(5), stats.Nodes);
+			Assert::AreEqual(std::size_t(1), stats.Allocations);
+			Assert::IsTrue(stats.BytesUsed > 0 && stats.BytesUsed <= stats.BytesReserved);
+			Assert::AreEqual(3L, probe.use_count());
+
+			aa.Reset();
+			Assert::AreEqual(1L, probe.use_count(), L"Reset should destroy the nodes.");
+			Assert::AreEqual(std::size_t(0), aa.Stats().Nodes);
+			Assert::AreEqual(stats.BytesReserved, aa.Stats().BytesReserved, L"Reset should keep the memory.");
+
+			auto again = aa.Between(0, 1, [&x]() { x = 3; });
+			again->PlaySimple(0.5);
+			Assert::AreEqual(3, x);
+			Assert::AreEqual(std::size_t(1), aa.Stats().Allocations);
+		}
+
+		// Large builds spill into new blocks
+		TEST_METHOD(TestContainerArenaGrows)
+		{
+			using namespace AnimateAnything;
+			Container<double> aa(ContainerStorage::Arena, 1024);
+			int x = 0;
+			AnimationParallel<double> sequence;
+			for (int i = 0; i < 1000; i++)
+			{
+				sequence.Add(aa.Between(i, i + 1, [&x, i]() { x = i; }));
+			}
+			sequence.PlaySimple(765.5);
+			Assert::AreEqual(765, x);
+			Assert::AreEqual(std::size_t(2000), aa.Stats().Nodes);
+			Assert::IsTrue(aa.Stats().Allocations > 1);
+		}
+
+		// a loop reuses its child, the size of the graph does not depend on the repeat count
+		TEST_METHOD(TestContainerLoop)
+		{
+			using namespace AnimateAnything;
+			Container<double> aa;
+			int x = 0;
+			auto anim = aa.Loop(4, 10000,
+				aa.Between(0, 2, [&]() { x = 1; }),
+				aa.Between(2, 4, [&]() { x = 2; })
+			);
+			Assert::AreEqual(std::size_t(6), aa.Stats().Nodes);
+			anim->PlaySimple(39997.0);
+			Assert::AreEqual(1, x);
+			anim->PlaySimple(39999.0);
+			Assert::AreEqual(2, x);
+			auto bounce = aa.PingPong(4, 0, [&](double t) { x = int(t); });
+			bounce->PlaySimple(5.0);
+			Assert::AreEqual(3, x);
+		}
+
+		TEST_METHOD(TestContainerEase)
+		{
+			using namespace AnimateAnything;
+			Container<double> aa;
+			double x = 0, y = 0, z = 0;
+			auto anim = aa.Parallel(
+				aa.Between(0, 4, aa.Ease<EaseInOut<EaseCubic>>(4, [&](double t) { x = t; })),
+				aa.Ease(EaseCubicBezier(0, 0, 1, 1), 4, [&](double t) { y = t; }),
+				aa.TimeTable([](double t) { return t * t; }, 0, 4, 64, 1e-3, [&](double t) { z = t; })
+			);
+			anim->PlaySimple(1.0);
+			Assert::AreEqual(0.25, x, 1e-12);
+			Assert::AreEqual(1.0, y, 1e-5);
+			Assert::AreEqual(1.0, z, 1e-3);
+		}
+
+		// the range builders return the node so the options can be set
+		TEST_METHOD(TestContainerRangeOptions)
+		{
+			using namespace AnimateAnything;
+			Container<double> aa;
+			int x = 0, done = 0;
+			auto segment = aa.Between(0, 1, [&]() { x++; });
+			segment->Exit = aa.Parallel([&]() { done++; });
+			segment->ChangedOnly = true;
+			auto anim = aa.Parallel(segment, aa.After(2, 0, [&]() { x = 100; }));
+			anim->Play(0.5, 0.0);
+			anim->Play(0.5, 0.5);
+			anim->Play(1.5, 0.5);
+			Assert::AreEqual(1, x);
+			Assert::AreEqual(1, done);
+		}
+
+		// a graph built per request into a reused arena does not touch the heap, lambdas are kept inside the nodes
+		TEST_METHOD(TestContainerBuildDoesNotAllocate)
+		{
+			using namespace AnimateAnything;
+			Container<double> aa(ContainerStorage::Arena);
+			double x = 0, y = 0, scale = 2, offset = 1, low = -1, high = 1;
+			int fired = 0;
+			std::function<void(double)> existing = [&](double t) { y = t; };
+			auto build = [&]()
+			{
+				return aa.Parallel(
+					aa.Between(0, 10,
+						aa.Between(0, 2, [&](double t) { x = t; }),
+						aa.Between(2, 4, aa.Stretch(2.0, 0, [&, scale, offset, low, high](double t) { x = std::min(high, std::max(low, t * scale + offset)); })),
+						aa.Between(4, 6, aa.Ease<EaseOut<EaseCubic>>(2, existing))
+					),
+					aa.Event(3, 0, [&]() { fired++; }),
+					aa.Loop(1.5, 3, aa.Seek(0.5, 0, [&](double t) { y = t; })),
+					aa.TimeTransform([scale](double t) { return t * scale; }, 0, [&](double t) { y = t; }),
+					[&](std::size_t index, double t) { x = t; }
+				);
+			};
+			build();
+			aa.Reset();
+
+			allocationCount = 0;
+			countAllocations = true;
+			auto root = build();
+			double t0 = 0;
+			for (double t = 0; t < 10; t += 0.5)
+			{
+				root->Play(t, t0);
+				t0 = t;
+			}
+			countAllocations = false;
+			Assert::AreEqual(std::size_t(0), allocationCount, L"Building into a reused arena and playing do not allocate.");
+			Assert::AreEqual(1, fired);
+
+			auto parallel = dynamic_cast<AnimationParallel<double>*>(root);
+			Assert::AreEqual(std::size_t(5), parallel->Animations.size());
+			Assert::AreEqual(std::size_t(5), parallel->Animations.capacity(), L"Children are reserved from the argument count.");
+		}
+
+		TEST_METHOD(TestContainerInlineFunction)
+		{
+			using namespace AnimateAnything;
+			int calls = 0;
+			InlineFunction<int(int)> empty;
+			Assert::IsFalse(bool(empty));
+			bool thrown = false;
+			try { empty(1); }
+			catch (const std::bad_function_call&) { thrown = true; }
+			Assert::IsTrue(thrown, L"Calling an empty function throws like std::function.");
+
+			auto shared = std::make_shared<int>(3);
+			InlineFunction<int(int)> add = [&calls, shared](int v) { calls++; return v + *shared; };
+			Assert::AreEqual(2L, shared.use_count());
+			InlineFunction<int(int)> copy = add;
+			Assert::AreEqual(3L, shared.use_count(), L"Copies copy the captures.");
+			InlineFunction<int(int)> moved = std::move(copy);
+			Assert::AreEqual(5, moved(2));
+			copy = add;
+			add = InlineFunction<int(int)>();
+			Assert::AreEqual(6, copy(3));
+			Assert::AreEqual(2, calls);
+			copy = empty;
+			moved = empty;
+			Assert::AreEqual(1L, shared.use_count(), L"Captures are destroyed with the function.");
+		}
+
 	};
-}
+}
\ No newline at end of file
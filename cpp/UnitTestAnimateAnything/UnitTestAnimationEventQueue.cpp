@@ -0,0 +1,166 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../AnimateAnything/AnimationEventQueue.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestAnimateAnything
+{
+	TEST_CLASS(UnitTestAnimationEventQueue)
+	{
+	public:
+
+		// events are added in reverse time order, a jump over all of them fires them in time order
+		TEST_METHOD(TestEventsFireInTimeOrder)
+		{
+			using namespace AnimateAnything;
+			std::vector<int> fired;
+			Container<double> aa;
+			AnimationEventQueue<double> queue;
+			for (int i = 9; i >= 0; i--) queue.Add(i * 1.0, aa.Parallel([&fired, i]() { fired.push_back(i); }));
+
+			queue.Play(100.0, -1.0);
+			Assert::AreEqual(10, int(fired.size()));
+			for (int i = 0; i < 10; i++) Assert::AreEqual(i, fired[i]);
+
+			fired.clear();
+			queue.Play(2.0, 5.5);
+			Assert::AreEqual(4, int(fired.size()), L"Scrubbing back over 5, 4, 3, 2.");
+			for (int i = 0; i < 4; i++) Assert::AreEqual(5 - i, fired[i]);
+
+			fired.clear();
+			queue.Play(2.0, 2.0);
+			queue.Play(3.0, 2.0);
+			Assert::AreEqual(1, int(fired.size()), L"Only 3 is in (2, 3].");
+			Assert::AreEqual(3, fired[0]);
+		}
+
+		// a collected graph fires the same events as the graph itself, nested transforms included
+		TEST_METHOD(TestEventsFromGraph)
+		{
+			using namespace AnimateAnything;
+			std::vector<double> fromGraph, fromQueue;
+			std::vector<double>* current = &fromGraph;
+			Container<double> aa;
+			auto anim = aa.Parallel(
+				aa.After(10, 0, aa.Stretch(0.5, 0, aa.Event(1, 0, [&](double t) { current->push_back(12.0); }))),
+				aa.Between(0, 5, aa.Seek(2, 0, aa.Event(3, 0, [&](double t) { current->push_back(1.0); }))),
+				aa.Event(7, 0, [&](double t) { current->push_back(7.0); }),
+				aa.Between(0, 100, [&](double t) { current->push_back(-1.0); })
+			);
+			AnimationEventQueue<double> queue(*anim);
+			Assert::AreEqual(std::size_t(3), queue.Count());
+
+			double frames[] = { 0.0, 0.5, 30.0, 11.0, 12.0, 0.0, 6.9, 7.0, 6.0 };
+			for (int i = 1; i < 9; i++)
+			{
+				fromGraph.clear();
+				fromQueue.clear();
+				current = &fromGraph;
+				anim->Play(frames[i], frames[i - 1]);
+				current = &fromQueue;
+				queue.Play(frames[i], frames[i - 1]);
+
+				fromGraph.erase(std::remove(fromGraph.begin(), fromGraph.end(), -1.0), fromGraph.end());
+				std::sort(fromGraph.begin(), fromGraph.end());
+				if (frames[i] < frames[i - 1]) std::reverse(fromGraph.begin(), fromGraph.end());
+				Assert::AreEqual(fromGraph.size(), fromQueue.size());
+				for (std::size_t j = 0; j < fromGraph.size(); j++) Assert::AreEqual(fromGraph[j], fromQueue[j]);
+			}
+		}
+
+		// a jump over part of many events only fires the crossed ones
+		TEST_METHOD(TestManyEvents)
+		{
+			using namespace AnimateAnything;
+			int fired = 0;
+			int last = -1;
+			bool ordered = true;
+			Container<int> aa;
+			AnimationEventQueue<int> queue;
+			for (int i = 0; i < 10000; i++) queue.Add(i * 3, aa.Parallel([&, i]() { ordered = ordered && last < i; last = i; fired++; }));
+			queue.Play(3000, 1500);
+			Assert::AreEqual(500, fired, L"Moments 1503 to 3000.");
+			Assert::IsTrue(ordered);
+		}
+
+		// events below a loop fire once per cycle part the loop plays, like the graph does
+		TEST_METHOD(TestEventsUnderLoop)
+		{
+			using namespace AnimateAnything;
+			std::vector<double> fromGraph, fromQueue;
+			std::vector<double>* current = &fromGraph;
+			Container<double> aa;
+			auto anim = aa.Parallel(
+				aa.Between(0, 10, aa.Loop(2, 0, aa.Event(0.5, 0, [&](double t) { current->push_back(t); }))),
+				aa.Event(3, 0, [&](double t) { current->push_back(-3.0); }),
+				aa.Loop(4, 0, aa.Between(0, 1, [&](double t) { current->push_back(-1.0); })) // no event below, ignored
+			);
+			AnimationEventQueue<double> queue(*anim);
+			Assert::AreEqual(std::size_t(1), queue.Count());
+			Assert::AreEqual(std::size_t(0), queue.OpaqueCount(), L"Loops are expanded, not played whole.");
+
+			for (double t = 0.25, t0 = 0; t < 12; t0 = t, t += 0.75)
+			{
+				fromGraph.clear();
+				fromQueue.clear();
+				current = &fromGraph;
+				anim->Play(t, t0);
+				current = &fromQueue;
+				queue.Play(t, t0);
+				fromGraph.erase(std::remove(fromGraph.begin(), fromGraph.end(), -1.0), fromGraph.end());
+				std::sort(fromGraph.begin(), fromGraph.end());
+				std::sort(fromQueue.begin(), fromQueue.end());
+				Assert::IsTrue(fromGraph == fromQueue);
+			}
+
+			// moments that cannot be bounded are kept apart and still fire in time order
+			std::vector<int> fired;
+			AnimationEventQueue<double> moments;
+			moments.Add(std::numeric_limits<double>::max(), aa.Parallel([&fired]() { fired.push_back(2); }));
+			moments.Add(1.0, aa.Parallel([&fired]() { fired.push_back(1); }));
+			moments.Play(std::numeric_limits<double>::infinity(), 0.0);
+			Assert::AreEqual(2, int(fired.size()));
+			Assert::AreEqual(1, fired[0]);
+			moments.Play(0.0, std::numeric_limits<double>::infinity());
+			Assert::AreEqual(2, fired[2], L"Backward, the latest first.");
+			Assert::AreEqual(1.0, moments.NextActivity(0.0));
+		}
+
+		// a jump over several cycles fires the events of the loop in time order with the others, skipped cycles once
+		TEST_METHOD(TestLoopCyclesInTimeOrder)
+		{
+			using namespace AnimateAnything;
+			std::vector<double> fired;
+			Container<double> aa;
+			auto anim = aa.Parallel(
+				aa.After(1, 0, aa.Loop(2, 0, aa.Event(0.5, 0, [&fired]() { fired.push_back(0); }))),
+				aa.Event(2, 0, [&fired]() { fired.push_back(2); }),
+				aa.Event(4, 0, [&fired]() { fired.push_back(4); }),
+				aa.Event(6, 0, [&fired]() { fired.push_back(6); }),
+				aa.Stretch(0.5, 0, aa.PingPong(2, 3, aa.Event(0.5, 0, [&fired]() { fired.push_back(-1); })))
+			);
+			AnimationEventQueue<double> queue(*anim);
+			Assert::AreEqual(std::size_t(3), queue.Count());
+			Assert::AreEqual(std::size_t(0), queue.OpaqueCount());
+
+			// the first loop fires at 1.5, in the cycle it skips at 3.5 and at 5.5, the ping-pong loop at 1
+			queue.Play(6.25, 0);
+			std::vector<double> expected = { -1, 0, 2, 0, 4, 0, 6 };
+			Assert::IsTrue(expected == fired);
+
+			fired.clear();
+			anim->Play(6.25, 0);
+			Assert::AreEqual(expected.size(), fired.size(), L"The graph fires as many.");
+
+			fired.clear();
+			queue.Play(1.25, 6.25);
+			expected = { 6, 0, 4, 0, 2, 0 };
+			Assert::IsTrue(expected == fired, L"Backward, the latest first.");
+		}
+	};
+}
@@ -0,0 +1,165 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../AnimateAnything/AnimationHandoff.h"
+#include "../AnimateAnything/AnimationChannels.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestAnimateAnything
+{
+	TEST_CLASS(UnitTestAnimationHandoff)
+	{
+	public:
+
+		// Leaf that counts live instances, playing one after its graph was deleted is caught by the address sanitizer
+		class Probe : public AnimateAnything::IAnimation<double>
+		{
+		public:
+			std::atomic<int>& Alive;
+			std::atomic<long>& Plays;
+			void Play(double t, double t0) override { Plays++; }
+			Probe(std::atomic<int>& alive, std::atomic<long>& plays) : Alive(alive), Plays(plays) { Alive++; }
+			~Probe() { Alive--; }
+		};
+
+		TEST_METHOD(TestPublishWhilePlaying)
+		{
+			using namespace AnimateAnything;
+			std::atomic<int> alive(0);
+			std::atomic<long> plays(0);
+			std::atomic<bool> done(false);
+			{
+				AnimationPublisher<double> publisher;
+				publisher.Play(1, 0); // nothing published yet
+
+				std::thread player([&]()
+				{
+					double t = 0;
+					while (!done) { publisher.Play(t + 1, t); t += 1; }
+				});
+
+				for (int generation = 0; generation < 500; generation++)
+				{
+					std::unique_ptr<AnimationSnapshot<double>> next(new AnimationSnapshot<double>());
+					auto probe = next->Nodes.Make<Probe>(alive, plays);
+					next->Root = next->Nodes.Parallel(probe, next->Nodes.Between(0, 1e12, next->Nodes.Make<Probe>(alive, plays)));
+					publisher.Publish(std::move(next));
+					Assert::IsTrue(alive <= 4 + 2 * int(publisher.Retired()), L"Replaced graphs are reclaimed.");
+				}
+				while (plays == 0) std::this_thread::yield();
+				done = true;
+				player.join();
+				publisher.Reclaim();
+				Assert::AreEqual(std::size_t(0), publisher.Retired(), L"Nothing is in use once the player stopped.");
+				Assert::AreEqual(2, alive.load(), L"Only the current graph is alive.");
+			}
+			Assert::AreEqual(0, alive.load());
+		}
+
+		// a visit keeps its snapshot pinned while the same thread plays, asks for the next activity and publishes
+		TEST_METHOD(TestVisitWhilePlaying)
+		{
+			using namespace AnimateAnything;
+			std::atomic<int> alive(0);
+			std::atomic<long> plays(0);
+			AnimationPublisher<double> publisher;
+			auto publish = [&]()
+			{
+				std::unique_ptr<AnimationSnapshot<double>> next(new AnimationSnapshot<double>());
+				next->Root = next->Nodes.Make<Probe>(alive, plays);
+				publisher.Publish(std::move(next));
+			};
+			publish();
+			int visited = 0;
+			publisher.ForEachChild([&](IAnimation<double>& root)
+			{
+				visited++;
+				publisher.Play(1, 0);
+				publisher.NextActivity(0);
+				publish();
+				publisher.Reclaim();
+				Assert::AreEqual(std::size_t(1), publisher.Retired(), L"The visited graph is still pinned.");
+				root.Play(2, 1);
+			});
+			Assert::AreEqual(1, visited);
+			Assert::AreEqual(2l, plays.load());
+			publisher.Reclaim();
+			Assert::AreEqual(std::size_t(0), publisher.Retired());
+			Assert::AreEqual(1, alive.load());
+		}
+
+		TEST_METHOD(TestSpscQueue)
+		{
+			using namespace AnimateAnything;
+			SpscQueue<long> queue(100);
+			Assert::AreEqual(std::size_t(128), queue.Capacity());
+			long item = 0;
+			Assert::IsFalse(queue.TryPop(item));
+			for (long i = 0; i < 128; i++) Assert::IsTrue(queue.TryPush(i));
+			Assert::IsFalse(queue.TryPush(128), L"The queue is full.");
+			for (long i = 0; i < 128; i++)
+			{
+				Assert::IsTrue(queue.TryPop(item));
+				Assert::AreEqual(i, item);
+			}
+
+			const long count = 200000;
+			std::thread producer([&]()
+			{
+				for (long i = 0; i < count; i++) while (!queue.TryPush(i)) std::this_thread::yield();
+			});
+			long expected = 0;
+			bool ordered = true;
+			while (expected < count)
+			{
+				if (!queue.TryPop(item)) { std::this_thread::yield(); continue; }
+				ordered = ordered && item == expected;
+				expected++;
+			}
+			producer.join();
+			Assert::IsTrue(ordered, L"Items arrive once and in order.");
+		}
+
+		// the evaluation thread resolves channels and hands the values to a consumer that only sees whole frames
+		TEST_METHOD(TestTripleBufferFrames)
+		{
+			using namespace AnimateAnything;
+			const std::size_t channels = 64;
+			TripleBuffer<std::vector<float>> frames(std::vector<float>(channels, -1.0f));
+			Assert::IsFalse(frames.Update(), L"Nothing was published.");
+
+			const int count = 20000;
+			std::thread evaluator([&]()
+			{
+				ChannelBuffer<float> buffer(channels);
+				for (int frame = 0; frame < count; frame++)
+				{
+					buffer.Clear();
+					for (std::size_t i = 0; i < channels; i++) buffer.Write(i, float(frame));
+					buffer.Resolve();
+					auto& back = frames.Back();
+					back.assign(buffer.Values(), buffer.Values() + channels);
+					frames.Publish();
+				}
+			});
+			float last = -1;
+			bool consistent = true;
+			while (last < count - 1)
+			{
+				if (!frames.Update()) { std::this_thread::yield(); continue; }
+				const auto& front = frames.Front();
+				for (auto value : front) consistent = consistent && value == front[0];
+				consistent = consistent && front[0] > last;
+				last = front[0];
+			}
+			evaluator.join();
+			Assert::IsTrue(consistent, L"Frames are never torn and never go back.");
+			Assert::IsFalse(frames.Update());
+		}
+	};
+}
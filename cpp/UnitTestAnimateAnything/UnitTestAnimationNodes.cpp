@@ -2,6 +2,8 @@
 #include "CppUnitTest.h"
 #include "../AnimateAnything/AnimateAnything.h"
 
+#include <cmath>
+#include <vector>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -21,6 +23,8 @@ namespace UnitTestAnimateAnything
 		using Stretch = AnimateAnything::AnimationStretch<double>;
 		using TimeTransform = AnimateAnything::AnimationTimeTransform<double>;
 		using Parallel = AnimateAnything::AnimationParallel<double>;
+		using Loop = AnimateAnything::AnimationLoop<double>;
+		using TimeTable = AnimateAnything::AnimationTimeTable<double>;
 
 		TEST_METHOD(TestAnimationActionRunsLambdas)
 		{
@@ -199,5 +203,215 @@ namespace UnitTestAnimateAnything
 			Assert::AreEqual(12.0, y, 0.01);
 		}
 
+		TEST_METHOD(TestAnimationLoopValue)
+		{
+			double value = 0;
+			Action action([&](double t) { value = t; });
+			Loop animation(2.0, 3, false, action);
+			animation.PlaySimple(-1.0); Assert::AreEqual(-1.0, value, 0.01, L"Before the first cycle time continues.");
+			animation.PlaySimple(0.5); Assert::AreEqual(0.5, value, 0.01);
+			animation.PlaySimple(2.5); Assert::AreEqual(0.5, value, 0.01);
+			animation.PlaySimple(5.5); Assert::AreEqual(1.5, value, 0.01);
+			animation.PlaySimple(7.0); Assert::AreEqual(3.0, value, 0.01, L"After the last cycle time continues.");
+		}
+
+		TEST_METHOD(TestAnimationPingPongValue)
+		{
+			double value = 0;
+			Action action([&](double t) { value = t; });
+			Loop animation(2.0, 0, true, action);
+			animation.PlaySimple(0.5); Assert::AreEqual(0.5, value, 0.01);
+			animation.PlaySimple(2.5); Assert::AreEqual(1.5, value, 0.01, L"Odd cycles play backward.");
+			animation.PlaySimple(4.5); Assert::AreEqual(0.5, value, 0.01);
+			animation.PlaySimple(2001.0); Assert::AreEqual(1.0, value, 0.01);
+		}
+
+		// events fire once per crossing, in order, also when a frame spans several cycles
+		TEST_METHOD(TestAnimationLoopEvents)
+		{
+			std::vector<double> fired;
+			Action start([&](double t) { fired.push_back(0.0); });
+			Action middle([&](double t) { fired.push_back(1.0); });
+			Event atStart(0.0, start);
+			Event atMiddle(1.0, middle);
+			Parallel events;
+			events.Add(atStart);
+			events.Add(atMiddle);
+			Loop animation(2.0, 0, false, events);
+
+			animation.Play(0.5, -0.5);
+			Assert::AreEqual(1, int(fired.size()));
+			fired.clear();
+			animation.Play(2.5, 0.5);
+			Assert::AreEqual(2, int(fired.size()), L"Middle of cycle 0 and start of cycle 1.");
+			Assert::AreEqual(1.0, fired[0]);
+			Assert::AreEqual(0.0, fired[1]);
+			fired.clear();
+			animation.Play(20000.5, 2.5);
+			Assert::AreEqual(4, int(fired.size()), L"Skipped cycles play once.");
+			Assert::AreEqual(1.0, fired[0]);
+			Assert::AreEqual(0.0, fired[1]);
+			Assert::AreEqual(1.0, fired[2]);
+			Assert::AreEqual(0.0, fired[3]);
+			fired.clear();
+			animation.Play(19998.5, 20000.5);
+			Assert::AreEqual(2, int(fired.size()), L"Backward over the start of the cycle and the middle of the previous one.");
+			Assert::AreEqual(0.0, fired[0]);
+			Assert::AreEqual(1.0, fired[1]);
+		}
+
+		TEST_METHOD(TestAnimationPingPongEvents)
+		{
+			int fired = 0;
+			ActionVoid action([&]() { fired++; });
+			Event atEnd(2.0, action);
+			Loop animation(2.0, 0, true, atEnd);
+			animation.Play(1.5, 0.5);
+			Assert::AreEqual(0, fired);
+			animation.Play(2.5, 1.5);
+			Assert::AreEqual(1, fired, L"The turning point is crossed once.");
+			animation.Play(4.5, 2.5);
+			Assert::AreEqual(1, fired);
+			animation.Play(5.5, 4.5);
+			Assert::AreEqual(1, fired);
+			animation.Play(6.5, 5.5);
+			Assert::AreEqual(2, fired);
+		}
+
+		template<typename Curve> void CheckCurve(Curve curve, const wchar_t* name)
+		{
+			Assert::AreEqual(0.0, curve(0.0), 1e-6, name);
+			Assert::AreEqual(1.0, curve(1.0), 1e-6, name);
+			AnimateAnything::EaseOut<Curve> out(curve);
+			AnimateAnything::EaseInOut<Curve> inOut(curve);
+			Assert::AreEqual(0.0, out(0.0), 1e-6, name);
+			Assert::AreEqual(1.0, out(1.0), 1e-6, name);
+			Assert::AreEqual(0.5, inOut(0.5), 1e-6, name);
+			Assert::AreEqual(1.0, inOut(1.0), 1e-6, name);
+		}
+
+		TEST_METHOD(TestEasingCurves)
+		{
+			using namespace AnimateAnything;
+			CheckCurve(EaseLinear(), L"linear");
+			CheckCurve(EaseQuad(), L"quad");
+			CheckCurve(EaseCubic(), L"cubic");
+			CheckCurve(EaseExpo(), L"expo");
+			CheckCurve(EaseElastic(), L"elastic");
+			CheckCurve(EaseBounce(), L"bounce");
+			CheckCurve(EaseCubicBezier(0.42, 0, 0.58, 1), L"bezier");
+			Assert::AreEqual(0.25, EaseQuad()(0.5), 1e-12);
+			Assert::AreEqual(0.875, EaseOut<EaseCubic>()(0.5), 1e-12);
+			Assert::AreEqual(0.8024033877399112, EaseCubicBezier(0.25, 0.1, 0.25, 1)(0.5), 1e-5, L"CSS ease");
+			Assert::AreEqual(0.5, EaseCubicBezier(0, 0, 1, 1)(0.5), 1e-6);
+		}
+
+		TEST_METHOD(TestAnimationEaseValue)
+		{
+			double value = 0;
+			Action action([&](double t) { value = t; });
+			AnimateAnything::AnimationEase<double, AnimateAnything::EaseQuad> animation(2.0, AnimateAnything::EaseQuad(), action);
+			animation.PlaySimple(1.0); Assert::AreEqual(0.5, value, 1e-12, L"Value should be 2*(1/2)^2");
+			animation.PlaySimple(-1.0); Assert::AreEqual(0.0, value, 1e-12, L"Value should be clamped.");
+			animation.PlaySimple(3.0); Assert::AreEqual(2.0, value, 1e-12, L"Value should be clamped.");
+		}
+
+		// the table is refined until the error between samples is below the bound
+		TEST_METHOD(TestAnimationTimeTable)
+		{
+			double value = 0;
+			Action action([&](double t) { value = t; });
+			auto transform = [](double t) { return std::sin(t) * 3; };
+			TimeTable animation(transform, 0.0, 10.0, 8, 1e-4, action);
+			Assert::IsTrue(animation.Error() <= 1e-4);
+			Assert::IsTrue(animation.Resolution() > 8);
+			for (double t = 0; t <= 10.0; t += 0.013)
+			{
+				animation.PlaySimple(t);
+				Assert::AreEqual(transform(t), value, 2e-4);
+			}
+			animation.PlaySimple(12.0); Assert::AreEqual(transform(12.0), value, 1e-12, L"Outside the table the transform is called.");
+		}
+
+		TEST_METHOD(TestNextActivity)
+		{
+			const double never = AnimateAnything::IAnimation<double>::Never();
+			int count = 0;
+			ActionVoid action([&]() { count++; });
+			Between between(2.0, 4.0, action);
+			Assert::AreEqual(2.0, between.NextActivity(0.0));
+			Assert::AreEqual(3.0, between.NextActivity(3.0), L"Active in range.");
+			Assert::AreEqual(never, between.NextActivity(4.0));
+
+			Event event(1.0, action);
+			After after(5.0, event);
+			Assert::AreEqual(6.0, after.NextActivity(0.0));
+			Assert::AreEqual(never, after.NextActivity(6.0));
+
+			Stretch stretch(0.5, between);
+			Seek seek(1.0, stretch);
+			Assert::AreEqual(3.0, seek.NextActivity(0.0), L"(t+1)*0.5 reaches 2 at 3.");
+
+			Parallel parallel;
+			Assert::AreEqual(never, parallel.NextActivity(0.0));
+			parallel.Add(after);
+			parallel.Add(between);
+			Assert::AreEqual(2.0, parallel.NextActivity(0.0));
+			Assert::AreEqual(6.0, parallel.NextActivity(4.5));
+
+			// an event in every cycle of a loop
+			Event tick(1.5, action);
+			Loop loop(2.0, 3, false, tick);
+			Assert::AreEqual(1.5, loop.NextActivity(0.0));
+			Assert::AreEqual(2.0, loop.NextActivity(1.75), L"Wrapping plays the next cycle.");
+			Assert::AreEqual(5.5, loop.NextActivity(4.5));
+			Assert::AreEqual(never, loop.NextActivity(5.75), L"After the last cycle.");
+		}
+
+		TEST_METHOD(TestAnimationRangeEnterExit)
+		{
+			int enters = 0, exits = 0, plays = 0;
+			ActionVoid enter([&]() { enters++; });
+			ActionVoid exit([&]() { exits++; });
+			ActionVoid action([&]() { plays++; });
+			Between animation(1.0, 2.0, action);
+			animation.Enter = &enter;
+			animation.Exit = &exit;
+			double frames[] = { 0.5, 1.25, 1.5, 2.5, 3.0, 1.75, 0.0, 5.0 };
+			double prev = 0.0;
+			for (double t : frames)
+			{
+				animation.Play(t, prev);
+				prev = t;
+			}
+			Assert::AreEqual(2, enters, L"Entered forward at 1.25 and backward at 1.75.");
+			Assert::AreEqual(2, exits, L"Left at 2.5 and at 0.0, the jump 0 to 5 skips the range.");
+			Assert::AreEqual(3, plays);
+
+			Before before(1.0, action);
+			before.Exit = &exit;
+			before.Play(0.5, 0.0);
+			before.Play(1.0, 0.5);
+			Assert::AreEqual(3, exits);
+		}
+
+		// held values are not set again
+		TEST_METHOD(TestAnimationRangeChangedOnly)
+		{
+			int plays = 0;
+			Action action([&](double t) { plays++; });
+			After animation(1.0, action);
+			animation.ChangedOnly = true;
+			animation.PlaySimple(2.0);
+			animation.PlaySimple(2.0);
+			animation.PlaySimple(2.0);
+			Assert::AreEqual(1, plays);
+			animation.PlaySimple(3.0);
+			Assert::AreEqual(2, plays);
+			animation.PlaySimple(0.0);
+			animation.PlaySimple(3.0);
+			Assert::AreEqual(3, plays, L"Leaving the range forgets the previous time.");
+		}
+
 	};
 }
\ No newline at end of file
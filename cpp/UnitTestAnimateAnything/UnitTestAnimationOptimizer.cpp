@@ -0,0 +1,158 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../AnimateAnything/AnimationOptimizer.h"
+
+#include <functional>
+#include <tuple>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestAnimateAnything
+{
+	TEST_CLASS(UnitTestAnimationOptimizer)
+	{
+	public:
+
+		using Call = std::tuple<int, double, double>;
+
+		// A scene like the ones the editor exports: acts in ranges, nested shots, clips shifted and stretched
+		static AnimateAnything::IAnimation<double>* Scene(AnimateAnything::Container<double>& aa, std::vector<Call>& calls)
+		{
+			using namespace AnimateAnything;
+			auto leaf = [&aa, &calls](int id) { return aa.Parallel([&calls, id](double t) { calls.emplace_back(id, t, 0); }); };
+			auto event = [&aa, &calls](int id) { return aa.Parallel([&calls, id]() { calls.emplace_back(id, 0, 0); }); };
+			auto entered = aa.Between(2, 4, leaf(9));
+			entered->Enter = event(10);
+			return aa.Parallel(
+				aa.Between(0, 10,
+					aa.Parallel(
+						aa.Seek(0.25, 0, aa.Stretch(2.0, 0, aa.After(1, 0, leaf(1)))),
+						aa.Between(20, 30, leaf(2)), // after the act ends
+						aa.Parallel(aa.Between(-5, 5, aa.Before(100, 0, leaf(3))), aa.Event(3, 0, event(4)))
+					)
+				),
+				aa.Between(10, 20, aa.Stretch(1.0, 0, aa.Seek(0.5, 0, aa.Stretch(0.5, 0, aa.Between(0, 50, leaf(5)))))),
+				aa.Loop(3, 0, aa.Between(0, 1, aa.Between(1, 2, leaf(6))), aa.Seek(1, 0, leaf(7))),
+				aa.Stretch(-1.0, 0, aa.Between(-8, -6, aa.Between(2.5, 5, leaf(8)))),
+				aa.Parallel(entered, aa.Between(2, 3, leaf(11))),
+				aa.Between(12, 14, aa.Parallel(aa.Between(5, 6, leaf(12)), aa.Seek(1, 0, aa.Stretch(2.0, 0, leaf(13))))) // one shot left
+			);
+		}
+
+		static std::vector<Call> Run(AnimateAnything::IAnimation<double>& root, std::vector<Call>& calls)
+		{
+			calls.clear();
+			double t0 = -1;
+			for (double t = -1; t < 25; t += 0.37)
+			{
+				root.Play(t, t0);
+				t0 = t;
+			}
+			root.Play(2.5, 21); // jumps back
+			root.Play(11, 2.5);
+			AnimateAnything::TimeBatch<double> batch(64);
+			for (std::size_t i = 0; i < 64; i++)
+			{
+				batch.T[i] = i * 0.4 - 1;
+				batch.T0[i] = i * 0.4 - 1.4;
+			}
+			batch.Play(root);
+			return calls;
+		}
+
+		TEST_METHOD(TestOptimizerPlaysIdentically)
+		{
+			using namespace AnimateAnything;
+			std::vector<Call> calls;
+			Container<double> aa;
+			auto scene = Scene(aa, calls);
+			auto expected = Run(*scene, calls);
+
+			Container<double> optimized;
+			AnimationOptimizer<double> optimizer(optimized);
+			auto root = optimizer.Optimize(scene);
+			Assert::IsTrue(expected == Run(*root, calls), L"Every action sees the same times in the same order.");
+			Assert::IsFalse(expected.empty());
+
+			const OptimizerStats& stats = optimizer.Stats;
+			Assert::IsTrue(stats.After.Nodes < stats.Before.Nodes);
+			Assert::IsTrue(stats.After.Depth < stats.Before.Depth);
+			Assert::AreEqual(std::size_t(4), stats.Pruned, L"The shots after their act, the inner range in the loop and the reversed one.");
+			Assert::AreEqual(std::size_t(2), stats.Flattened);
+		}
+
+		TEST_METHOD(TestOptimizerChains)
+		{
+			using namespace AnimateAnything;
+			std::vector<long long> seen;
+			Container<long long> aa;
+			auto leaf = aa.Parallel([&seen](long long t) { seen.push_back(t); });
+			auto chain = aa.Seek(5, 0, aa.Seek(-2, 0, aa.After(10, 0, aa.After(-4, 0, aa.Stretch(1, 0, aa.Before(100, 0, leaf))))));
+			Container<long long> optimized;
+			AnimationOptimizer<long long> optimizer(optimized);
+			auto root = optimizer.Optimize(chain);
+			auto folded = dynamic_cast<AnimationChain<long long>*>(root);
+			Assert::IsNotNull(folded);
+			Assert::IsTrue(&folded->Animation == leaf);
+			Assert::AreEqual(std::size_t(6), optimizer.Stats.Folded);
+			// integral shifts fold exactly, the second After always passes and Stretch 1 does nothing:
+			// t + 3, then 10 <= t and t - 6, then t < 100 and t - 100
+			Assert::AreEqual(std::size_t(3), folded->Count);
+			Assert::AreEqual(100ll, folded->Stages[2].Hi);
+			for (long long t = -5; t < 200; t += 3)
+			{
+				std::vector<long long> expected;
+				seen.clear();
+				chain->Play(t, t);
+				expected.swap(seen);
+				root->Play(t, t);
+				Assert::IsTrue(expected == seen);
+				Assert::AreEqual(chain->NextActivity(t), root->NextActivity(t), L"The chain asks the node it was folded from.");
+			}
+
+			// degenerate parallels disappear, a root that never plays becomes an empty parallel
+			Container<double> shapes;
+			auto a = shapes.Parallel([](double t) {});
+			auto b = shapes.Parallel([](double t) {});
+			Container<double> result;
+			AnimationOptimizer<double> flatten(result);
+			auto flat = dynamic_cast<AnimationParallel<double>*>(flatten.Optimize(shapes.Parallel(shapes.Parallel(a, b), shapes.Parallel(shapes.Parallel(a), b))));
+			Assert::IsNotNull(flat);
+			Assert::AreEqual(std::size_t(4), flat->Animations.size());
+			Assert::AreEqual(std::size_t(2), flatten.Stats.Flattened);
+			Assert::IsTrue(flatten.Optimize(shapes.Between(0, 1, shapes.Between(2, 3, a))) != nullptr);
+			Assert::AreEqual(std::size_t(1), flatten.Stats.After.Nodes);
+			Assert::AreEqual(std::size_t(1), flatten.Stats.Pruned);
+		}
+
+		// a parallel subclass that plays one more child kept outside Animations
+		class ParallelWithExtra : public AnimateAnything::AnimationParallel<double>
+		{
+		public:
+			AnimateAnything::IAnimation<double>* Extra = nullptr;
+			void Play(double t, double t0) override { AnimationParallel<double>::Play(t, t0); Extra->Play(t, t0); }
+			void ForEachChild(const std::function<void(AnimateAnything::IAnimation<double>&)>& visit) override { AnimationParallel<double>::ForEachChild(visit); visit(*Extra); }
+		};
+
+		TEST_METHOD(TestOptimizerKeepsSubclassesWhole)
+		{
+			using namespace AnimateAnything;
+			std::vector<int> played;
+			Container<double> aa;
+			auto custom = aa.Make<ParallelWithExtra>();
+			custom->Add(aa.Between(0, 1, [&played](double) { played.push_back(1); }));
+			custom->Extra = aa.Between(0, 1, [&played](double) { played.push_back(2); });
+			Container<double> optimized;
+			AnimationOptimizer<double> optimizer(optimized);
+			auto root = optimizer.Optimize(aa.Parallel(aa.Parallel(custom), aa.Between(0, 1, [&played](double) { played.push_back(3); })));
+			auto flat = dynamic_cast<AnimationParallel<double>*>(root);
+			Assert::IsNotNull(flat);
+			Assert::AreEqual(std::size_t(2), flat->Animations.size());
+			Assert::IsTrue(flat->Animations[0] == custom, L"The subclass is not flattened or rebuilt.");
+			root->Play(0.5, 0.25);
+			Assert::AreEqual(std::size_t(3), played.size(), L"The child kept outside Animations plays.");
+			Assert::AreEqual(2, played[1]);
+		}
+	};
+}
@@ -0,0 +1,68 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../AnimateAnything/AnimationPlayer.h"
+
+#include <chrono>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestAnimateAnything
+{
+	TEST_CLASS(UnitTestAnimationPlayer)
+	{
+	public:
+
+		// the player sleeps through the gap between the range and the event and retires the root when both are done,
+		// stepped by hand on a clock that only moves to the deadlines
+		TEST_METHOD(TestPlayerSleepsAndRetires)
+		{
+			using namespace AnimateAnything;
+			Container<double> aa;
+			int ranged = 0, events = 0, started = 0;
+			auto anim = aa.Parallel(
+				aa.Event(0, 0, [&]() { started++; }),
+				aa.Between(0, 0.05, [&]() { ranged++; }),
+				aa.Event(0.2, 0, [&]() { events++; })
+			);
+			AnimationPlayer<double> player(1.0, std::chrono::milliseconds(10));
+			AnimationPlayer<double>::Clock::time_point now;
+			player.Now = [&now]() { return now; };
+			player.Play(*anim);
+			Assert::AreEqual(std::size_t(1), player.Count());
+			for (auto next = player.Step(); next != AnimationPlayer<double>::Clock::time_point::max(); next = player.Step()) now = next;
+
+			Assert::AreEqual(1, started, L"The first frame plays from just before 0.");
+			Assert::AreEqual(1, events);
+			Assert::AreEqual(5, ranged, L"The range is played every frame, at 0, 10, 20, 30 and 40 ms.");
+			Assert::IsTrue(now >= AnimationPlayer<double>::Clock::time_point(std::chrono::milliseconds(200)), L"The root retires after the event.");
+			Assert::IsTrue(player.Frames() <= std::size_t(ranged + 3), L"Nothing is played between the range and the event.");
+			Assert::AreEqual(std::size_t(0), player.Count());
+		}
+
+		// an endless animation keeps playing until it is stopped, here by its own event
+		TEST_METHOD(TestPlayerStop)
+		{
+			using namespace AnimateAnything;
+			Container<int> aa;
+			int wraps = 0;
+			AnimationPlayer<int> player(1000.0, std::chrono::milliseconds(1));
+			auto anim = aa.Loop(10, 0, aa.Event(5, 0, [&]() { if (++wraps == 3) player.Stop(); }));
+			player.Play(*anim);
+			player.Run();
+			Assert::AreEqual(3, wraps, L"Run returns after the step that called Stop.");
+			Assert::AreEqual(std::size_t(1), player.Count(), L"A stopped root is still playing.");
+
+			// stepped by hand the player only wakes up for the events, twice when the clock lands just before one
+			AnimationPlayer<int> stepped(1000.0, std::chrono::milliseconds(1));
+			AnimationPlayer<int>::Clock::time_point now;
+			stepped.Now = [&now]() { return now; };
+			auto loop = aa.Loop(10, 0, aa.Event(5, 0, [&]() { wraps++; }));
+			stepped.Play(*loop);
+			wraps = 0;
+			while (now < AnimationPlayer<int>::Clock::time_point(std::chrono::milliseconds(100))) now = stepped.Step();
+			Assert::AreEqual(10, wraps);
+			Assert::IsTrue(stepped.Frames() <= std::size_t(2 * wraps + 2));
+		}
+
+	};
+}
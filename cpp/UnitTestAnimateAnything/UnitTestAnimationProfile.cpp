@@ -0,0 +1,82 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include "../AnimateAnything/AnimationProfile.h"
+
+// Profiling changes the layout of IAnimation, so ANIMATEANYTHING_PROFILE is defined for a whole build and never in a
+// single file: CMake builds these tests into UnitTestAnimateAnythingProfile, Visual Studio in the Profile configurations.
+#ifdef ANIMATEANYTHING_PROFILE
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestAnimateAnything
+{
+	TEST_CLASS(UnitTestAnimationProfile)
+	{
+	public:
+
+		TEST_METHOD(TestProfileCounters)
+		{
+			using namespace AnimateAnything;
+			using Time = double;
+			Container<Time> aa;
+			int x = 0;
+			auto first = Label(aa.Between(0, 2, [&](Time t) { x = 1; }), "first");
+			auto event = aa.Event(3, 0, [&]() { x = 2; });
+			auto root = aa.Parallel(first, aa.Seek(1, 0, event));
+			for (int frame = 0; frame < 10; frame++) root->Play(Time(frame), Time(frame - 1));
+
+			Assert::AreEqual(std::uint64_t(10), first->Profile.Plays.load());
+			Assert::AreEqual(std::uint64_t(2), first->Profile.Hits.load(), L"0 and 1 are in the range.");
+			Assert::AreEqual(std::uint64_t(10), event->Profile.Plays.load());
+			Assert::AreEqual(std::uint64_t(1), event->Profile.Hits.load(), L"The event fires once.");
+
+			ProfileReport<Time> report(*root);
+			Assert::IsTrue(report.Enabled());
+			Assert::AreEqual(std::size_t(6), report.Nodes.size());
+			Assert::AreEqual(std::string("AnimationParallel"), report.Nodes[0].Type);
+			Assert::AreEqual(std::string("first"), report.Nodes[1].Label);
+			Assert::AreEqual(std::size_t(2), report.Nodes[2].Depth);
+			Assert::AreEqual(std::string("AnimationActionTime"), report.Nodes[2].Type);
+			Assert::AreEqual(std::uint64_t(2), report.Nodes[2].Plays);
+
+			ProfileReport<Time>::Reset(*root);
+			Assert::AreEqual(std::uint64_t(0), first->Profile.Plays.load());
+			Assert::AreEqual(std::string("first"), first->Profile.Label, L"Reset keeps labels.");
+		}
+
+		TEST_METHOD(TestProfileReport)
+		{
+			using namespace AnimateAnything;
+			using Time = double;
+			Container<Time> aa;
+			auto slow = Label(aa.Parallel([](Time t) { std::this_thread::sleep_for(std::chrono::milliseconds(2)); }), "slow");
+			auto fast = Label(aa.Parallel([](Time t) { }), "fast");
+			auto root = Label(aa.Parallel(aa.After(0, 0, slow), fast), "root");
+			root->Play(1, 0);
+			root->Play(2, 1);
+
+			ProfileReport<Time> report(*root);
+			Assert::IsTrue(report.Nodes[0].TotalNanoseconds >= 4000000, L"The root includes the time of its subtree.");
+			Assert::AreEqual(std::uint64_t(0), report.Nodes[0].Nanoseconds, L"Only actions are timed.");
+
+			std::string top = report.Top(1);
+			Assert::IsTrue(top.find("slow (AnimationActionTime)") != std::string::npos);
+			Assert::IsTrue(top.find("fast") == std::string::npos, L"Only the top node is listed.");
+
+			std::string tree = report.Tree();
+			Assert::IsTrue(tree.find("\n      slow") != std::string::npos || tree.find("    slow") != std::string::npos, L"Children are indented.");
+			Assert::IsTrue(tree.find("root (AnimationParallel)") != std::string::npos);
+
+			std::string json = report.Json();
+			Assert::IsTrue(json.find("\"label\": \"root\"") == 2);
+			Assert::IsTrue(json.find("\"children\": [\n") != std::string::npos);
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,151 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../AnimateAnything/AnimationScript.h"
+
+#ifdef ANIMATEANYTHING_COROUTINES
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestAnimateAnything
+{
+	TEST_CLASS(UnitTestAnimationScript)
+	{
+	public:
+
+		struct Stage
+		{
+			int Step = 0;
+			int Resumes = 0;
+			double Fade = -1;
+		};
+
+		static AnimateAnything::Script<double> Bow(Stage& stage)
+		{
+			stage.Resumes++;
+			co_await AnimateAnything::Wait(1.0);
+			stage.Resumes++;
+			stage.Step = 4;
+		}
+
+		static AnimateAnything::Script<double> Scene(Stage& stage)
+		{
+			using namespace AnimateAnything;
+			stage.Resumes++;
+			stage.Step = 1;
+			co_await Wait(2.0);
+			stage.Resumes++;
+			stage.Step = 2;
+			co_await Tween(1.0, [&stage](double local) { stage.Fade = local; });
+			stage.Resumes++;
+			stage.Step = 3;
+			co_await Bow(stage);
+			stage.Resumes++;
+			stage.Step = 5;
+		}
+
+		TEST_METHOD(TestScriptSequence)
+		{
+			using namespace AnimateAnything;
+			Stage stage;
+			AnimationScript<double> script([&stage]() { return Scene(stage); });
+			script.Play(0, 0);
+			Assert::AreEqual(1, stage.Step);
+			Assert::AreEqual(2.0, script.NextActivity(0.5), L"The script sleeps until its deadline.");
+
+			for (double t = 0.01; t < 1.99; t += 0.01) script.Play(t, t - 0.01);
+			Assert::AreEqual(1, stage.Resumes, L"A waiting script is not resumed.");
+
+			script.Play(2.5, 1.99);
+			Assert::AreEqual(2, stage.Step);
+			Assert::AreEqual(0.5, stage.Fade, 1e-12, L"The tween plays with the time since it started.");
+			script.Play(3.5, 2.5);
+			Assert::AreEqual(1.0, stage.Fade, L"The tween ends at its duration.");
+			Assert::AreEqual(3, stage.Step);
+			script.Play(3.9, 3.5);
+			Assert::AreEqual(3, stage.Step, L"The called script waits from the end of the tween, not from the frame.");
+			script.Play(4.0, 3.9);
+			Assert::AreEqual(5, stage.Step);
+			Assert::IsTrue(script.Done());
+			Assert::AreEqual(IAnimation<double>::Never(), script.NextActivity(5));
+		}
+
+		TEST_METHOD(TestScriptInGraph)
+		{
+			using namespace AnimateAnything;
+			Container<double> aa;
+			Stage stage;
+			auto script = aa.Make<AnimationScript<double>>([&stage]() { return Scene(stage); });
+			auto root = aa.Between(10, 100, aa.Stretch(2.0, 0, script));
+			root->Play(5, 0);
+			Assert::AreEqual(0, stage.Step, L"The script starts at its local 0.");
+			root->Play(10.5, 5);
+			Assert::AreEqual(1, stage.Step);
+			root->Play(11.0, 10.5);
+			Assert::AreEqual(2, stage.Step, L"Stretched time reaches the wait twice as fast.");
+			root->Play(13.0, 11.0);
+			Assert::AreEqual(5, stage.Step, L"One play can run through several waits.");
+
+			// a loop starts the script again every cycle
+			Stage looped;
+			auto again = aa.Make<AnimationScript<double>>([&looped]() { return Scene(looped); });
+			auto loop = aa.Loop(3.0, 0, again);
+			double t0 = 0;
+			for (double t = 0; t < 5.6; t += 0.25)
+			{
+				loop->Play(t, t0);
+				t0 = t;
+			}
+			Assert::AreEqual(2, looped.Step, L"The second cycle has started over.");
+			Assert::AreEqual(0.5, looped.Fade, 1e-12);
+		}
+
+		static AnimateAnything::Script<double> Door(Stage& stage, const AnimateAnything::ScriptSignal& open)
+		{
+			co_await AnimateAnything::Until(open);
+			stage.Step = 1;
+			co_await AnimateAnything::Wait(0.5);
+			stage.Step = 2;
+		}
+
+		TEST_METHOD(TestScriptSignal)
+		{
+			using namespace AnimateAnything;
+			Stage stage;
+			ScriptSignal open;
+			AnimationScript<double> script([&]() { return Door(stage, open); });
+			script.Play(1, 0);
+			script.Play(2, 1);
+			Assert::AreEqual(0, stage.Step);
+			open.Raise();
+			Assert::AreEqual(0, stage.Step, L"The script continues on the next play.");
+			script.Play(3, 2);
+			Assert::AreEqual(1, stage.Step);
+			script.Play(3.4, 3);
+			Assert::AreEqual(1, stage.Step, L"Waits after a signal count from the play that saw it.");
+			script.Play(3.5, 3.4);
+			Assert::AreEqual(2, stage.Step);
+		}
+
+		TEST_METHOD(TestScriptFramePool)
+		{
+			using namespace AnimateAnything;
+			void* first = ScriptFramePool::Allocate(200);
+			ScriptFramePool::Release(first, 200);
+			void* second = ScriptFramePool::Allocate(230);
+			Assert::IsTrue(first == second, L"Frames of the same size class are reused.");
+			ScriptFramePool::Release(second, 230);
+
+			Stage stage;
+			AnimationScript<double> script([&stage]() { return Scene(stage); });
+			for (int run = 0; run < 3; run++)
+			{
+				script.Restart();
+				script.Play(10, 0);
+				Assert::IsTrue(script.Done());
+			}
+			Assert::AreEqual(18, stage.Resumes);
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,103 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../AnimateAnything/AnimationStatic.h"
+
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestAnimateAnything
+{
+	TEST_CLASS(UnitTestAnimationStatic)
+	{
+	public:
+
+		// same sequence as the container test, built at compile time
+		TEST_METHOD(TestStaticAnimationSequence)
+		{
+			int x = 0;
+			AnimateAnything::Static<double> aa;
+
+			auto anim = aa.Between(.0, 10.0,
+				aa.Between(0, 2, [&](double time) { x = +1; }),
+				aa.Between(2, 4, [&](double time) { x = -3 - time; }),
+				aa.Between(4, 6, [&](double time) { x = +8 + time; }),
+				aa.Between(6, 8, [&]() { x = -9; }),
+				aa.Between(8, 10, [&]() { x = -11; })
+			);
+
+			anim.Play(-1.0, -1.0);
+			Assert::AreEqual(0, x, L"x should not change.");
+			anim.Play(11.0, 11.0);
+			Assert::AreEqual(0, x, L"x should not change.");
+			anim.Play(1.0, 1.0);
+			Assert::AreEqual(+1, x);
+			anim.Play(3.0, 3.0);
+			Assert::AreEqual(-3 - 1, x);
+			anim.Play(5.0, 5.0);
+			Assert::AreEqual(+8 + 1, x);
+			anim.Play(7.0, 7.0);
+			Assert::AreEqual(-9, x);
+			anim.Play(9.0, 9.0);
+			Assert::AreEqual(-11, x);
+		}
+
+		TEST_METHOD(TestStaticTimeTransforms)
+		{
+			double value = 0;
+			int events = 0;
+			AnimateAnything::Static<double> aa;
+			auto anim = aa.Parallel(
+				aa.Seek(1.0, 0, aa.Stretch(0.5, 0, [&](double t) { value = t; })),
+				aa.Event(2.0, 0, [&]() { events++; })
+			);
+			anim.Play(1.0, 0.0); Assert::AreEqual(1.0, value, 0.01, L"Value should be (t+1)*.5");
+			Assert::AreEqual(0, events);
+			anim.Play(3.0, 1.0); Assert::AreEqual(2.0, value, 0.01, L"Value should be (t+1)*.5");
+			Assert::AreEqual(1, events);
+		}
+
+		// static trees can hold dynamic nodes and be held by them
+		TEST_METHOD(TestStaticInteroperatesWithDynamic)
+		{
+			using namespace AnimateAnything;
+			double x = 0, y = 0;
+			Container<double> container;
+			auto dynamic = container.Between(0, 1, [&](double t) { x = t; });
+			Static<double> aa;
+			auto wrapped = aa.Wrap(aa.After(1.0, 0, dynamic, [&](double t) { y = t; }));
+			auto root = container.Parallel(&wrapped);
+			root->PlaySimple(1.5);
+			Assert::AreEqual(0.5, x, 0.01);
+			Assert::AreEqual(0.5, y, 0.01);
+		}
+
+		// the builder calls of a Container compile unchanged with Static and play the same
+		TEST_METHOD(TestStaticTakesContainerCalls)
+		{
+			using namespace AnimateAnything;
+			std::vector<double> fromStatic, fromContainer;
+			auto build = [](auto& aa, std::vector<double>& log)
+			{
+				return aa.Parallel(
+					aa.After(1.0, 3.0, aa.Stretch(2.0, 1.5, [&log](double t) { log.push_back(t); })),
+					aa.Before(1.0, 1.0, aa.Seek(0.5, 1.0, [&log](double t) { log.push_back(-t); })),
+					aa.Event(2.0, 2.0, [&log]() { log.push_back(100); })
+				);
+			};
+			Static<double> st;
+			Container<double> aa;
+			auto fixed = build(st, fromStatic);
+			auto dynamic = build(aa, fromContainer);
+			double frames[] = { 0.0, 0.5, 1.5, 2.5, 0.25 };
+			for (int i = 1; i < 5; i++)
+			{
+				fixed.Play(frames[i], frames[i - 1]);
+				dynamic->Play(frames[i], frames[i - 1]);
+			}
+			Assert::IsTrue(fromStatic == fromContainer);
+			Assert::AreEqual(std::size_t(6), fromStatic.size());
+		}
+
+	};
+}
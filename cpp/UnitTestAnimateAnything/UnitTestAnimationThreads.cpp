@@ -0,0 +1,153 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../AnimateAnything/AnimationThreads.h"
+#include "../AnimateAnything/AnimationOptimizer.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestAnimateAnything
+{
+	TEST_CLASS(UnitTestAnimationThreads)
+	{
+	public:
+
+		TEST_METHOD(TestParallelForCoversEveryIndexOnce)
+		{
+			AnimateAnything::AnimationThreadPool pool(4);
+			std::vector<std::atomic<int>> hits(1000);
+			for (auto& hit : hits) hit = 0;
+			pool.ParallelFor(hits.size(), 7, [&](std::size_t begin, std::size_t end)
+			{
+				for (std::size_t i = begin; i < end; i++) hits[i]++;
+			});
+			for (auto& hit : hits) Assert::AreEqual(1, hit.load());
+		}
+
+		// a throwing body reaches the caller once every chunk has run, instead of leaving it waiting
+		TEST_METHOD(TestParallelForRethrowsOnCaller)
+		{
+			AnimateAnything::AnimationThreadPool pool(3);
+			std::atomic<int> chunks(0);
+			bool caught = false;
+			try
+			{
+				pool.ParallelFor(100, 10, [&](std::size_t begin, std::size_t end)
+				{
+					chunks++;
+					if (begin == 30 || begin == 70) throw std::runtime_error("chunk");
+				});
+			}
+			catch (const std::runtime_error&)
+			{
+				caught = true;
+			}
+			Assert::IsTrue(caught);
+			Assert::AreEqual(10, chunks.load(), L"The other chunks still run.");
+			pool.ParallelFor(40, 1, [&](std::size_t, std::size_t) { chunks++; });
+			Assert::AreEqual(50, chunks.load(), L"The pool still works.");
+		}
+
+		// every child plays once per frame, ordered children at their position
+		TEST_METHOD(TestConcurrentParallelPlaysAllChildren)
+		{
+			using namespace AnimateAnything;
+			AnimationThreadPool pool(4);
+			Container<double> aa;
+			auto root = aa.Make<AnimationParallelConcurrent<double>>(pool, 8);
+			std::atomic<int> played(0);
+			std::atomic<double> last(0);
+			std::vector<int> order;
+			for (int i = 0; i < 100; i++) root->Add(aa.Between(0, 10, [&](double t) { played++; last = t; }));
+			root->AddOrdered(aa.Parallel([&]() { order.push_back(played.load()); }));
+			for (int i = 0; i < 100; i++) root->Add(aa.Between(0, 10, [&](double t) { played++; last = t; }));
+			root->AddOrdered(aa.Parallel([&]() { order.push_back(played.load()); }));
+
+			root->PlaySimple(5.0);
+			Assert::AreEqual(200, played.load());
+			Assert::AreEqual(5.0, last.load(), 1e-12);
+			root->PlaySimple(20.0);
+			Assert::AreEqual(200, played.load(), L"Outside the range nothing plays.");
+			Assert::AreEqual(4, int(order.size()));
+			Assert::AreEqual(100, order[0], L"The children before an ordered child have played, the ones after it have not.");
+			Assert::AreEqual(200, order[1]);
+			Assert::AreEqual(std::size_t(202), root->Animations.size(), L"Ordered children are children like the others.");
+		}
+
+		// compiled into a timeline or optimized, a concurrent parallel plays every child once, ordered ones included
+		TEST_METHOD(TestConcurrentParallelCompiles)
+		{
+			using namespace AnimateAnything;
+			AnimationThreadPool pool(2);
+			Container<double> aa;
+			auto concurrent = aa.Make<AnimationParallelConcurrent<double>>(pool, 2);
+			std::atomic<int> played(0);
+			std::vector<int> ordered;
+			for (int i = 0; i < 8; i++) concurrent->Add(aa.Between(0, 10, [&](double) { played++; }));
+			concurrent->AddOrdered(aa.Between(0, 10, [&](double) { ordered.push_back(1); }));
+			concurrent->AddOrdered(aa.Event(1, 0, [&]() { ordered.push_back(2); }));
+			auto scene = aa.Parallel(aa.Seek(0.75, 0, concurrent), aa.Between(0, 10, [&](double) { played++; }));
+
+			AnimationTimeline<double> timeline(*scene);
+			timeline.Play(0.5, 0.0);
+			Assert::AreEqual(9, played.load());
+			Assert::AreEqual(2, int(ordered.size()), L"Each ordered child plays once.");
+			Assert::AreEqual(2, ordered[1]);
+
+			Container<double> optimized;
+			AnimationOptimizer<double> optimizer(optimized);
+			played = 0;
+			ordered.clear();
+			optimizer.Optimize(scene)->Play(0.5, 0.0);
+			Assert::AreEqual(9, played.load());
+			Assert::AreEqual(2, int(ordered.size()));
+			Assert::AreEqual(2, ordered[1]);
+		}
+
+		// small fan-outs are not worth a task, they stay on the calling thread
+		TEST_METHOD(TestSmallFanOutStaysOnCaller)
+		{
+			using namespace AnimateAnything;
+			AnimationThreadPool pool(2);
+			Container<float> aa;
+			auto root = aa.Make<AnimationParallelConcurrent<float>>(pool, 64);
+			std::vector<std::thread::id> threads;
+			for (int i = 0; i < 10; i++) root->Add(aa.Parallel([&]() { threads.push_back(std::this_thread::get_id()); }));
+			root->PlaySimple(1.0f);
+			Assert::AreEqual(10, int(threads.size()));
+			for (auto id : threads) Assert::IsTrue(id == std::this_thread::get_id());
+		}
+
+		TEST_METHOD(TestConcurrentParallelBatch)
+		{
+			using namespace AnimateAnything;
+			AnimationThreadPool pool(3);
+			Container<double> aa;
+			auto root = aa.Make<AnimationParallelConcurrent<double>>(pool, 4);
+			const std::size_t children = 32, count = 16;
+			std::vector<std::vector<double>> values(children, std::vector<double>(count, -1.0));
+			for (std::size_t c = 0; c < children; c++)
+			{
+				auto& value = values[c];
+				root->Add(aa.Between(1, 2, aa.Stretch(double(c), 0, [&value](const double* t, const std::size_t* index, std::size_t n) { for (std::size_t i = 0; i < n; i++) value[index[i]] = t[i]; })));
+			}
+			TimeBatch<double> batch(count);
+			for (std::size_t i = 0; i < count; i++) batch.T[i] = batch.T0[i] = i * 0.2;
+			batch.Play(*root);
+			for (std::size_t c = 0; c < children; c++)
+			{
+				for (std::size_t i = 0; i < count; i++)
+				{
+					double t = i * 0.2;
+					double expected = (1 <= t && t < 2) ? (t - 1) * c : -1.0;
+					Assert::AreEqual(expected, values[c][i], 1e-12);
+				}
+			}
+		}
+
+	};
+}
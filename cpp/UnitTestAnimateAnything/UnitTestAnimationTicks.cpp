@@ -0,0 +1,102 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../AnimateAnything/AnimationTicks.h"
+
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestAnimateAnything
+{
+	TEST_CLASS(UnitTestAnimationTicks)
+	{
+	public:
+
+		TEST_METHOD(TestStretchRatio)
+		{
+			using namespace AnimateAnything;
+			Assert::AreEqual(Ticks(-2), MultiplyRatio<Ticks>(-3, 2, 3), L"Rounds toward the past.");
+			Assert::AreEqual(Ticks(2), MultiplyRatio<Ticks>(3, 2, 3));
+			Assert::AreEqual(Ticks(-7), MultiplyRatio<Ticks>(5, -4, 3));
+			Ticks big = Ticks(1) << 62;
+			Assert::AreEqual(big / 1001 * 1000 + (big % 1001) * 1000 / 1001, MultiplyRatio<Ticks>(big, 1000, 1001), L"Large times do not overflow.");
+
+			// large coprime terms, (denominator - 1) * numerator does not fit 64 bits
+			Ticks late = Ticks(4000000009) * 1000 + 4000000008;
+			Assert::AreEqual(Ticks(4004000007006), MultiplyRatio<Ticks>(late, 4000000007, 4000000009));
+			Assert::AreEqual(Ticks(-4004000007007), MultiplyRatio<Ticks>(-late, 4000000007, 4000000009));
+			Assert::AreEqual(Ticks(-4004000007007), MultiplyRatio<Ticks>(late, -4000000007, 4000000009));
+			Assert::AreEqual(Ticks(2305843009213706295), MultiplyRatio<Ticks>((Ticks(1) << 61) + 12345, (Ticks(1) << 62) + 1, (Ticks(1) << 62) + 3));
+			Assert::AreEqual(Ticks(499999999), MultiplyBelow<Ticks>(Ticks(1) << 40, 999999999, Ticks(1) << 41));
+
+			Container<Ticks> aa;
+			std::vector<Ticks> seen;
+			Ticks leaf = 0;
+			aa.StretchRatio(4000000007, 4000000009, [&leaf](Ticks t) { leaf = t; })->Play(late, late - 1);
+			Assert::AreEqual(Ticks(4004000007006), leaf, L"Under 6 seconds in flicks.");
+			int fired = 0;
+			// local time runs at 1000 / 1001, the event fires when it reaches 1000
+			auto stretch = aa.StretchRatio(1000, 1001, [&seen](Ticks t) { seen.push_back(t); }, aa.Event(1000, 0, [&fired]() { fired++; }));
+			Ticks t0 = 0;
+			for (Ticks t = 1; t <= 3003; t++)
+			{
+				stretch->Play(t, t0);
+				t0 = t;
+			}
+			Assert::AreEqual(std::size_t(3003), seen.size());
+			Assert::AreEqual(Ticks(1000), seen[1000], L"Tick 1001 is local 1000.");
+			Assert::AreEqual(Ticks(999), seen[999]);
+			Assert::AreEqual(Ticks(3000), seen.back());
+			Assert::AreEqual(1, fired, L"The event is crossed once.");
+			for (std::size_t i = 1; i < seen.size(); i++) Assert::IsTrue(seen[i - 1] <= seen[i], L"Local time does not go backward.");
+			Assert::AreEqual(Ticks(0), stretch->NextActivity(0), L"The action is active from the start.");
+
+			// NextActivity finds the first tick whose local time reaches the child
+			auto later = aa.StretchRatio(-3, -7, aa.After(5, 0, [](Ticks) { }));
+			Assert::AreEqual(Ticks(12), later->NextActivity(0), L"12 * 3 / 7 = 5 is the first local 5.");
+			Assert::AreEqual(Ticks(5), MultiplyRatio<Ticks>(12, 3, 7));
+			Assert::AreEqual(Ticks(4), MultiplyRatio<Ticks>(11, 3, 7));
+			Assert::AreEqual(IAnimation<Ticks>::Never(), aa.StretchRatio(1, 2, aa.Event(3, 0, [](Ticks) { }))->NextActivity(7));
+
+			// batches see the same local times
+			seen.clear();
+			TimeBatch<Ticks> batch(8);
+			for (std::size_t i = 0; i < 8; i++)
+			{
+				batch.T[i] = Ticks(i) * 500 - 1000;
+				batch.T0[i] = batch.T[i] - 1;
+			}
+			batch.Play(*stretch);
+			for (std::size_t i = 0; i < 8; i++) Assert::AreEqual(MultiplyRatio<Ticks>(batch.T[i], 1000, 1001), seen[i]);
+		}
+
+		TEST_METHOD(TestFrameClockWithoutDrift)
+		{
+			using namespace AnimateAnything;
+			TickRate rate = TickRate::Flicks();
+			Assert::AreEqual(Ticks(705600000) * 1001, rate.Frame(60000, 60000, 1001), L"60000 frames at 59.94 fps are 1001 seconds.");
+			Assert::AreEqual(Ticks(29400000), rate.Frame(1, 24), L"Whole ticks per frame at 24 fps.");
+			Assert::AreEqual(1.5, rate.Seconds(rate.FromSeconds(1.5)));
+
+			// three weeks into an installation, a loop of 7 seconds with an event every cycle
+			Container<Ticks> aa;
+			int fired = 0;
+			Ticks period = 7 * rate.PerSecond;
+			auto loop = aa.Loop(period, 0, aa.Event(period / 2, 0, [&fired]() { fired++; }));
+			FrameClock clock(rate, 60000, 1001);
+			Ticks start = 21 * 24 * 3600 * rate.PerSecond;
+			clock.Seek(start);
+			Assert::IsTrue(clock.Time() <= start && start < rate.Frame(clock.Frame + 1, 60000, 1001));
+			std::int64_t first = clock.Frame;
+			const std::int64_t frames = 60000 * 7; // 7007 seconds, 1001 cycles
+			for (std::int64_t i = 0; i < frames; i++) clock.Play(*loop);
+			Assert::AreEqual(Ticks(7007) * rate.PerSecond, clock.Time() - rate.Frame(first, 60000, 1001));
+			Assert::AreEqual(1001, fired, L"Every cycle fires its event once, none lost or doubled at the wrap.");
+
+			// a frame is 11771760 ticks, whole at this rate
+			Ticks previous = clock.Time();
+			clock.Play(*loop);
+			Assert::AreEqual(Ticks(11771760), clock.Time() - previous);
+		}
+	};
+}
@@ -0,0 +1,131 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../AnimateAnything/AnimationTimeline.h"
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestAnimateAnything
+{
+	TEST_CLASS(UnitTestAnimationTimeline)
+	{
+	public:
+
+		using Log = std::vector<std::pair<int, double>>;
+
+		// Build a graph that uses every node kind the timeline flattens, leaves log their id and local time
+		static AnimateAnything::IAnimation<double>* BuildGraph(AnimateAnything::Container<double>& aa, Log& log)
+		{
+			auto leaf = [&](int id) { return [&log, id](double t) { log.push_back(std::make_pair(id, t)); }; };
+			auto held = aa.Between(3, 5, aa.Stretch(0, 0, leaf(11)));
+			held->Exit = aa.Parallel(leaf(12));
+			held->ChangedOnly = true;
+			return aa.Parallel(
+				aa.Between(0, 10,
+					aa.Between(0, 2, leaf(1)),
+					aa.Between(2, 4, aa.Seek(0.5, 0, leaf(2))),
+					aa.Between(4, 6, aa.Stretch(-2.0, 0, leaf(3)))
+				),
+				aa.After(8, 0, aa.Stretch(0.25, 0, leaf(4))),
+				aa.Before(1, 0, leaf(5)),
+				aa.Event(3, 0, leaf(6)),
+				aa.Seek(1.0, 0, aa.Event(5.5, 0, leaf(7))),
+				aa.Between(1, 7, aa.Event(2, 0, leaf(8))),
+				aa.TimeTransform([](double t) { return t*t; }, 0, aa.Between(4, 9, leaf(9))),
+				aa.Seek(1.0, 0, held),
+				leaf(10)
+			);
+		}
+
+		TEST_METHOD(TestTimelineMatchesTreeWalk)
+		{
+			Log treeLog, timelineLog;
+			AnimateAnything::Container<double> aa;
+			auto tree = BuildGraph(aa, treeLog);
+			AnimateAnything::AnimationTimeline<double> timeline(*BuildGraph(aa, timelineLog));
+
+			double previous = -2.0;
+			for (double t = -2.0; t < 14.0; t += 0.125)
+			{
+				tree->Play(t, previous);
+				timeline.Play(t, previous);
+				previous = t;
+			}
+			for (double t = 14.0; t > -2.0; t -= 0.375)
+			{
+				tree->Play(t, previous);
+				timeline.Play(t, previous);
+				previous = t;
+			}
+			tree->Play(13.0, -1.0);
+			timeline.Play(13.0, -1.0);
+
+			Assert::IsTrue(treeLog.size() > 100, L"The graph should be exercised.");
+			Assert::AreEqual(treeLog.size(), timelineLog.size());
+			for (std::size_t i = 0; i < treeLog.size(); i++)
+			{
+				Assert::AreEqual(treeLog[i].first, timelineLog[i].first, L"Leaves should play in tree order.");
+				Assert::AreEqual(treeLog[i].second, timelineLog[i].second, L"Local times should be identical.");
+			}
+		}
+
+		TEST_METHOD(TestTimelineEventsFireOnce)
+		{
+			int fired = 0;
+			AnimateAnything::Container<double> aa;
+			AnimateAnything::AnimationTimeline<double> timeline(*aa.Seek(-1.0, 0, aa.Event(1.0, 0, [&]() { fired++; })));
+			timeline.Play(1.5, 0.0); Assert::AreEqual(0, fired, L"Event at 2.0 absolute should not fire yet.");
+			timeline.Play(2.0, 1.5); Assert::AreEqual(1, fired);
+			timeline.Play(2.5, 2.0); Assert::AreEqual(1, fired);
+			timeline.Play(1.0, 2.5); Assert::AreEqual(2, fired, L"Scrubbing back should fire again.");
+		}
+
+		TEST_METHOD(TestTimelineQueriesOnlyActiveSegments)
+		{
+			int x = 0;
+			AnimateAnything::Container<double> aa;
+			AnimateAnything::AnimationParallel<double> sequence;
+			for (int i = 0; i < 1000; i++)
+			{
+				sequence.Add(aa.Between(i, i + 1, [&x, i]() { x = i; }));
+			}
+			AnimateAnything::AnimationTimeline<double> timeline(sequence);
+			Assert::AreEqual(std::size_t(1000), timeline.Segments().size());
+
+			std::vector<std::size_t> active;
+			timeline.Query(500.5, 500.5, active);
+			Assert::AreEqual(std::size_t(1), active.size(), L"Only one segment is stabbed.");
+			timeline.PlaySimple(500.5);
+			Assert::AreEqual(500, x);
+			timeline.PlaySimple(999.0);
+			Assert::AreEqual(999, x);
+		}
+
+		// a parallel subclass that plays one more child kept outside Animations
+		class ParallelWithExtra : public AnimateAnything::AnimationParallel<double>
+		{
+		public:
+			AnimateAnything::IAnimation<double>* Extra = nullptr;
+			void Play(double t, double t0) override { AnimationParallel<double>::Play(t, t0); Extra->Play(t, t0); }
+			void ForEachChild(const std::function<void(AnimateAnything::IAnimation<double>&)>& visit) override { AnimationParallel<double>::ForEachChild(visit); visit(*Extra); }
+		};
+
+		TEST_METHOD(TestTimelineKeepsSubclassesWhole)
+		{
+			std::vector<int> played;
+			AnimateAnything::Container<double> aa;
+			auto custom = aa.Make<ParallelWithExtra>();
+			custom->Add(aa.Between(0, 1, [&played]() { played.push_back(1); }));
+			custom->Extra = aa.Between(0, 1, [&played]() { played.push_back(2); });
+			AnimateAnything::AnimationTimeline<double> timeline(*aa.Seek(0.5, 0, aa.Parallel(custom, aa.Between(0, 1, [&played]() { played.push_back(3); }))));
+			Assert::AreEqual(std::size_t(2), timeline.Segments().size(), L"The subclass is one segment.");
+			timeline.PlaySimple(0.0);
+			Assert::AreEqual(std::size_t(3), played.size(), L"The child kept outside Animations plays.");
+			Assert::AreEqual(2, played[1]);
+		}
+
+	};
+}
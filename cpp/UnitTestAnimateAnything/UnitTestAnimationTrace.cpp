@@ -0,0 +1,162 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include "../AnimateAnything/AnimationTrace.h"
+#include "../AnimateAnything/AnimationOptimizer.h"
+
+// Invocations are recorded through the profile hooks, so these tests are built with the profile tests
+#ifdef ANIMATEANYTHING_PROFILE
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestAnimateAnything
+{
+	TEST_CLASS(UnitTestAnimationTrace)
+	{
+	public:
+
+		using Time = double;
+
+		// Frames with a hitch and a backward scrub, then a batch, the kinds of sequences a session produces
+		static void Frames(AnimateAnything::IAnimation<Time>& root)
+		{
+			Time t0 = 0;
+			for (int frame = 1; frame <= 40; frame++)
+			{
+				Time t = frame == 20 ? t0 + Time(1.5) : t0 + Time(0.25);
+				root.Play(t, t0);
+				t0 = t;
+			}
+			root.Play(2, t0);
+			root.Play(Time(2.5), 2);
+		}
+
+		static void Batch(AnimateAnything::IAnimation<Time>& root)
+		{
+			AnimateAnything::TimeBatch<Time> batch(16);
+			for (std::size_t i = 0; i < 16; i++)
+			{
+				batch.T[i] = Time(i) / 2;
+				batch.T0[i] = Time(i) / 2 - Time(0.5);
+			}
+			batch.Play(root);
+		}
+
+		TEST_METHOD(TestTraceRoundTrip)
+		{
+			using namespace AnimateAnything;
+			Container<Time> aa;
+			std::vector<Time> seen;
+			auto root = aa.Parallel(aa.Between(1, 4, [&seen](Time t) { seen.push_back(t); }), aa.Event(3, 0, [&seen]() { seen.push_back(-1); }));
+			AnimationRecorder<Time> recorder(root);
+			recorder.Level = TraceLevel::Nodes;
+			Frames(recorder);
+			Assert::AreEqual(seen.size(), recorder.Trace.LeafCalls().size(), L"Every action call is a leaf call.");
+			Batch(recorder);
+			const AnimationTrace<Time>& trace = recorder.Trace;
+			Assert::AreEqual(std::size_t(42 + 16), trace.Ticks.size());
+			Assert::AreEqual(std::uint32_t(16), trace.Ticks[42].Batch);
+			Assert::AreEqual(Time(2), trace.Ticks[41].T0, L"The backward scrub is kept as it was played.");
+			Assert::AreEqual(std::size_t(5), trace.Leaves.size(), L"Parallel, Between, Event and their actions.");
+			Assert::AreEqual(std::uint32_t(0), trace.Calls[0], L"The root plays first.");
+			Assert::IsTrue(trace.Ticks[42].Calls <= 5, L"A node that plays a batch is recorded once.");
+
+			std::vector<char> data;
+			trace.Write(data);
+			Assert::IsTrue(data.size() < (trace.Ticks.size() * sizeof(TraceTick<Time>) + trace.Calls.size() * sizeof(std::uint32_t)) / 2, L"The binary form is compact.");
+			AnimationTrace<Time> read;
+			Assert::IsTrue(read.Read(data.data(), data.size()), std::wstring(read.Error.begin(), read.Error.end()).c_str());
+			Assert::AreEqual(trace.Ticks.size(), read.Ticks.size());
+			for (std::size_t i = 0; i < trace.Ticks.size(); i++)
+			{
+				Assert::AreEqual(trace.Ticks[i].T, read.Ticks[i].T);
+				Assert::AreEqual(trace.Ticks[i].T0, read.Ticks[i].T0);
+				Assert::AreEqual(trace.Ticks[i].Batch, read.Ticks[i].Batch);
+				Assert::AreEqual(trace.Ticks[i].Calls, read.Ticks[i].Calls);
+			}
+			Assert::IsTrue(trace.Calls == read.Calls);
+			Assert::IsTrue(trace.Leaves == read.Leaves);
+			Assert::IsFalse(read.Read(data.data(), data.size() - 1));
+			Assert::AreEqual(std::string("truncated"), read.Error);
+			Assert::IsTrue(read.Ticks.empty());
+
+			std::string path = "UnitTestAnimationTrace.aatr";
+			Assert::IsTrue(recorder.Trace.Save(path));
+			Assert::IsTrue(read.Load(path));
+			std::remove(path.c_str());
+			Assert::IsTrue(trace.Calls == read.Calls);
+
+			// replaying into a recorder of the same graph gives the same trace
+			std::vector<Time> expected;
+			expected.swap(seen);
+			AnimationRecorder<Time> again(root);
+			again.Level = TraceLevel::Nodes;
+			TraceReplay<Time> replay;
+			replay.TimeTicks = true;
+			ReplayStats stats = replay.Play(again, read);
+			Assert::AreEqual(std::size_t(43), stats.Ticks, L"The batch is replayed as one batch.");
+			Assert::AreEqual(std::size_t(43), replay.TickNanoseconds.size());
+			Assert::IsTrue(stats.WorstNanoseconds <= stats.Nanoseconds);
+			Assert::IsTrue(expected == seen);
+			Assert::IsTrue(trace.Calls == again.Trace.Calls);
+			Assert::AreEqual(std::uint32_t(16), again.Trace.Ticks[42].Batch);
+		}
+
+		TEST_METHOD(TestTraceComparesGraphs)
+		{
+			using namespace AnimateAnything;
+			Container<Time> aa;
+			int called = 0;
+			auto leaf = [&aa, &called](int id) { return aa.Parallel([&called, id](Time t) { called++; }); };
+			auto shifted = aa.Between(0, 8, aa.Seek(Time(0.5), 0, aa.Stretch(2, 0, aa.After(1, 0, leaf(1)))));
+			auto late = aa.Between(20, 30, leaf(2));
+			auto nested = aa.Parallel(aa.Parallel(aa.Before(5, 0, leaf(3))), aa.Event(6, 0, [&called]() { called++; }));
+			auto loop = aa.Loop(2, 0, aa.Between(0, 1, leaf(4)), aa.Seek(1, 0, leaf(5)));
+			auto scene = aa.Parallel(shifted, late, nested, loop);
+
+			AnimationRecorder<Time> recorder(scene);
+			recorder.Level = TraceLevel::Leaves;
+			Frames(recorder);
+			Assert::IsFalse(recorder.Trace.Calls.empty());
+			Assert::AreEqual(std::size_t(called), recorder.Trace.Calls.size(), L"Only leaves are recorded.");
+			Batch(recorder);
+			int played = called;
+
+			// the optimized graph shares the actions, numbered like the original they must play in the same order
+			Container<Time> optimized;
+			AnimationOptimizer<Time> optimizer(optimized);
+			auto root = optimizer.Optimize(scene);
+			Assert::IsTrue(optimizer.Stats.After.Nodes < optimizer.Stats.Before.Nodes);
+			AnimationRecorder<Time> check(root, scene);
+			check.Level = TraceLevel::Leaves;
+			TraceReplay<Time> replay;
+			replay.Play(check, recorder.Trace);
+			Assert::IsTrue(recorder.Trace.LeafCalls() == check.Trace.LeafCalls());
+
+			// a graph that plays its children in another order is caught
+			auto swapped = aa.Parallel(nested, shifted, late, loop);
+			AnimationRecorder<Time> wrong(swapped, scene);
+			wrong.Level = TraceLevel::Leaves;
+			replay.Play(wrong, recorder.Trace);
+			Assert::IsFalse(recorder.Trace.LeafCalls() == wrong.Trace.LeafCalls());
+
+			// stubs keep the graph and drop what the actions do
+			called = 0;
+			{
+				ActionStubs<Time> stubs(*scene);
+				Assert::AreEqual(std::size_t(6), stubs.Count());
+				ReplayStats stats = replay.Play(*scene, recorder.Trace);
+				Assert::AreEqual(std::size_t(43), stats.Ticks);
+				Assert::AreEqual(0, called);
+			}
+			replay.Play(*scene, recorder.Trace);
+			Assert::AreEqual(played, called, L"The actions are back.");
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,122 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../AnimateAnything/AnimationTracks.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestAnimateAnything
+{
+	TEST_CLASS(UnitTestAnimationTracks)
+	{
+	public:
+
+		TEST_METHOD(TestTrackInterpolation)
+		{
+			using namespace AnimateAnything;
+			AnimationTrackFloat<double> linear;
+			linear.AddKey(0, { 0.0f });
+			linear.AddKey(1, { 10.0f });
+			linear.AddKey(3, { 30.0f });
+			linear.PlaySimple(-1); Assert::AreEqual(0.0f, linear.Value[0], 1e-5f, L"Before the first key.");
+			linear.PlaySimple(0.5); Assert::AreEqual(5.0f, linear.Value[0], 1e-5f);
+			linear.PlaySimple(2.0); Assert::AreEqual(20.0f, linear.Value[0], 1e-5f);
+			linear.PlaySimple(9.0); Assert::AreEqual(30.0f, linear.Value[0], 1e-5f, L"After the last key.");
+
+			float target[3] = { 0, 0, 0 };
+			AnimationTrackVec3<double> step(TrackInterpolation::Step, target);
+			step.AddKey(0, { 1, 2, 3 });
+			step.AddKey(1, { 4, 5, 6 });
+			step.PlaySimple(0.99); Assert::AreEqual(3.0f, target[2]);
+			step.PlaySimple(1.0); Assert::AreEqual(6.0f, target[2]);
+
+			// keys on a line, the cubic goes through them and stays on the line
+			AnimationTrackFloat<double> cubic(TrackInterpolation::Cubic);
+			for (int i = 0; i < 5; i++) cubic.AddKey(i * 2.0, { float(i * 4) });
+			cubic.PlaySimple(3.0); Assert::AreEqual(6.0f, cubic.Value[0], 1e-4f);
+			cubic.PlaySimple(4.0); Assert::AreEqual(8.0f, cubic.Value[0], 1e-4f);
+			cubic.PlaySimple(0.5); Assert::AreEqual(1.0f, cubic.Value[0], 1e-4f);
+		}
+
+		// the cursor gives the same result for monotonic playback, jumps and scrubbing back
+		TEST_METHOD(TestTrackCursor)
+		{
+			using namespace AnimateAnything;
+			AnimationTrackFloat<double> track;
+			for (int i = 0; i < 100; i++) track.AddKey(i, { float(i % 7) });
+			double frames[] = { 0.25, 0.5, 1.5, 2.5, 50.5, 50.75, 3.5, 98.5, 120.0, 10.5 };
+			for (double t : frames)
+			{
+				track.PlaySimple(t);
+				int key = t < 99 ? int(t) : 98;
+				float u = float(t < 99 ? t - key : 1.0);
+				float expected = float(key % 7) + (float((key + 1) % 7) - float(key % 7)) * u;
+				Assert::AreEqual(expected, track.Value[0], 1e-5f);
+			}
+		}
+
+		// with integral time the position between keys is still a fraction
+		TEST_METHOD(TestTrackIntegerTime)
+		{
+			using namespace AnimateAnything;
+			TrackCursor<long long> cursor;
+			std::vector<long long> times = { 0, 100 };
+			float u = -1;
+			Assert::AreEqual(std::size_t(0), cursor.Find(times, 50ll, u));
+			Assert::AreEqual(0.5f, u);
+			double d = -1;
+			cursor.Find(times, 99ll, d);
+			Assert::AreEqual(0.99, d, 1e-12);
+
+			AnimationTrack<long long, 1> track;
+			track.AddKey(1000, { 2.0f });
+			track.AddKey(2000, { 4.0f });
+			track.PlaySimple(1250ll);
+			Assert::AreEqual(2.5f, track.Value[0], 1e-6f);
+		}
+
+		TEST_METHOD(TestQuaternionTrack)
+		{
+			using namespace AnimateAnything;
+			AnimationTrackQuaternion<float> rotation;
+			const float half = std::sqrt(0.5f);
+			rotation.AddKey(0, { 0, 0, 0, 1 });
+			rotation.AddKey(1, { 0, 0, -half, -half }); // same rotation as (0, 0, half, half), the short way round
+			rotation.PlaySimple(0.5f);
+			float length = 0;
+			for (float v : rotation.Value) length += v * v;
+			Assert::AreEqual(1.0f, length, 1e-5f);
+			Assert::IsTrue(rotation.Value[2] > 0 && rotation.Value[3] > 0.9f, L"Should take the shortest path.");
+		}
+
+		// a group gives the same values as one track per channel
+		TEST_METHOD(TestTrackGroupMatchesTracks)
+		{
+			using namespace AnimateAnything;
+			const std::size_t channels = 13;
+			AnimationTrackGroup<double> group(channels, TrackInterpolation::Cubic);
+			std::vector<AnimationTrackFloat<double>> tracks(channels, AnimationTrackFloat<double>(TrackInterpolation::Cubic));
+			std::vector<float> key(channels);
+			for (int k = 0; k < 6; k++)
+			{
+				double time = k * k * 0.5;
+				for (std::size_t c = 0; c < channels; c++)
+				{
+					key[c] = float(std::sin(k * 0.7 + c));
+					tracks[c].AddKey(time, &key[c]);
+				}
+				group.AddKey(time, key.data());
+			}
+			Container<double> aa;
+			auto anim = aa.Parallel(&group, aa.Parallel([&](double t) { for (auto& track : tracks) track.PlaySimple(t); }));
+			for (double t = -1.0; t < 14.0; t += 0.37)
+			{
+				anim->PlaySimple(t);
+				for (std::size_t c = 0; c < channels; c++) Assert::AreEqual(tracks[c].Value[0], group.Output[c], 1e-5f);
+			}
+		}
+
+	};
+}